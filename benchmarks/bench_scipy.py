@@ -0,0 +1,212 @@
+"""End-to-end benchmark of nanolsap.linear_sum_assignment against
+scipy.optimize.linear_sum_assignment.
+
+Every instance family is solved by both in a fresh subprocess, so the peak
+resident set size of the solve is not hidden by earlier cases. For each
+solve the best wall time over the repetitions is reported, with the peak of
+the memory traced by tracemalloc (numpy arrays, including the copies scipy
+makes) and the growth of the peak RSS (also the C++ workspaces, which
+tracemalloc does not see), both beyond the input matrix.
+
+    python benchmarks/bench_scipy.py --size 2000 --save baseline.json
+    python benchmarks/bench_scipy.py --size 2000 --compare baseline.json
+
+With --compare the nanolsap times and memory are checked against a saved
+run, and the exit status is 1 if any is worse than --tolerance allows.
+"""
+
+import argparse
+import json
+import multiprocessing
+import resource
+import sys
+import time
+import tracemalloc
+
+import numpy as np
+
+
+def uniform(n, rng):
+    return rng.random((n, n))
+
+
+def int_small(n, rng):
+    # many ties
+    return rng.integers(0, 10, (n, n)).astype(np.int32)
+
+
+def geometric(n, rng):
+    x = rng.random((n, 2))
+    y = rng.random((n, 2))
+    return np.sqrt(((x[:, None, :] - y[None, :, :]) ** 2).sum(-1))
+
+
+def machol_wien(n, rng):
+    # c_ij = i * j, hard for shortest augmenting path solvers
+    i = np.arange(1, n + 1, dtype=np.float64)
+    return np.outer(i, i)
+
+
+def sparse_inf(n, rng):
+    cost = rng.random((n, n))
+    cost[rng.random((n, n)) > 0.05] = np.inf
+    # keep a feasible assignment
+    cost[np.arange(n), rng.permutation(n)] = rng.random(n)
+    return cost
+
+
+def float32(n, rng):
+    return rng.random((n, n), dtype=np.float32)
+
+
+def tall(n, rng):
+    return rng.random((2 * n, n))
+
+
+def wide(n, rng):
+    return rng.random((n, 2 * n))
+
+
+def subset(n, rng):
+    # a query on half of the rows and columns of a larger matrix
+    cost = rng.random((2 * n, 2 * n))
+    subrows = np.sort(rng.choice(2 * n, n, replace=False))
+    subcols = np.sort(rng.choice(2 * n, n, replace=False))
+    return cost, subrows, subcols
+
+
+FAMILIES = {
+    "uniform": uniform,
+    "int_small": int_small,
+    "geometric": geometric,
+    "machol_wien": machol_wien,
+    "sparse_inf": sparse_inf,
+    "float32": float32,
+    "tall": tall,
+    "wide": wide,
+    "subset": subset,
+}
+SOLVERS = ["nanolsap", "scipy"]
+
+
+def make_instance(family, n, seed):
+    instance = FAMILIES[family](n, np.random.default_rng(seed))
+    if isinstance(instance, tuple):
+        return instance
+    return instance, None, None
+
+
+def solve_once(solver, cost, subrows, subcols):
+    if solver == "nanolsap":
+        from nanolsap import linear_sum_assignment
+        if subrows is None:
+            return linear_sum_assignment(cost)
+        return linear_sum_assignment(cost, subrows=subrows, subcols=subcols)
+    from scipy.optimize import linear_sum_assignment
+    if subrows is None:
+        return linear_sum_assignment(cost)
+    # scipy needs the submatrix
+    row_ind, col_ind = linear_sum_assignment(cost[np.ix_(subrows, subcols)])
+    return subrows[row_ind], subcols[col_ind]
+
+
+def peak_rss_bytes():
+    rss = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+    # kilobytes on Linux, bytes on macOS
+    return rss if sys.platform == "darwin" else rss * 1024
+
+
+def measure(solver, family, n, repeat, seed, queue):
+    # imports first, so their memory is not counted
+    if solver == "nanolsap":
+        import nanolsap  # noqa: F401
+    else:
+        import scipy.optimize  # noqa: F401
+    cost, subrows, subcols = make_instance(family, n, seed)
+    rss = peak_rss_bytes()
+    tracemalloc.start()
+    seconds = []
+    for _ in range(repeat):
+        start = time.perf_counter()
+        row_ind, col_ind = solve_once(solver, cost, subrows, subcols)
+        seconds.append(time.perf_counter() - start)
+        del row_ind, col_ind
+    traced = tracemalloc.get_traced_memory()[1]
+    tracemalloc.stop()
+    row_ind, col_ind = solve_once(solver, cost, subrows, subcols)
+    queue.put({
+        "seconds": min(seconds),
+        "traced_bytes": traced,
+        "rss_bytes": peak_rss_bytes() - rss,
+        "cost": float(cost[row_ind, col_ind].sum()),
+    })
+
+
+def run_case(solver, family, n, repeat, seed):
+    context = multiprocessing.get_context("spawn")
+    queue = context.Queue()
+    process = context.Process(target=measure, args=(solver, family, n, repeat, seed, queue))
+    process.start()
+    result = queue.get()
+    process.join()
+    return result
+
+
+def compare(results, baseline, tolerance):
+    """The nanolsap cases slower or larger than the baseline by more than
+    the factor tolerance, as printable lines."""
+    regressions = []
+    for key, case in results.items():
+        old = baseline.get(key)
+        if old is None or not key.startswith("nanolsap/"):
+            continue
+        for field in ["seconds", "rss_bytes"]:
+            # ignore differences too small to measure
+            floor = 1e-3 if field == "seconds" else 1 << 20
+            if case[field] > tolerance * max(old[field], floor):
+                regressions.append("%s %s: %.4g -> %.4g" % (key, field, old[field], case[field]))
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("--size", type=int, default=1000)
+    parser.add_argument("--repeat", type=int, default=3)
+    parser.add_argument("--seed", type=int, default=0)
+    parser.add_argument("--families", nargs="+", choices=sorted(FAMILIES), default=list(FAMILIES))
+    parser.add_argument("--solvers", nargs="+", choices=SOLVERS, default=SOLVERS)
+    parser.add_argument("--save", metavar="FILE", help="write the results as JSON")
+    parser.add_argument("--compare", metavar="FILE", help="check against saved results")
+    parser.add_argument("--tolerance", type=float, default=1.25)
+    args = parser.parse_args()
+
+    results = {}
+    print("%-12s %-9s %10s %12s %12s" % ("family", "solver", "seconds", "traced MB", "rss MB"))
+    for family in args.families:
+        costs = {}
+        for solver in args.solvers:
+            case = run_case(solver, family, args.size, args.repeat, args.seed)
+            results["%s/%s/%d" % (solver, family, args.size)] = case
+            costs[solver] = case["cost"]
+            print("%-12s %-9s %10.4f %12.1f %12.1f" % (
+                family, solver, case["seconds"], case["traced_bytes"] / 2**20,
+                case["rss_bytes"] / 2**20))
+        if len(costs) == 2 and not np.isclose(costs["nanolsap"], costs["scipy"]):
+            print("cost mismatch on %s: %r" % (family, costs))
+            return 1
+
+    if args.save:
+        with open(args.save, "w") as f:
+            json.dump(results, f, indent=1, sort_keys=True)
+    if args.compare:
+        with open(args.compare) as f:
+            regressions = compare(results, json.load(f), args.tolerance)
+        for line in regressions:
+            print("regression", line)
+        if regressions:
+            return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
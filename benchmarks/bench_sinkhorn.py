@@ -0,0 +1,76 @@
+"""Benchmark of method='sinkhorn' against the exact solver on the matching of
+two point clouds by squared Euclidean distance, the use case of the
+approximation.
+
+The clouds are drawn from normal distributions in --dim dimensions, the
+second one shifted. Every case reports the best wall time over the
+repetitions and the relative gap of the assignment cost to the optimum of
+the exact solver, for the default options and with repair=True.
+
+    python benchmarks/bench_sinkhorn.py --sizes 1000 2000 4000
+
+The exit status is 1 if the sinkhorn defaults were slower than the exact
+solver at the largest size.
+"""
+
+import argparse
+import sys
+import time
+
+import numpy as np
+
+from nanolsap import linear_sum_assignment
+
+
+def point_clouds(n, dim, rng):
+    x = rng.normal(size=(n, dim))
+    y = rng.normal(size=(n, dim)) + 0.5
+    return ((x[:, None, :] - y[None, :, :]) ** 2).sum(-1)
+
+
+CASES = {
+    "exact": {},
+    "sinkhorn": {"method": "sinkhorn"},
+    "sinkhorn+repair": {"method": "sinkhorn", "repair": True},
+}
+
+
+def best_time(cost, repeat, options):
+    seconds = []
+    for _ in range(repeat):
+        start = time.perf_counter()
+        row_ind, col_ind = linear_sum_assignment(cost, **options)
+        seconds.append(time.perf_counter() - start)
+    return min(seconds), float(cost[row_ind, col_ind].sum())
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("--sizes", type=int, nargs="+", default=[1000, 2000, 4000])
+    parser.add_argument("--dim", type=int, default=10)
+    parser.add_argument("--repeat", type=int, default=3)
+    parser.add_argument("--seed", type=int, default=0)
+    parser.add_argument("--n-threads", type=int, default=1)
+    args = parser.parse_args()
+
+    print("%-6s %-16s %10s %10s" % ("size", "case", "seconds", "gap %"))
+    seconds = {}
+    for n in args.sizes:
+        cost = point_clouds(n, args.dim, np.random.default_rng(args.seed))
+        optimum = None
+        for case, options in CASES.items():
+            if case != "exact":
+                options = dict(options, n_threads=args.n_threads)
+            seconds[case], total = best_time(cost, args.repeat, options)
+            if optimum is None:
+                optimum = total
+            print("%-6d %-16s %10.4f %10.3f" % (n, case, seconds[case],
+                                                100 * (total - optimum) / abs(optimum)))
+    if seconds["sinkhorn"] >= seconds["exact"]:
+        print("sinkhorn is not faster than exact at size %d" % args.sizes[-1])
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,145 @@
+/*
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+1. Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following
+   disclaimer in the documentation and/or other materials provided
+   with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived
+   from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+/*
+Shared by the benchmark drivers in this directory: the dtype names, random
+cost matrices and the layouts a solve can see them in.  The drivers include
+the solver internals and link the sources of src/nanolsap/rectangular_lsap
+directly, without Python.
+*/
+
+#ifndef NANOLSAP_BENCH_UTIL_H
+#define NANOLSAP_BENCH_UTIL_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <memory>
+#include <numeric>
+#include <algorithm>
+#include "../src/nanolsap/rectangular_lsap/rectangular_lsap_impl.h"
+
+// The names of enum LSAP_TYPES, in order.
+static const char* const dtype_names[] = {
+    "bool", "byte", "ubyte", "short", "ushort", "int", "uint",
+    "long", "ulong", "longlong", "ulonglong", "float", "double", "longdouble",
+};
+static const intptr_t n_dtypes = sizeof(dtype_names) / sizeof(dtype_names[0]);
+
+static inline intptr_t
+parse_dtype(const char* name)
+{
+    for (intptr_t i = 0; i < n_dtypes; i++) {
+        if (strcmp(name, dtype_names[i]) == 0) {
+            return i;
+        }
+    }
+    return LSAP_INVALID;
+}
+
+// How the solver sees the cost matrix of a problem of nr rows and nc
+// columns: as stored, stored transposed (nc by nr, so the solver transposes
+// the view back), or as a random subset of a matrix twice as large.
+enum bench_layout {
+    LAYOUT_PLAIN = 0,
+    LAYOUT_TRANSPOSED,
+    LAYOUT_SUBSCRIPT,
+};
+static const char* const layout_names[] = { "plain", "transposed", "subscript" };
+
+// A cost matrix of element type T with its subscripts, uniform in [0, 1000)
+// (0 or 1 for bool) from a fixed seed.
+template <typename T> struct bench_problem {
+    intptr_t nr;          // shape of the stored matrix
+    intptr_t nc;
+    std::unique_ptr<T[]> cost;   // not a vector, there is no data() of vector<bool>
+    std::vector<intptr_t> subrows;
+    std::vector<intptr_t> subcols;
+
+    bench_problem(intptr_t rows, intptr_t cols, int layout, unsigned seed = 0)
+    {
+        nr = rows;
+        nc = cols;
+        if (layout == LAYOUT_TRANSPOSED) {
+            std::swap(nr, nc);
+        } else if (layout == LAYOUT_SUBSCRIPT) {
+            nr *= 2;
+            nc *= 2;
+        }
+        std::mt19937_64 rng(seed);
+        std::uniform_real_distribution<double> uniform(0, 1000);
+        cost.reset(new T[nr * nc]);
+        for (intptr_t i = 0; i < nr * nc; i++) {
+            cost[i] = std::is_same<T, bool>::value ? T(rng() & 1) : T(uniform(rng));
+        }
+        if (layout == LAYOUT_SUBSCRIPT) {
+            subrows = random_subset(nr, rows, rng);
+            subcols = random_subset(nc, cols, rng);
+        }
+    }
+
+    const intptr_t* rows() const { return subrows.empty() ? nullptr : subrows.data(); }
+    const intptr_t* cols() const { return subcols.empty() ? nullptr : subcols.data(); }
+
+private:
+    static std::vector<intptr_t> random_subset(intptr_t n, intptr_t k, std::mt19937_64& rng)
+    {
+        std::vector<intptr_t> index(n);
+        std::iota(index.begin(), index.end(), 0);
+        std::shuffle(index.begin(), index.end(), rng);
+        index.resize(k);
+        return index;
+    }
+};
+
+// "300x500" to 300 and 500.
+static inline bool
+parse_shape(const char* text, intptr_t* p_nr, intptr_t* p_nc)
+{
+    char* end;
+    long nr = strtol(text, &end, 10);
+    if (*end != 'x' || nr < 1) {
+        return false;
+    }
+    long nc = strtol(end + 1, &end, 10);
+    if (*end != '\0' || nc < 1) {
+        return false;
+    }
+    *p_nr = nr;
+    *p_nc = nc;
+    return true;
+}
+
+#endif
@@ -0,0 +1,311 @@
+/*
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+1. Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following
+   disclaimer in the documentation and/or other materials provided
+   with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived
+   from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+/*
+Micro-benchmarks of the exact solver kernels without Python in the loop.
+For every dtype of enum LSAP_TYPES, square (n x n), wide (n x 2n) and tall
+(2n x n) shapes, plain and subscripted layouts, minimizing and maximizing,
+two kernels are timed:
+
+  solve            lsap_solve_dtype, i.e. the
+                   validation, solve<T> and writing the result
+  augmenting_path  the shortest augmenting path of the last row once all
+                   other rows are assigned, the longest search of a solve
+
+After the warmup runs every case is repeated and the median, 95th
+percentile, minimum and mean are reported, as a table and optionally as
+JSON for comparing runs.
+
+  micro [--size 200] [--warmup 2] [--repeat 15] [--dtype NAME]
+        [--kernel solve|augmenting_path] [--json FILE]
+*/
+
+#include <chrono>
+#include "bench_util.h"
+
+struct shape_spec {
+    const char* name;
+    intptr_t rows;   // in multiples of size
+    intptr_t cols;
+};
+static const shape_spec shapes[] = { { "square", 1, 1 }, { "wide", 1, 2 }, { "tall", 2, 1 } };
+static const int layouts[] = { LAYOUT_PLAIN, LAYOUT_SUBSCRIPT };
+static const char* const kernels[] = { "solve", "augmenting_path" };
+
+struct timing {
+    double median;
+    double p95;
+    double min;
+    double mean;
+};
+
+static timing
+summarize(std::vector<double> seconds)
+{
+    std::sort(seconds.begin(), seconds.end());
+    size_t n = seconds.size();
+    timing t;
+    t.median = n % 2 ? seconds[n / 2] : (seconds[n / 2 - 1] + seconds[n / 2]) / 2;
+    // nearest rank
+    t.p95 = seconds[std::min(n - 1, size_t(std::ceil(0.95 * n)) - 1)];
+    t.min = seconds[0];
+    t.mean = std::accumulate(seconds.begin(), seconds.end(), 0.0) / n;
+    return t;
+}
+
+template <typename T> static int
+time_solve(const bench_problem<T>& problem, intptr_t dtype, bool maximize,
+           intptr_t runs, std::vector<double>& seconds)
+{
+    std::vector<int64_t> a(std::max(problem.nr, problem.nc));
+    std::vector<int64_t> b(a.size());
+    for (intptr_t r = 0; r < runs; r++) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        int ret = lsap_solve_dtype(
+            problem.nr, problem.nc, (void*)problem.cost.get(), dtype, maximize,
+            problem.rows(), problem.subrows.size(), problem.cols(), problem.subcols.size(),
+            -1, LSAP_OBJECTIVE_SUM, nullptr, a.data(), b.data());
+        seconds.push_back(seconds_since(start));
+        if (ret != 0) {
+            return ret;
+        }
+    }
+    return 0;
+}
+
+template <typename T> static int
+time_augmenting_path(const bench_problem<T>& problem, bool maximize,
+                     intptr_t runs, std::vector<double>& seconds)
+{
+    intptr_t nr = problem.nr;
+    intptr_t nc = problem.nc;
+    const intptr_t* subrows = problem.rows();
+    const intptr_t* subcols = problem.cols();
+    matrix2d<T> costmat{problem.cost.get(), nr, nc};
+    bool transpose = false;
+    int ret = make_cost_view(&nr, &nc, problem.cost.get(), maximize,
+                             &subrows, problem.subrows.size(),
+                             &subcols, problem.subcols.size(), costmat, &transpose);
+    if (ret != 0) {
+        return ret;
+    }
+
+    // assign all rows but the last, which is left for the timed search
+    std::vector<double> u(nr, 0);
+    std::vector<double> v(nc, 0);
+    std::vector<intptr_t> col4row(nr, -1);
+    std::vector<intptr_t> row4col(nc, -1);
+    ret = solve_from(nr - 1, nc, costmat, u, v, col4row, row4col);
+    if (ret != 0) {
+        return ret;
+    }
+
+    std::vector<double> shortestPathCosts(nc);
+    std::vector<intptr_t> path(nc, -1);
+    std::vector<bool> SR(nr);
+    std::vector<bool> SC(nc);
+    std::vector<intptr_t> remaining(nc);
+    for (intptr_t r = 0; r < runs; r++) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        double minVal;
+        intptr_t sink = augmenting_path(nc, costmat, u, v, path, row4col, shortestPathCosts,
+                                        nr - 1, SR, SC, remaining, &minVal);
+        seconds.push_back(seconds_since(start));
+        if (sink < 0) {
+            return RECTANGULAR_LSAP_INFEASIBLE;
+        }
+    }
+    return 0;
+}
+
+struct config {
+    intptr_t size = 200;
+    intptr_t warmup = 2;
+    intptr_t repeat = 15;
+    intptr_t dtype = -1;    // all
+    intptr_t kernel = -1;   // all
+    const char* json = nullptr;
+};
+
+struct result {
+    const char* kernel;
+    intptr_t dtype;
+    const char* shape;
+    int layout;
+    bool maximize;
+    intptr_t nr;
+    intptr_t nc;
+    timing t;
+};
+
+template <typename T> static int
+run_dtype(const config& cfg, intptr_t dtype, std::vector<result>& results)
+{
+    for (const shape_spec& shape: shapes) {
+        for (int layout: layouts) {
+            intptr_t nr = shape.rows * cfg.size;
+            intptr_t nc = shape.cols * cfg.size;
+            bench_problem<T> problem(nr, nc, layout);
+            for (int maximize = 0; maximize < 2; maximize++) {
+                for (intptr_t k = 0; k < 2; k++) {
+                    if (cfg.kernel >= 0 && cfg.kernel != k) {
+                        continue;
+                    }
+                    std::vector<double> warm, seconds;
+                    int ret;
+                    if (k == 0) {
+                        ret = time_solve(problem, dtype, maximize, cfg.warmup, warm);
+                        if (ret == 0) {
+                            ret = time_solve(problem, dtype, maximize, cfg.repeat, seconds);
+                        }
+                    } else {
+                        ret = time_augmenting_path(problem, maximize, cfg.warmup, warm);
+                        if (ret == 0) {
+                            ret = time_augmenting_path(problem, maximize, cfg.repeat, seconds);
+                        }
+                    }
+                    if (ret != 0) {
+                        fprintf(stderr, "%s %s %s failed: %d\n", kernels[k],
+                                dtype_names[dtype], shape.name, ret);
+                        return ret;
+                    }
+                    results.push_back({ kernels[k], dtype, shape.name, layout,
+                                        maximize != 0, nr, nc, summarize(seconds) });
+                    const result& r = results.back();
+                    printf("%-16s %-10s %-7s %-10s %-9s %12.3f %12.3f %12.3f\n", r.kernel,
+                           dtype_names[dtype], r.shape, layout_names[layout],
+                           maximize ? "max" : "min", r.t.median * 1e6, r.t.p95 * 1e6,
+                           r.t.min * 1e6);
+                    fflush(stdout);
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+static int
+run_all_dtypes(const config& cfg, std::vector<result>& results)
+{
+    for (intptr_t dtype = 0; dtype < n_dtypes; dtype++) {
+        if (cfg.dtype >= 0 && cfg.dtype != dtype) {
+            continue;
+        }
+        int ret;
+        // the switch returns from every case, so wrap it
+        struct dispatch {
+            static int run(const config& cfg, intptr_t dtype, std::vector<result>& results)
+            {
+                LSAP_DTYPE_SWITCH(dtype, T, return run_dtype<T>(cfg, dtype, results));
+            }
+        };
+        ret = dispatch::run(cfg, dtype, results);
+        if (ret != 0) {
+            return ret;
+        }
+    }
+    return 0;
+}
+
+static bool
+write_json(const char* filename, const config& cfg, const std::vector<result>& results)
+{
+    FILE* f = fopen(filename, "w");
+    if (f == nullptr) {
+        return false;
+    }
+    fprintf(f, "{\n  \"size\": %ld,\n  \"warmup\": %ld,\n  \"repeat\": %ld,\n  \"results\": [",
+            (long)cfg.size, (long)cfg.warmup, (long)cfg.repeat);
+    for (size_t i = 0; i < results.size(); i++) {
+        const result& r = results[i];
+        fprintf(f, "%s\n    {\"kernel\": \"%s\", \"dtype\": \"%s\", \"shape\": \"%s\", "
+                   "\"layout\": \"%s\", \"maximize\": %s, \"nr\": %ld, \"nc\": %ld, "
+                   "\"median\": %.9g, \"p95\": %.9g, \"min\": %.9g, \"mean\": %.9g}",
+                i ? "," : "", r.kernel, dtype_names[r.dtype], r.shape,
+                layout_names[r.layout], r.maximize ? "true" : "false", (long)r.nr, (long)r.nc,
+                r.t.median, r.t.p95, r.t.min, r.t.mean);
+    }
+    fprintf(f, "\n  ]\n}\n");
+    return fclose(f) == 0;
+}
+
+static int
+usage(const char* program)
+{
+    fprintf(stderr, "usage: %s [--size N] [--warmup N] [--repeat N] [--dtype NAME]\n"
+                    "       [--kernel solve|augmenting_path] [--json FILE]\n", program);
+    return 2;
+}
+
+int main(int argc, char** argv)
+{
+    config cfg;
+    for (int i = 1; i < argc; i += 2) {
+        if (i + 1 >= argc) {
+            return usage(argv[0]);
+        }
+        std::string arg = argv[i];
+        const char* value = argv[i + 1];
+        if (arg == "--size") {
+            cfg.size = atol(value);
+        } else if (arg == "--warmup") {
+            cfg.warmup = atol(value);
+        } else if (arg == "--repeat") {
+            cfg.repeat = atol(value);
+        } else if (arg == "--dtype") {
+            cfg.dtype = parse_dtype(value);
+        } else if (arg == "--kernel") {
+            cfg.kernel = strcmp(value, kernels[0]) == 0 ? 0 :
+                         strcmp(value, kernels[1]) == 0 ? 1 : LSAP_INVALID;
+        } else if (arg == "--json") {
+            cfg.json = value;
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    if (cfg.size < 2 || cfg.warmup < 0 || cfg.repeat < 1 ||
+        cfg.dtype == LSAP_INVALID || cfg.kernel == LSAP_INVALID) {
+        return usage(argv[0]);
+    }
+
+    printf("%-16s %-10s %-7s %-10s %-9s %12s %12s %12s\n", "kernel", "dtype", "shape",
+           "layout", "objective", "median us", "p95 us", "min us");
+    std::vector<result> results;
+    int ret = run_all_dtypes(cfg, results);
+    if (ret != 0) {
+        return 1;
+    }
+    if (cfg.json != nullptr && !write_json(cfg.json, cfg, results)) {
+        fprintf(stderr, "could not write %s\n", cfg.json);
+        return 1;
+    }
+    return 0;
+}
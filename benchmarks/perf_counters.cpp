@@ -0,0 +1,347 @@
+/*
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+1. Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following
+   disclaimer in the documentation and/or other materials provided
+   with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived
+   from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+/*
+Hardware counters per phase of the exact solver.  The phases of solve()
+are run one by one, each inside a perf_event_open counter group:
+
+  validate   make_cost_view: the scan for NaN and infinities, subscripts
+  setup      duals, row order and workspace
+  augment    solve_from: the shortest augmenting paths
+  write      write_result
+
+and the wall time and counters are averaged over the repetitions.  Events
+the kernel or the CPU does not offer are left out; when none can be opened
+(e.g. perf_event_paranoid, containers, non-Linux) only wall times are
+printed.
+
+  perf_counters [--shape 1000x1000] [--dtype double] [--layout plain]
+                [--maximize] [--row-order index] [--repeat 5]
+
+layout is plain, transposed or subscript, row order index, random, regret
+or min_cost.
+*/
+
+#include <chrono>
+#include "bench_util.h"
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+struct event_spec {
+    const char* name;
+    uint32_t type;
+    uint64_t config;
+};
+
+#ifdef __linux__
+static const event_spec events[] = {
+    { "cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    { "instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    { "branch-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+    { "cache-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+    { "L1d-misses", PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D |
+      (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+    { "dTLB-misses", PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB |
+      (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+};
+#else
+static const event_spec events[] = { { "cycles", 0, 0 } };
+#endif
+static const intptr_t n_events = sizeof(events) / sizeof(events[0]);
+
+// The events that could be opened, counted together with the first as the
+// group leader so that ratios like IPC compare the same interval.
+class counter_group {
+public:
+    counter_group()
+    {
+#ifdef __linux__
+        for (intptr_t e = 0; e < n_events; e++) {
+            struct perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = events[e].type;
+            attr.config = events[e].config;
+            attr.disabled = m_fds.empty();
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                               PERF_FORMAT_TOTAL_TIME_RUNNING;
+            int leader = m_fds.empty() ? -1 : m_fds[0];
+            int fd = (int)syscall(__NR_perf_event_open, &attr, 0, -1, leader, 0);
+            if (fd < 0) {
+                continue;
+            }
+            m_fds.push_back(fd);
+            m_index.push_back(e);
+        }
+#endif
+    }
+
+    ~counter_group()
+    {
+#ifdef __linux__
+        for (int fd: m_fds) {
+            close(fd);
+        }
+#endif
+    }
+
+    bool available() const { return !m_fds.empty(); }
+
+    void start()
+    {
+#ifdef __linux__
+        if (available()) {
+            ioctl(m_fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(m_fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+#endif
+    }
+
+    // Add the counts since start to totals, indexed like events, scaled up
+    // if the group was multiplexed with other users of the PMU.
+    void stop(std::vector<double>& totals)
+    {
+#ifdef __linux__
+        if (!available()) {
+            return;
+        }
+        ioctl(m_fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        std::vector<uint64_t> data(3 + m_fds.size());
+        ssize_t size = read(m_fds[0], data.data(), data.size() * sizeof(uint64_t));
+        if (size < (ssize_t)(data.size() * sizeof(uint64_t)) || data[2] == 0) {
+            return;
+        }
+        double scale = double(data[1]) / data[2];
+        for (size_t i = 0; i < m_fds.size(); i++) {
+            totals[m_index[i]] += data[3 + i] * scale;
+        }
+#else
+        (void)totals;
+#endif
+    }
+
+    bool has(intptr_t e) const
+    {
+        return std::find(m_index.begin(), m_index.end(), e) != m_index.end();
+    }
+
+private:
+    std::vector<int> m_fds;
+    std::vector<intptr_t> m_index;
+};
+
+enum phases { VALIDATE = 0, SETUP, AUGMENT, WRITE, N_PHASES };
+static const char* const phase_names[] = { "validate", "setup", "augment", "write" };
+
+struct phase_totals {
+    double seconds[N_PHASES] = {};
+    std::vector<double> counts[N_PHASES];
+};
+
+// The phases of solve() for a full assignment, each measured on its own.
+template <typename T> static int
+run_phases(const bench_problem<T>& problem, bool maximize, intptr_t kind,
+           counter_group& group, phase_totals& totals)
+{
+    typedef std::chrono::steady_clock clock;
+    intptr_t nr = problem.nr;
+    intptr_t nc = problem.nc;
+    const intptr_t* subrows = problem.rows();
+    const intptr_t* subcols = problem.cols();
+    std::vector<int64_t> a(std::min(problem.subrows.empty() ? nr : problem.subrows.size(),
+                                    problem.subcols.empty() ? nc : problem.subcols.size()));
+    std::vector<int64_t> b(a.size());
+
+    clock::time_point start = clock::now();
+    group.start();
+    matrix2d<T> costmat{problem.cost.get(), nr, nc};
+    bool transpose = false;
+    int ret = make_cost_view(&nr, &nc, problem.cost.get(), maximize,
+                             &subrows, problem.subrows.size(),
+                             &subcols, problem.subcols.size(), costmat, &transpose);
+    group.stop(totals.counts[VALIDATE]);
+    totals.seconds[VALIDATE] += seconds_since(start);
+    if (ret != 0) {
+        return ret;
+    }
+
+    start = clock::now();
+    group.start();
+    std::vector<double> u(nr, 0);
+    std::vector<double> v(nc, 0);
+    std::vector<intptr_t> col4row(nr, -1);
+    std::vector<intptr_t> row4col(nc, -1);
+    std::vector<intptr_t> order;
+    bool ordered = row_order(nr, nc, costmat, kind, order);
+    group.stop(totals.counts[SETUP]);
+    totals.seconds[SETUP] += seconds_since(start);
+
+    start = clock::now();
+    group.start();
+    ret = solve_from(nr, nc, costmat, u, v, col4row, row4col, ordered ? order.data() : nullptr);
+    group.stop(totals.counts[AUGMENT]);
+    totals.seconds[AUGMENT] += seconds_since(start);
+    if (ret != 0) {
+        return ret;
+    }
+
+    start = clock::now();
+    group.start();
+    ret = write_result(nr, col4row, transpose, subrows, subcols, a.data(), b.data());
+    group.stop(totals.counts[WRITE]);
+    totals.seconds[WRITE] += seconds_since(start);
+    return ret;
+}
+
+template <typename T> static int
+run(intptr_t nr, intptr_t nc, int layout, bool maximize, intptr_t kind, intptr_t repeat)
+{
+    bench_problem<T> problem(nr, nc, layout);
+    counter_group group;
+    if (!group.available()) {
+        fprintf(stderr, "hardware counters unavailable, wall times only\n");
+    }
+    phase_totals totals;
+    for (intptr_t p = 0; p < N_PHASES; p++) {
+        totals.counts[p].assign(n_events, 0);
+    }
+    for (intptr_t r = 0; r < repeat; r++) {
+        int ret = run_phases(problem, maximize, kind, group, totals);
+        if (ret != 0) {
+            fprintf(stderr, "solve failed: %d\n", ret);
+            return 1;
+        }
+    }
+
+    printf("%-10s %12s", "phase", "seconds");
+    for (intptr_t e = 0; e < n_events; e++) {
+        if (group.has(e)) {
+            printf(" %14s", events[e].name);
+        }
+    }
+    if (group.has(0) && group.has(1)) {
+        printf(" %6s", "IPC");
+    }
+    printf("\n");
+    for (intptr_t p = 0; p < N_PHASES; p++) {
+        const std::vector<double>& counts = totals.counts[p];
+        printf("%-10s %12.6f", phase_names[p], totals.seconds[p] / repeat);
+        for (intptr_t e = 0; e < n_events; e++) {
+            if (group.has(e)) {
+                printf(" %14.0f", counts[e] / repeat);
+            }
+        }
+        if (group.has(0) && group.has(1)) {
+            printf(" %6.2f", counts[0] > 0 ? counts[1] / counts[0] : 0.0);
+        }
+        printf("\n");
+    }
+    return 0;
+}
+
+static int
+usage(const char* program)
+{
+    fprintf(stderr, "usage: %s [--shape NRxNC] [--dtype NAME] [--layout plain|transposed|subscript]\n"
+                    "       [--maximize] [--row-order index|random|regret|min_cost] [--repeat N]\n",
+            program);
+    return 2;
+}
+
+int main(int argc, char** argv)
+{
+    intptr_t nr = 1000, nc = 1000, dtype = LSAP_DOUBLE, repeat = 5;
+    intptr_t kind = LSAP_ROW_ORDER_INDEX;
+    int layout = LAYOUT_PLAIN;
+    bool maximize = false;
+    static const char* const row_orders[] = { "index", "random", "regret", "min_cost" };
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (arg == "--maximize") {
+            maximize = true;
+            continue;
+        }
+        if (value == nullptr) {
+            return usage(argv[0]);
+        }
+        i++;
+        if (arg == "--shape") {
+            if (!parse_shape(value, &nr, &nc)) {
+                return usage(argv[0]);
+            }
+        } else if (arg == "--dtype") {
+            dtype = parse_dtype(value);
+        } else if (arg == "--layout") {
+            layout = -1;
+            for (int l = 0; l < 3; l++) {
+                if (strcmp(value, layout_names[l]) == 0) {
+                    layout = l;
+                }
+            }
+            if (layout < 0) {
+                return usage(argv[0]);
+            }
+        } else if (arg == "--row-order") {
+            kind = -1;
+            for (int k = 0; k < 4; k++) {
+                if (strcmp(value, row_orders[k]) == 0) {
+                    kind = k;
+                }
+            }
+            if (kind < 0) {
+                return usage(argv[0]);
+            }
+        } else if (arg == "--repeat") {
+            repeat = atol(value);
+            if (repeat < 1) {
+                return usage(argv[0]);
+            }
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    if (dtype == LSAP_INVALID) {
+        return usage(argv[0]);
+    }
+
+    printf("shape %ldx%ld dtype %s layout %s%s, mean of %ld\n", (long)nr, (long)nc,
+           dtype_names[dtype], layout_names[layout], maximize ? " maximize" : "", (long)repeat);
+    LSAP_DTYPE_SWITCH(dtype, T, return run<T>(nr, nc, layout, maximize, kind, repeat));
+}
@@ -1,5 +1,6 @@
 import os
 import platform
+import sysconfig
 
 import numpy
 from setuptools import setup, Extension
@@ -9,6 +10,10 @@ PY_LIMITED_API_VERSION = (3, 7)
 PY_LIMITED_API_MACRO = f"0x{PY_LIMITED_API_VERSION[0]:02x}{PY_LIMITED_API_VERSION[1]:02x}0000"
 PY_LIMITED_API_TAG = f"cp{PY_LIMITED_API_VERSION[0]}{PY_LIMITED_API_VERSION[1]}"
 
+# The stable ABI has no free-threaded variant, those builds get a version
+# specific extension declaring Py_mod_gil instead.
+FREE_THREADED = bool(sysconfig.get_config_var("Py_GIL_DISABLED"))
+
 cmdclass = {}
 
 os.environ["LDFLAGS"] = "-s"
@@ -39,15 +44,28 @@ setup_args = dict(
     ext_modules=[
         Extension(
             "nanolsap._lsap",
-            ["src/nanolsap/_lsap.c", "src/nanolsap/rectangular_lsap/rectangular_lsap.cpp"],
-            py_limited_api=True,
+            [
+                "src/nanolsap/_lsap.c",
+                "src/nanolsap/rectangular_lsap/rectangular_lsap.cpp",
+                "src/nanolsap/rectangular_lsap/k_best.cpp",
+                "src/nanolsap/rectangular_lsap/bottleneck.cpp",
+                "src/nanolsap/rectangular_lsap/transport.cpp",
+                "src/nanolsap/rectangular_lsap/sinkhorn.cpp",
+                "src/nanolsap/rectangular_lsap/greedy.cpp",
+                "src/nanolsap/rectangular_lsap/axial.cpp",
+                "src/nanolsap/rectangular_lsap/multiscale.cpp",
+                "src/nanolsap/rectangular_lsap/verify.cpp",
+                "src/nanolsap/rectangular_lsap/solver.cpp",
+            ],
+            py_limited_api=not FREE_THREADED,
             include_dirs=[numpy.get_include()],
-            define_macros=[("Py_LIMITED_API", PY_LIMITED_API_MACRO), ("PY_SSIZE_T_CLEAN", 1)],
+            define_macros=([] if FREE_THREADED else [("Py_LIMITED_API", PY_LIMITED_API_MACRO)]) +
+                          [("PY_SSIZE_T_CLEAN", 1)],
         )
     ],
     cmdclass=cmdclass,
     options=dict(
-        bdist_wheel={
+        bdist_wheel={} if FREE_THREADED else {
             "py_limited_api": PY_LIMITED_API_TAG,
         },
     )
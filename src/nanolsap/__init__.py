@@ -1,4 +1,28 @@
-from ._lsap import linear_sum_assignment
+from ._lsap import (
+    linear_sum_assignment,
+    k_best_assignments,
+    transport,
+    multiscale_assignment,
+    axial_assignment,
+    estimate_memory,
+    verify_assignment,
+    get_tuning,
+    set_tuning,
+)
+from .estimation import estimate
+from .trace import trace_to_chrome
+from .tuning import autotune
+from . import capture as _capture
+from . import tuning as _tuning
+
+# a no-op unless NANOLSAP_CAPTURE is set
+linear_sum_assignment = _capture.from_environ(linear_sum_assignment)
+
+try:
+    _tuning.load()
+except Exception:
+    # a damaged cache must not break the import, autotune rewrites it
+    pass
 
 
 try:
@@ -14,5 +38,16 @@ except Exception:
 
 __all__ = [
     "linear_sum_assignment",
+    "k_best_assignments",
+    "transport",
+    "multiscale_assignment",
+    "axial_assignment",
+    "estimate_memory",
+    "estimate",
+    "verify_assignment",
+    "get_tuning",
+    "set_tuning",
+    "autotune",
+    "trace_to_chrome",
     "__version__",
 ]
@@ -32,6 +32,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "numpy/arrayobject.h"
 #include "numpy/ndarraytypes.h"
 #include "rectangular_lsap/rectangular_lsap.h"
+#include "rectangular_lsap/lsap_solver.h"
 
 
 static intptr_t convert_npy_typ_to_lsap_typ(intptr_t npy_typ) {
@@ -69,104 +70,1316 @@ static intptr_t convert_npy_typ_to_lsap_typ(intptr_t npy_typ) {
     }
 }
 
+/* Per module state, so every interpreter importing _lsap has its own
+   references and the module keeps no mutable globals. */
+struct lsap_module_state {
+    /* numpy.from_dlpack, NULL before numpy 1.22 */
+    PyObject* from_dlpack;
+};
+
+static struct lsap_module_state*
+get_module_state(PyObject* module)
+{
+    return (struct lsap_module_state*)PyModule_GetState(module);
+}
+
+/* An array viewing the memory of obj_cost when it is a numpy array or
+   exports __dlpack__, the array interface or the buffer protocol, with its
+   dtype: a torch tensor, a memoryview or an Arrow buffer is not copied.  A
+   __dlpack__ that fails, for a device tensor say, and sequences are left
+   to numpy to convert.  The buffer is taken through a memoryview, as
+   PyObject_CheckBuffer is not in the limited API before 3.11. */
+static PyArrayObject*
+as_array_view(PyObject* module, PyObject* obj_cost)
+{
+    PyObject* from_dlpack = get_module_state(module)->from_dlpack;
+    if (PyArray_Check(obj_cost)) {
+        Py_INCREF(obj_cost);
+        return (PyArrayObject*)obj_cost;
+    }
+    if (from_dlpack != NULL && PyObject_HasAttrString(obj_cost, "__dlpack__")) {
+        PyObject* array = PyObject_CallFunctionObjArgs(from_dlpack, obj_cost, NULL);
+        if (array != NULL && PyArray_Check(array)) {
+            return (PyArrayObject*)array;
+        }
+        Py_XDECREF(array);
+        PyErr_Clear();
+    }
+    PyObject* source = NULL;
+    if (PyObject_HasAttrString(obj_cost, "__array_interface__")
+        || PyObject_HasAttrString(obj_cost, "__array_struct__")) {
+        Py_INCREF(obj_cost);
+        source = obj_cost;
+    }
+    else {
+        source = PyMemoryView_FromObject(obj_cost);
+        if (source == NULL) {
+            PyErr_Clear();
+            return NULL;
+        }
+    }
+    PyObject* array = PyArray_FromAny(source, NULL, 0, 0, 0, NULL);
+    Py_DECREF(source);
+    if (array == NULL) {
+        PyErr_Clear();
+    }
+    return (PyArrayObject*)array;
+}
+
+/* Bytes converting the array view to a contiguous array of a supported
+   dtype copies: none for a C contiguous, aligned and native array of a
+   supported dtype, the whole matrix otherwise. */
+static npy_intp
+cost_copy_bytes(PyArrayObject* view)
+{
+    if (convert_npy_typ_to_lsap_typ(PyArray_TYPE(view)) == LSAP_INVALID) {
+        return PyArray_SIZE(view) * (npy_intp)sizeof(double);
+    }
+    if (PyArray_ISCARRAY_RO(view) && PyArray_ISNOTSWAPPED(view)) {
+        return 0;
+    }
+    return PyArray_NBYTES(view);
+}
+
+/* Convert obj_cost to a contiguous array of ndim dimensions without
+   changing a supported dtype, so the solver can run on it in place.  The
+   solvers only read the costs, so read-only memory is not copied.  obj_cost
+   is viewed once, and a copy over memory_limit bytes (unless negative) is
+   refused before it is made.  *p_copy_bytes, if not NULL, receives the
+   bytes copied. */
+static PyArrayObject*
+as_cost_array_nd(PyObject* module, PyObject* obj_cost, int ndim, npy_intp memory_limit,
+                 npy_intp* p_copy_bytes, intptr_t* p_dtype)
+{
+    intptr_t npy_typ = NPY_DOUBLE;
+    intptr_t dtype = LSAP_DOUBLE;
+    npy_intp copy_bytes = -1;
+    PyArrayObject* view = as_array_view(module, obj_cost);
+    if (view != NULL) {
+        intptr_t tmp_npy_typ = PyArray_TYPE(view);
+        intptr_t tmp_dtype = convert_npy_typ_to_lsap_typ(tmp_npy_typ);
+        if (tmp_dtype != LSAP_INVALID) {
+            npy_typ = tmp_npy_typ;
+            dtype = tmp_dtype;
+        }
+        copy_bytes = cost_copy_bytes(view);
+        if (memory_limit >= 0 && copy_bytes > memory_limit) {
+            PyErr_Format(PyExc_MemoryError,
+                         "copy of the cost matrix takes %zd bytes, over memory_limit",
+                         (Py_ssize_t)copy_bytes);
+            Py_DECREF((PyObject*)view);
+            return NULL;
+        }
+    }
+
+    PyArrayObject* obj_cont = (PyArrayObject*)PyArray_FromAny(
+        view != NULL ? (PyObject*)view : obj_cost, PyArray_DescrFromType(npy_typ), 0, 0,
+        NPY_ARRAY_C_CONTIGUOUS | NPY_ARRAY_ALIGNED, NULL);
+    Py_XDECREF((PyObject*)view);
+    if (!obj_cont) {
+        return NULL;
+    }
+
+    if (PyArray_NDIM(obj_cont) != ndim) {
+        if (ndim == 2) {
+            PyErr_Format(PyExc_ValueError,
+                         "expected a matrix (2-D array), got a %d array",
+                         PyArray_NDIM(obj_cont));
+        } else {
+            PyErr_Format(PyExc_ValueError,
+                         "expected a %d-D array, got a %d array",
+                         ndim, PyArray_NDIM(obj_cont));
+        }
+        Py_DECREF((PyObject*)obj_cont);
+        return NULL;
+    }
+
+    if (PyArray_DATA(obj_cont) == NULL) {
+        PyErr_SetString(PyExc_TypeError, "invalid cost matrix object");
+        Py_DECREF((PyObject*)obj_cont);
+        return NULL;
+    }
+
+    if (p_copy_bytes != NULL) {
+        // a sequence is all copied, its size only known once converted
+        *p_copy_bytes = copy_bytes >= 0 ? copy_bytes : PyArray_NBYTES(obj_cont);
+    }
+    *p_dtype = dtype;
+    return obj_cont;
+}
+
+static PyArrayObject*
+as_cost_array(PyObject* module, PyObject* obj_cost, intptr_t* p_dtype)
+{
+    return as_cost_array_nd(module, obj_cost, 2, -1, NULL, p_dtype);
+}
+
+/* Convert a subrows or subcols argument to a contiguous intp array.  None
+   leaves *p_array NULL and *p_n zero.  Returns -1 with an exception set on
+   error. */
+static int
+as_subscript_array(PyObject* obj, const char* name, PyArrayObject** p_array,
+                   intptr_t** p_data, intptr_t* p_n)
+{
+    *p_array = NULL;
+    *p_data = NULL;
+    *p_n = 0;
+    if (obj == Py_None) {
+        return 0;
+    }
+    PyArrayObject* array = (PyArrayObject*)PyArray_ContiguousFromAny(obj, NPY_INTP, 0, 0);
+    if (!array) {
+        return -1;
+    }
+    if (PyArray_NDIM(array) != 1) {
+        PyErr_Format(PyExc_ValueError,
+                     "%s expected a 1-D array, got a %d array",
+                     name, PyArray_NDIM(array));
+        Py_DECREF((PyObject*)array);
+        return -1;
+    }
+    intptr_t* data = (intptr_t *)PyArray_DATA(array);
+    if (data == NULL) {
+        PyErr_Format(PyExc_TypeError, "invalid %s array object", name);
+        Py_DECREF((PyObject*)array);
+        return -1;
+    }
+    *p_array = array;
+    *p_data = data;
+    *p_n = PyArray_DIM(array, 0);
+    return 0;
+}
+
+/* Set the Python exception for a non-zero solver return code. */
+static void
+set_lsap_error(int ret)
+{
+    if (ret == RECTANGULAR_LSAP_INFEASIBLE) {
+        PyErr_SetString(PyExc_ValueError, "cost matrix is infeasible");
+    }
+    else if (ret == RECTANGULAR_LSAP_INVALID) {
+        PyErr_SetString(PyExc_ValueError,
+                        "matrix contains invalid numeric entries");
+    }
+    else if (ret == RECTANGULAR_LSAP_SUBSCRIPT_INVALID) {
+        PyErr_SetString(PyExc_ValueError,
+                        "subrows or subcols is invalid");
+    }
+    else if (ret == RECTANGULAR_LSAP_DTYPE_INVALID) {
+        PyErr_SetString(PyExc_ValueError,
+                        "dtype is invalid");
+    }
+    else if (ret == RECTANGULAR_LSAP_K_INVALID) {
+        PyErr_SetString(PyExc_ValueError,
+                        "k is invalid");
+    }
+    else if (ret == RECTANGULAR_LSAP_OBJECTIVE_INVALID) {
+        PyErr_SetString(PyExc_ValueError,
+                        "objective is invalid");
+    }
+    else if (ret == RECTANGULAR_LSAP_MASS_INVALID) {
+        PyErr_SetString(PyExc_ValueError,
+                        "supply or demand contains invalid entries");
+    }
+    else if (ret == RECTANGULAR_LSAP_ITERATION_LIMIT) {
+        PyErr_SetString(PyExc_RuntimeError,
+                        "iteration limit reached");
+    }
+    else if (ret == RECTANGULAR_LSAP_METRIC_INVALID) {
+        PyErr_SetString(PyExc_ValueError,
+                        "metric is invalid");
+    }
+    else if (ret == RECTANGULAR_LSAP_METHOD_INVALID) {
+        PyErr_SetString(PyExc_ValueError,
+                        "method does not support these arguments");
+    }
+    else if (ret == RECTANGULAR_LSAP_MEMORY_LIMIT) {
+        PyErr_SetString(PyExc_MemoryError,
+                        "solver workspace exceeds memory_limit");
+    }
+    else {
+        PyErr_Format(PyExc_RuntimeError, "solver failed with code %d", ret);
+    }
+}
+
+/* Convert a vector argument to a contiguous float64 array of length n. */
+static int
+as_vector_array(PyObject* obj, const char* name, npy_intp n,
+              PyArrayObject** p_array, double** p_data)
+{
+    PyArrayObject* array = (PyArrayObject*)PyArray_FROM_OTF(
+      obj, NPY_DOUBLE, NPY_ARRAY_IN_ARRAY);
+    if (!array) {
+        return -1;
+    }
+    if (PyArray_NDIM(array) != 1 || PyArray_DIM(array, 0) != n) {
+        PyErr_Format(PyExc_ValueError,
+                     "expected %s to be a vector of length %zd",
+                     name, (Py_ssize_t)n);
+        Py_DECREF((PyObject*)array);
+        return -1;
+    }
+    *p_array = array;
+    *p_data = PyArray_DATA(array);
+    return 0;
+}
+
+/* Parse an optional non-negative integer argument, None gives -1. */
+static int
+as_optional_count(PyObject* obj, const char* name, intptr_t* p_value)
+{
+    *p_value = -1;
+    if (obj == Py_None) {
+        return 0;
+    }
+    intptr_t value = PyLong_AsSsize_t(obj);
+    if (value == -1 && PyErr_Occurred()) {
+        return -1;
+    }
+    if (value < 0) {
+        PyErr_Format(PyExc_ValueError, "%s must be non-negative", name);
+        return -1;
+    }
+    *p_value = value;
+    return 0;
+}
+
+/* Map a str argument to its index in names, None keeps *p_value. */
+static int
+as_choice(PyObject* obj, const char* name, const char* const* names, intptr_t n,
+          const char* listing, intptr_t* p_value)
+{
+    if (obj == NULL || obj == Py_None) {
+        return 0;
+    }
+    if (!PyUnicode_Check(obj)) {
+        PyErr_Format(PyExc_TypeError, "%s must be a str", name);
+        return -1;
+    }
+    for (intptr_t i = 0; i < n; i++) {
+        if (PyUnicode_CompareWithASCIIString(obj, names[i]) == 0) {
+            *p_value = i;
+            return 0;
+        }
+    }
+    PyErr_Format(PyExc_ValueError, "%s must be %s, got %R", name, listing, obj);
+    return -1;
+}
+
+/* Map the objective argument to enum LSAP_OBJECTIVES. */
+static int
+as_objective(PyObject* obj, intptr_t* p_objective)
+{
+    static const char* names[] = { "sum", "bottleneck", "bottleneck_sum" };
+    *p_objective = LSAP_OBJECTIVE_SUM;
+    return as_choice(obj, "objective", names, sizeof(names) / sizeof(names[0]),
+                     "'sum', 'bottleneck' or 'bottleneck_sum'", p_objective);
+}
+
+/* Map the method argument to enum LSAP_METHODS. */
+static int
+as_method(PyObject* obj, intptr_t* p_method)
+{
+    static const char* names[] = { "exact", "sinkhorn", "greedy", "auto" };
+    *p_method = LSAP_METHOD_EXACT;
+    return as_choice(obj, "method", names, sizeof(names) / sizeof(names[0]),
+                     "'exact', 'sinkhorn', 'greedy' or 'auto'", p_method);
+}
+
+/* Map the row_order argument to enum LSAP_ROW_ORDERS. */
+static int
+as_row_order(PyObject* obj, intptr_t* p_row_order)
+{
+    static const char* names[] = { "index", "random", "regret", "min_cost" };
+    *p_row_order = LSAP_ROW_ORDER_INDEX;
+    return as_choice(obj, "row_order", names, sizeof(names) / sizeof(names[0]),
+                     "'index', 'random', 'regret' or 'min_cost'", p_row_order);
+}
+
+/* Map the metric argument to enum LSAP_METRICS. */
+static int
+as_metric(PyObject* obj, intptr_t* p_metric)
+{
+    static const char* names[] = { "euclidean", "sqeuclidean" };
+    *p_metric = LSAP_METRIC_EUCLIDEAN;
+    return as_choice(obj, "metric", names, sizeof(names) / sizeof(names[0]),
+                     "'euclidean' or 'sqeuclidean'", p_metric);
+}
+
+/* Convert a point set to a contiguous float64 array of shape (n, dim). */
+static PyArrayObject*
+as_points_array(PyObject* obj, const char* name)
+{
+    PyArrayObject* array = (PyArrayObject*)PyArray_FROM_OTF(
+      obj, NPY_DOUBLE, NPY_ARRAY_IN_ARRAY);
+    if (!array) {
+        return NULL;
+    }
+    if (PyArray_NDIM(array) != 2) {
+        PyErr_Format(PyExc_ValueError,
+                     "expected %s to be a matrix of points, got %d-D",
+                     name, PyArray_NDIM(array));
+        Py_DECREF((PyObject*)array);
+        return NULL;
+    }
+    return array;
+}
+
+/* The events of a trace as a structured array, oldest first. */
+static PyObject*
+trace_array(const struct lsap_trace* trace)
+{
+    PyArray_Descr* descr = NULL;
+    PyObject* fields = Py_BuildValue(
+      "[(ss)(ss)(ss)(ss)(ss)(ss)]", "row", "intp", "path_length", "intp",
+      "columns_scanned", "intp", "start", "f8", "duration", "f8", "path_cost", "f8");
+    if (!fields) {
+        return NULL;
+    }
+    int ok = PyArray_DescrConverter(fields, &descr);
+    Py_DECREF(fields);
+    if (!ok) {
+        return NULL;
+    }
+    npy_intp dim[1] = { trace->count < trace->capacity ? trace->count : trace->capacity };
+    PyObject* array = PyArray_NewFromDescr(&PyArray_Type, descr, 1, dim, NULL, NULL, 0, NULL);
+    if (!array) {
+        return NULL;
+    }
+    if (PyArray_ITEMSIZE((PyArrayObject*)array) != sizeof(struct lsap_trace_event)) {
+        PyErr_SetString(PyExc_RuntimeError, "unexpected layout of trace events");
+        Py_DECREF(array);
+        return NULL;
+    }
+    char* data = PyArray_DATA((PyArrayObject*)array);
+    for (npy_intp i = 0; i < dim[0]; i++) {
+        intptr_t index = (trace->count - dim[0] + i) % trace->capacity;
+        memcpy(data + i * sizeof(struct lsap_trace_event), &trace->events[index],
+               sizeof(struct lsap_trace_event));
+    }
+    return array;
+}
+
+static PyObject*
+linear_sum_assignment(PyObject* self, PyObject* args, PyObject* kwargs)
+{
+    PyObject* a = NULL;
+    PyObject* b = NULL;
+    PyObject* result = NULL;
+    PyObject* obj_cost = NULL;
+    PyArrayObject* obj_cont = NULL;
+    int maximize = 0;
+    PyObject* obj_subrows = Py_None;
+    PyObject* obj_subcols = Py_None;
+    PyArrayObject* array_subrows = NULL;
+    PyArrayObject* array_subcols = NULL;
+    intptr_t *subrows = NULL;
+    intptr_t n_subrows = 0;
+    intptr_t *subcols = NULL;
+    intptr_t n_subcols = 0;
+    PyObject* obj_k = Py_None;
+    intptr_t k = -1;
+    PyObject* obj_objective = Py_None;
+    intptr_t objective;
+    PyObject* obj_method = Py_None;
+    PyObject* obj_epsilon = Py_None;
+    PyObject* obj_max_iter = Py_None;
+    int repair = 0;
+    Py_ssize_t n_threads = 1;
+    int return_bound = 0;
+    PyObject* obj_row_order = Py_None;
+    int return_stats = 0;
+    struct lsap_stats stats = { "", "", Py_NAN };
+    PyObject* obj_stats = NULL;
+    Py_ssize_t trace_size = 0;
+    struct lsap_trace trace = { NULL, 0, 0 };
+    PyObject* obj_trace = NULL;
+    PyObject* obj_memory_limit = Py_None;
+    intptr_t memory_limit;
+    npy_intp copy_bytes;
+    double cost = 0;
+    double bound = 0;
+    struct lsap_options options;
+    intptr_t dtype;
+    static const char *kwlist[] = { (const char*)"cost_matrix",
+                                    (const char*)"maximize",
+                                    (const char*)"subrows",
+                                    (const char*)"subcols",
+                                    (const char*)"k",
+                                    (const char*)"objective",
+                                    (const char*)"method",
+                                    (const char*)"epsilon",
+                                    (const char*)"max_iter",
+                                    (const char*)"repair",
+                                    (const char*)"n_threads",
+                                    (const char*)"return_bound",
+                                    (const char*)"row_order",
+                                    (const char*)"return_stats",
+                                    (const char*)"trace",
+                                    (const char*)"memory_limit",
+                                    NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|pOOOOOOOpnpOpnO", (char**)kwlist,
+                                     &obj_cost, &maximize, &obj_subrows, &obj_subcols,
+                                     &obj_k, &obj_objective, &obj_method, &obj_epsilon,
+                                     &obj_max_iter, &repair, &n_threads, &return_bound,
+                                     &obj_row_order, &return_stats, &trace_size,
+                                     &obj_memory_limit)) {
+        return NULL;
+    }
+
+    lsap_options_init(&options);
+    if (as_method(obj_method, &options.method) < 0) {
+        return NULL;
+    }
+    if (obj_epsilon != Py_None) {
+        options.epsilon = PyFloat_AsDouble(obj_epsilon);
+        if (options.epsilon == -1.0 && PyErr_Occurred()) {
+            return NULL;
+        }
+        if (!(options.epsilon > 0)) {
+            PyErr_SetString(PyExc_ValueError, "epsilon must be positive");
+            return NULL;
+        }
+    }
+    if (obj_max_iter != Py_None &&
+        as_optional_count(obj_max_iter, "max_iter", &options.max_iter) < 0) {
+        return NULL;
+    }
+    if (n_threads < 1) {
+        PyErr_SetString(PyExc_ValueError, "n_threads must be positive");
+        return NULL;
+    }
+    options.repair = repair;
+    options.n_threads = n_threads;
+    if (as_row_order(obj_row_order, &options.row_order) < 0) {
+        return NULL;
+    }
+    if (return_stats) {
+        options.stats = &stats;
+    }
+    if (trace_size < 0) {
+        PyErr_SetString(PyExc_ValueError, "trace must not be negative");
+        return NULL;
+    }
+    if (trace_size > 0 && !return_stats) {
+        PyErr_SetString(PyExc_ValueError, "trace requires return_stats");
+        return NULL;
+    }
+
+    if (as_optional_count(obj_k, "k", &k) < 0) {
+        return NULL;
+    }
+    if (as_objective(obj_objective, &objective) < 0) {
+        return NULL;
+    }
+    if (return_bound && options.method != LSAP_METHOD_GREEDY) {
+        PyErr_SetString(PyExc_ValueError, "return_bound requires method='greedy'");
+        return NULL;
+    }
+    if (as_optional_count(obj_memory_limit, "memory_limit", &memory_limit) < 0) {
+        return NULL;
+    }
+
+    // refuse before copying what does not fit
+    obj_cont = as_cost_array_nd(self, obj_cost, 2, memory_limit, &copy_bytes, &dtype);
+    if (!obj_cont) {
+        return NULL;
+    }
+    void* cost_matrix = PyArray_DATA(obj_cont);
+
+    if (as_subscript_array(obj_subrows, "subrows", &array_subrows, &subrows, &n_subrows) < 0) {
+        goto cleanup;
+    }
+    if (as_subscript_array(obj_subcols, "subcols", &array_subcols, &subcols, &n_subcols) < 0) {
+        goto cleanup;
+    }
+
+    npy_intp num_rows = PyArray_DIM(obj_cont, 0);
+    npy_intp num_cols = PyArray_DIM(obj_cont, 1);
+    npy_intp dim_num_rows = n_subrows ? n_subrows : num_rows;
+    npy_intp dim_num_cols = n_subcols ? n_subcols : num_cols;
+    npy_intp dim[1] = { dim_num_rows < dim_num_cols ? dim_num_rows : dim_num_cols };
+    if (trace_size > 0) {
+        trace.capacity = trace_size;
+        trace.events = PyMem_Malloc(trace_size * sizeof(struct lsap_trace_event));
+        if (!trace.events) {
+            PyErr_NoMemory();
+            goto cleanup;
+        }
+        options.trace = &trace;
+    }
+    if (k > dim[0]) {
+        PyErr_Format(PyExc_ValueError,
+                     "k must not exceed min(nr, nc) = %zd, got %zd",
+                     (Py_ssize_t)dim[0], (Py_ssize_t)k);
+        goto cleanup;
+    }
+    if (k >= 0) {
+        dim[0] = k;
+    }
+    if (memory_limit >= 0) {
+        // the solver gets what the copy, the result and the trace leave
+        options.memory_limit = memory_limit - copy_bytes - 2 * dim[0] * (npy_intp)sizeof(int64_t) -
+            trace_size * (npy_intp)sizeof(struct lsap_trace_event);
+        if (options.memory_limit < 0) {
+            PyErr_SetString(PyExc_MemoryError, "result exceeds memory_limit");
+            goto cleanup;
+        }
+    }
+    a = PyArray_SimpleNew(1, dim, NPY_INT64);
+    if (!a)
+        goto cleanup;
+
+    b = PyArray_SimpleNew(1, dim, NPY_INT64);
+    if (!b)
+        goto cleanup;
+
+    int64_t* a_data = PyArray_DATA((PyArrayObject*)a);
+    int64_t* b_data = PyArray_DATA((PyArrayObject*)b);
+    int ret;
+    NPY_BEGIN_ALLOW_THREADS
+    if (return_bound && k < 0 && objective == LSAP_OBJECTIVE_SUM) {
+        stats.engine = "greedy";
+        stats.reason = "requested";
+        ret = greedy_rectangular_linear_sum_assignment_dtype(
+          num_rows, num_cols, cost_matrix, dtype, maximize,
+          subrows, n_subrows, subcols, n_subcols,
+          &options, a_data, b_data, &cost, &bound);
+    } else {
+        ret = lsap_solve_dtype(
+          num_rows, num_cols, cost_matrix, dtype, maximize,
+          subrows, n_subrows, subcols, n_subcols,
+          k, objective, &options, a_data, b_data);
+    }
+    NPY_END_ALLOW_THREADS
+
+    if (ret != 0) {
+        set_lsap_error(ret);
+        goto cleanup;
+    }
+
+    if (return_stats) {
+        obj_stats = Py_BuildValue(
+            "{sssssdsdsdsdsnsnsdsnsnsnsn}", "engine", stats.engine,
+            "reason", stats.reason, "density", stats.density,
+            "validation_seconds", stats.validation_seconds,
+            "setup_seconds", stats.setup_seconds,
+            "augment_seconds", stats.augment_seconds,
+            "augmentations", (Py_ssize_t)stats.augmentations,
+            "columns_scanned", (Py_ssize_t)stats.columns_scanned,
+            "path_length_mean", stats.path_length_mean,
+            "path_length_max", (Py_ssize_t)stats.path_length_max,
+            "dual_updates", (Py_ssize_t)stats.dual_updates,
+            "tie_breaks", (Py_ssize_t)stats.tie_breaks,
+            "workspace_bytes", (Py_ssize_t)stats.workspace_bytes);
+        if (!obj_stats) {
+            goto cleanup;
+        }
+    }
+    if (trace_size > 0) {
+        obj_trace = trace_array(&trace);
+        if (!obj_trace || PyDict_SetItemString(obj_stats, "trace", obj_trace) < 0) {
+            goto cleanup;
+        }
+    }
+    if (return_bound && return_stats) {
+        result = Py_BuildValue("OOddO", a, b, cost, bound, obj_stats);
+    } else if (return_bound) {
+        result = Py_BuildValue("OOdd", a, b, cost, bound);
+    } else if (return_stats) {
+        result = Py_BuildValue("OOO", a, b, obj_stats);
+    } else {
+        result = Py_BuildValue("OO", a, b);
+    }
+
+cleanup:
+    PyMem_Free(trace.events);
+    Py_XDECREF(obj_trace);
+    Py_XDECREF(obj_stats);
+    Py_XDECREF((PyObject*)array_subcols);
+    Py_XDECREF((PyObject*)array_subrows);
+    Py_XDECREF((PyObject*)obj_cont);
+    Py_XDECREF(a);
+    Py_XDECREF(b);
+    return result;
+}
+
+static PyObject*
+estimate_memory(PyObject* self, PyObject* args, PyObject* kwargs)
+{
+    PyObject* result = NULL;
+    PyObject* obj_cost = NULL;
+    PyArrayObject* obj_cont = NULL;
+    int maximize = 0;
+    PyObject* obj_subrows = Py_None;
+    PyObject* obj_subcols = Py_None;
+    PyArrayObject* array_subrows = NULL;
+    PyArrayObject* array_subcols = NULL;
+    intptr_t *subrows = NULL;
+    intptr_t n_subrows = 0;
+    intptr_t *subcols = NULL;
+    intptr_t n_subcols = 0;
+    PyObject* obj_k = Py_None;
+    intptr_t k = -1;
+    PyObject* obj_objective = Py_None;
+    intptr_t objective;
+    PyObject* obj_method = Py_None;
+    int repair = 0;
+    Py_ssize_t n_threads = 1;
+    PyObject* obj_row_order = Py_None;
+    Py_ssize_t trace_size = 0;
+    struct lsap_options options;
+    struct lsap_estimate estimate;
+    npy_intp copy_bytes;
+    intptr_t dtype;
+    static const char *kwlist[] = { (const char*)"cost_matrix",
+                                    (const char*)"maximize",
+                                    (const char*)"subrows",
+                                    (const char*)"subcols",
+                                    (const char*)"k",
+                                    (const char*)"objective",
+                                    (const char*)"method",
+                                    (const char*)"repair",
+                                    (const char*)"n_threads",
+                                    (const char*)"row_order",
+                                    (const char*)"trace",
+                                    NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|pOOOOOpnOn", (char**)kwlist,
+                                     &obj_cost, &maximize, &obj_subrows, &obj_subcols,
+                                     &obj_k, &obj_objective, &obj_method, &repair,
+                                     &n_threads, &obj_row_order, &trace_size)) {
+        return NULL;
+    }
+
+    lsap_options_init(&options);
+    if (as_method(obj_method, &options.method) < 0) {
+        return NULL;
+    }
+    if (n_threads < 1) {
+        PyErr_SetString(PyExc_ValueError, "n_threads must be positive");
+        return NULL;
+    }
+    if (trace_size < 0) {
+        PyErr_SetString(PyExc_ValueError, "trace must not be negative");
+        return NULL;
+    }
+    options.repair = repair;
+    options.n_threads = n_threads;
+    if (as_row_order(obj_row_order, &options.row_order) < 0) {
+        return NULL;
+    }
+    if (as_optional_count(obj_k, "k", &k) < 0) {
+        return NULL;
+    }
+    if (as_objective(obj_objective, &objective) < 0) {
+        return NULL;
+    }
+
+    obj_cont = as_cost_array_nd(self, obj_cost, 2, -1, &copy_bytes, &dtype);
+    if (!obj_cont) {
+        return NULL;
+    }
+    if (as_subscript_array(obj_subrows, "subrows", &array_subrows, &subrows, &n_subrows) < 0) {
+        goto cleanup;
+    }
+    if (as_subscript_array(obj_subcols, "subcols", &array_subcols, &subcols, &n_subcols) < 0) {
+        goto cleanup;
+    }
+
+    int ret;
+    NPY_BEGIN_ALLOW_THREADS
+    ret = lsap_estimate_dtype(
+        PyArray_DIM(obj_cont, 0), PyArray_DIM(obj_cont, 1), PyArray_DATA(obj_cont),
+        dtype, maximize, subrows, n_subrows, subcols, n_subcols, k, objective,
+        &options, &estimate);
+    NPY_END_ALLOW_THREADS
+    if (ret != 0) {
+        set_lsap_error(ret);
+        goto cleanup;
+    }
+
+    npy_intp trace_bytes = trace_size * (npy_intp)sizeof(struct lsap_trace_event);
+    result = Py_BuildValue(
+        "{sssdsnsnsnsnsn}", "engine", estimate.engine, "density", estimate.density,
+        "copy_bytes", (Py_ssize_t)copy_bytes,
+        "workspace_bytes", (Py_ssize_t)estimate.workspace_bytes,
+        "output_bytes", (Py_ssize_t)estimate.output_bytes,
+        "trace_bytes", (Py_ssize_t)trace_bytes,
+        "total_bytes", (Py_ssize_t)(copy_bytes + estimate.workspace_bytes +
+                                    estimate.output_bytes + trace_bytes));
+
+cleanup:
+    Py_XDECREF((PyObject*)array_subcols);
+    Py_XDECREF((PyObject*)array_subrows);
+    Py_XDECREF((PyObject*)obj_cont);
+    return result;
+}
+
+/* Convert an index vector to a contiguous int64 array. */
+static int
+as_index_array(PyObject* obj, const char* name, PyArrayObject** p_array)
+{
+    PyArrayObject* array = (PyArrayObject*)PyArray_FROM_OTF(
+      obj, NPY_INT64, NPY_ARRAY_IN_ARRAY | NPY_ARRAY_FORCECAST);
+    if (!array) {
+        return -1;
+    }
+    if (PyArray_NDIM(array) != 1) {
+        PyErr_Format(PyExc_ValueError,
+                     "%s expected a 1-D array, got a %d array",
+                     name, PyArray_NDIM(array));
+        Py_DECREF((PyObject*)array);
+        return -1;
+    }
+    *p_array = array;
+    return 0;
+}
+
+static PyObject*
+verify_assignment(PyObject* self, PyObject* args, PyObject* kwargs)
+{
+    PyObject* result = NULL;
+    PyObject* obj_cost = NULL;
+    PyArrayObject* obj_cont = NULL;
+    PyObject* obj_row_ind = NULL;
+    PyObject* obj_col_ind = NULL;
+    PyArrayObject* array_row_ind = NULL;
+    PyArrayObject* array_col_ind = NULL;
+    PyObject* obj_u = Py_None;
+    PyObject* obj_v = Py_None;
+    PyArrayObject* array_u = NULL;
+    PyArrayObject* array_v = NULL;
+    double* u = NULL;
+    double* v = NULL;
+    int maximize = 0;
+    PyObject* obj_subrows = Py_None;
+    PyObject* obj_subcols = Py_None;
+    PyArrayObject* array_subrows = NULL;
+    PyArrayObject* array_subcols = NULL;
+    intptr_t *subrows = NULL;
+    intptr_t n_subrows = 0;
+    intptr_t *subcols = NULL;
+    intptr_t n_subcols = 0;
+    double tol = 1e-9;
+    Py_ssize_t n_threads = 1;
+    struct lsap_certificate certificate;
+    intptr_t dtype;
+    static const char *kwlist[] = { (const char*)"cost_matrix",
+                                    (const char*)"row_ind",
+                                    (const char*)"col_ind",
+                                    (const char*)"u",
+                                    (const char*)"v",
+                                    (const char*)"maximize",
+                                    (const char*)"subrows",
+                                    (const char*)"subcols",
+                                    (const char*)"tol",
+                                    (const char*)"n_threads",
+                                    NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OOO|OOpOOdn", (char**)kwlist,
+                                     &obj_cost, &obj_row_ind, &obj_col_ind, &obj_u, &obj_v,
+                                     &maximize, &obj_subrows, &obj_subcols, &tol,
+                                     &n_threads)) {
+        return NULL;
+    }
+    if ((obj_u == Py_None) != (obj_v == Py_None)) {
+        PyErr_SetString(PyExc_ValueError, "u and v must be given together");
+        return NULL;
+    }
+    if (!(tol >= 0)) {
+        PyErr_SetString(PyExc_ValueError, "tol must not be negative");
+        return NULL;
+    }
+    if (n_threads < 1) {
+        PyErr_SetString(PyExc_ValueError, "n_threads must be positive");
+        return NULL;
+    }
+
+    obj_cont = as_cost_array(self, obj_cost, &dtype);
+    if (!obj_cont) {
+        return NULL;
+    }
+    if (as_subscript_array(obj_subrows, "subrows", &array_subrows, &subrows, &n_subrows) < 0) {
+        goto cleanup;
+    }
+    if (as_subscript_array(obj_subcols, "subcols", &array_subcols, &subcols, &n_subcols) < 0) {
+        goto cleanup;
+    }
+    if (as_index_array(obj_row_ind, "row_ind", &array_row_ind) < 0 ||
+        as_index_array(obj_col_ind, "col_ind", &array_col_ind) < 0) {
+        goto cleanup;
+    }
+    if (PyArray_DIM(array_row_ind, 0) != PyArray_DIM(array_col_ind, 0)) {
+        PyErr_SetString(PyExc_ValueError, "row_ind and col_ind must have the same length");
+        goto cleanup;
+    }
+
+    npy_intp num_rows = PyArray_DIM(obj_cont, 0);
+    npy_intp num_cols = PyArray_DIM(obj_cont, 1);
+    if (obj_u != Py_None) {
+        if (as_vector_array(obj_u, "u", n_subrows ? n_subrows : num_rows, &array_u, &u) < 0 ||
+            as_vector_array(obj_v, "v", n_subcols ? n_subcols : num_cols, &array_v, &v) < 0) {
+            goto cleanup;
+        }
+    }
+
+    int ret;
+    NPY_BEGIN_ALLOW_THREADS
+    ret = lsap_verify_dtype(
+        num_rows, num_cols, PyArray_DATA(obj_cont), dtype, maximize,
+        subrows, n_subrows, subcols, n_subcols,
+        PyArray_DATA(array_row_ind), PyArray_DATA(array_col_ind),
+        PyArray_DIM(array_row_ind, 0), u, v, tol, n_threads, &certificate);
+    NPY_END_ALLOW_THREADS
+    if (ret != 0) {
+        set_lsap_error(ret);
+        goto cleanup;
+    }
+
+    result = Py_BuildValue(
+        "{sOsOsdsdsdsdsd}",
+        "valid", certificate.valid ? Py_True : Py_False,
+        "proven_optimal", certificate.proven_optimal ? Py_True : Py_False,
+        "cost", certificate.cost, "bound", certificate.bound, "gap", certificate.gap,
+        "max_violation", certificate.max_violation, "max_slack", certificate.max_slack);
+
+cleanup:
+    Py_XDECREF((PyObject*)array_v);
+    Py_XDECREF((PyObject*)array_u);
+    Py_XDECREF((PyObject*)array_col_ind);
+    Py_XDECREF((PyObject*)array_row_ind);
+    Py_XDECREF((PyObject*)array_subcols);
+    Py_XDECREF((PyObject*)array_subrows);
+    Py_XDECREF((PyObject*)obj_cont);
+    return result;
+}
+
+static PyObject*
+get_tuning(PyObject* self, PyObject* args)
+{
+    struct lsap_tuning tuning;
+    lsap_get_tuning(&tuning);
+    return Py_BuildValue("{sdsn}", "sparse_density", tuning.sparse_density,
+                         "entries_per_thread", (Py_ssize_t)tuning.entries_per_thread);
+}
+
+static PyObject*
+set_tuning(PyObject* self, PyObject* args, PyObject* kwargs)
+{
+    struct lsap_tuning tuning;
+    PyObject* obj_sparse_density = Py_None;
+    PyObject* obj_entries_per_thread = Py_None;
+    int defaults = 0;
+    static const char *kwlist[] = { (const char*)"sparse_density",
+                                    (const char*)"entries_per_thread",
+                                    (const char*)"defaults",
+                                    NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|OOp", (char**)kwlist,
+                                     &obj_sparse_density, &obj_entries_per_thread,
+                                     &defaults)) {
+        return NULL;
+    }
+
+    if (defaults) {
+        lsap_tuning_defaults(&tuning);
+    } else {
+        lsap_get_tuning(&tuning);
+    }
+    if (obj_sparse_density != Py_None) {
+        tuning.sparse_density = PyFloat_AsDouble(obj_sparse_density);
+        if (tuning.sparse_density == -1.0 && PyErr_Occurred()) {
+            return NULL;
+        }
+    }
+    if (obj_entries_per_thread != Py_None) {
+        tuning.entries_per_thread = PyLong_AsSsize_t(obj_entries_per_thread);
+        if (tuning.entries_per_thread == -1 && PyErr_Occurred()) {
+            return NULL;
+        }
+    }
+    if (lsap_set_tuning(&tuning) != 0) {
+        PyErr_SetString(PyExc_ValueError,
+                        "sparse_density must be a number and entries_per_thread positive");
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject*
+k_best_assignments(PyObject* self, PyObject* args, PyObject* kwargs)
+{
+    PyObject* a = NULL;
+    PyObject* b = NULL;
+    PyObject* c = NULL;
+    PyObject* result = NULL;
+    PyObject* obj_cost = NULL;
+    PyArrayObject* obj_cont = NULL;
+    Py_ssize_t k = 0;
+    int maximize = 0;
+    PyObject* obj_subrows = Py_None;
+    PyObject* obj_subcols = Py_None;
+    PyArrayObject* array_subrows = NULL;
+    PyArrayObject* array_subcols = NULL;
+    intptr_t *subrows = NULL;
+    intptr_t n_subrows = 0;
+    intptr_t *subcols = NULL;
+    intptr_t n_subcols = 0;
+    Py_ssize_t n_threads = 1;
+    intptr_t dtype;
+    static const char *kwlist[] = { (const char*)"cost_matrix",
+                                    (const char*)"k",
+                                    (const char*)"maximize",
+                                    (const char*)"subrows",
+                                    (const char*)"subcols",
+                                    (const char*)"n_threads",
+                                    NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "On|pOOn", (char**)kwlist,
+                                     &obj_cost, &k, &maximize, &obj_subrows, &obj_subcols,
+                                     &n_threads)) {
+        return NULL;
+    }
+    if (k < 0) {
+        PyErr_SetString(PyExc_ValueError, "k must be non-negative");
+        return NULL;
+    }
+    if (n_threads < 1) {
+        PyErr_SetString(PyExc_ValueError, "n_threads must be positive");
+        return NULL;
+    }
+
+    obj_cont = as_cost_array(self, obj_cost, &dtype);
+    if (!obj_cont) {
+        return NULL;
+    }
+    void* cost_matrix = PyArray_DATA(obj_cont);
+
+    if (as_subscript_array(obj_subrows, "subrows", &array_subrows, &subrows, &n_subrows) < 0) {
+        goto cleanup;
+    }
+    if (as_subscript_array(obj_subcols, "subcols", &array_subcols, &subcols, &n_subcols) < 0) {
+        goto cleanup;
+    }
+
+    npy_intp num_rows = PyArray_DIM(obj_cont, 0);
+    npy_intp num_cols = PyArray_DIM(obj_cont, 1);
+    npy_intp dim_num_rows = n_subrows ? n_subrows : num_rows;
+    npy_intp dim_num_cols = n_subcols ? n_subcols : num_cols;
+    npy_intp dim[2] = { k, dim_num_rows < dim_num_cols ? dim_num_rows : dim_num_cols };
+    a = PyArray_SimpleNew(2, dim, NPY_INT64);
+    if (!a)
+        goto cleanup;
+
+    b = PyArray_SimpleNew(2, dim, NPY_INT64);
+    if (!b)
+        goto cleanup;
+
+    c = PyArray_SimpleNew(1, dim, NPY_DOUBLE);
+    if (!c)
+        goto cleanup;
+
+    int64_t* a_data = PyArray_DATA((PyArrayObject*)a);
+    int64_t* b_data = PyArray_DATA((PyArrayObject*)b);
+    double* c_data = PyArray_DATA((PyArrayObject*)c);
+    intptr_t found = 0;
+    int ret;
+    NPY_BEGIN_ALLOW_THREADS
+    ret = k_best_rectangular_linear_sum_assignment_dtype(
+      num_rows, num_cols, cost_matrix, dtype, maximize,
+      subrows, n_subrows, subcols, n_subcols,
+      k, n_threads, a_data, b_data, c_data, &found);
+    NPY_END_ALLOW_THREADS
+
+    if (ret != 0) {
+        set_lsap_error(ret);
+        goto cleanup;
+    }
+
+    if (found < k) {
+        /* fewer assignments exist than requested, keep views of the head */
+        PyObject* a_head = PySequence_GetSlice(a, 0, found);
+        PyObject* b_head = PySequence_GetSlice(b, 0, found);
+        PyObject* c_head = PySequence_GetSlice(c, 0, found);
+        if (a_head && b_head && c_head) {
+            result = Py_BuildValue("OOO", a_head, b_head, c_head);
+        }
+        Py_XDECREF(a_head);
+        Py_XDECREF(b_head);
+        Py_XDECREF(c_head);
+        goto cleanup;
+    }
+
+    result = Py_BuildValue("OOO", a, b, c);
+
+cleanup:
+    Py_XDECREF((PyObject*)array_subcols);
+    Py_XDECREF((PyObject*)array_subrows);
+    Py_XDECREF((PyObject*)obj_cont);
+    Py_XDECREF(a);
+    Py_XDECREF(b);
+    Py_XDECREF(c);
+    return result;
+}
+
+static PyObject*
+transport(PyObject* self, PyObject* args, PyObject* kwargs)
+{
+    PyObject* a = NULL;
+    PyObject* b = NULL;
+    PyObject* f = NULL;
+    PyObject* result = NULL;
+    PyObject* obj_cost = NULL;
+    PyArrayObject* obj_cont = NULL;
+    PyObject* obj_supply = NULL;
+    PyObject* obj_demand = NULL;
+    PyArrayObject* array_supply = NULL;
+    PyArrayObject* array_demand = NULL;
+    double* supply = NULL;
+    double* demand = NULL;
+    int maximize = 0;
+    PyObject* obj_subrows = Py_None;
+    PyObject* obj_subcols = Py_None;
+    PyArrayObject* array_subrows = NULL;
+    PyArrayObject* array_subcols = NULL;
+    intptr_t *subrows = NULL;
+    intptr_t n_subrows = 0;
+    intptr_t *subcols = NULL;
+    intptr_t n_subcols = 0;
+    PyObject* obj_max_iter = Py_None;
+    intptr_t max_iter = -1;
+    intptr_t dtype;
+    static const char *kwlist[] = { (const char*)"cost_matrix",
+                                    (const char*)"supply",
+                                    (const char*)"demand",
+                                    (const char*)"maximize",
+                                    (const char*)"subrows",
+                                    (const char*)"subcols",
+                                    (const char*)"max_iter",
+                                    NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OOO|pOOO", (char**)kwlist,
+                                     &obj_cost, &obj_supply, &obj_demand, &maximize,
+                                     &obj_subrows, &obj_subcols, &obj_max_iter)) {
+        return NULL;
+    }
+
+    if (as_optional_count(obj_max_iter, "max_iter", &max_iter) < 0) {
+        return NULL;
+    }
+
+    obj_cont = as_cost_array(self, obj_cost, &dtype);
+    if (!obj_cont) {
+        return NULL;
+    }
+    void* cost_matrix = PyArray_DATA(obj_cont);
+
+    if (as_subscript_array(obj_subrows, "subrows", &array_subrows, &subrows, &n_subrows) < 0) {
+        goto cleanup;
+    }
+    if (as_subscript_array(obj_subcols, "subcols", &array_subcols, &subcols, &n_subcols) < 0) {
+        goto cleanup;
+    }
+
+    npy_intp num_rows = PyArray_DIM(obj_cont, 0);
+    npy_intp num_cols = PyArray_DIM(obj_cont, 1);
+    npy_intp dim_num_rows = n_subrows ? n_subrows : num_rows;
+    npy_intp dim_num_cols = n_subcols ? n_subcols : num_cols;
+    if (as_vector_array(obj_supply, "supply", dim_num_rows, &array_supply, &supply) < 0) {
+        goto cleanup;
+    }
+    if (as_vector_array(obj_demand, "demand", dim_num_cols, &array_demand, &demand) < 0) {
+        goto cleanup;
+    }
+
+    /* a basic solution has at most nr + nc - 1 nonzero flows */
+    npy_intp dim[1] = { dim_num_rows + dim_num_cols };
+    a = PyArray_SimpleNew(1, dim, NPY_INT64);
+    if (!a)
+        goto cleanup;
+
+    b = PyArray_SimpleNew(1, dim, NPY_INT64);
+    if (!b)
+        goto cleanup;
+
+    f = PyArray_SimpleNew(1, dim, NPY_DOUBLE);
+    if (!f)
+        goto cleanup;
+
+    int64_t* a_data = PyArray_DATA((PyArrayObject*)a);
+    int64_t* b_data = PyArray_DATA((PyArrayObject*)b);
+    double* f_data = PyArray_DATA((PyArrayObject*)f);
+    intptr_t n_flow = 0;
+    double total = 0;
+    int ret;
+    NPY_BEGIN_ALLOW_THREADS
+    ret = transport_dtype(
+      num_rows, num_cols, cost_matrix, dtype, maximize, supply, demand,
+      subrows, n_subrows, subcols, n_subcols,
+      max_iter, a_data, b_data, f_data, &n_flow, &total);
+    NPY_END_ALLOW_THREADS
+
+    if (ret != 0) {
+        set_lsap_error(ret);
+        goto cleanup;
+    }
+
+    PyObject* a_head = PySequence_GetSlice(a, 0, n_flow);
+    PyObject* b_head = PySequence_GetSlice(b, 0, n_flow);
+    PyObject* f_head = PySequence_GetSlice(f, 0, n_flow);
+    if (a_head && b_head && f_head) {
+        result = Py_BuildValue("OOOd", a_head, b_head, f_head, total);
+    }
+    Py_XDECREF(a_head);
+    Py_XDECREF(b_head);
+    Py_XDECREF(f_head);
+
+cleanup:
+    Py_XDECREF((PyObject*)array_demand);
+    Py_XDECREF((PyObject*)array_supply);
+    Py_XDECREF((PyObject*)array_subcols);
+    Py_XDECREF((PyObject*)array_subrows);
+    Py_XDECREF((PyObject*)obj_cont);
+    Py_XDECREF(a);
+    Py_XDECREF(b);
+    Py_XDECREF(f);
+    return result;
+}
+
+static PyObject*
+multiscale_assignment(PyObject* self, PyObject* args, PyObject* kwargs)
+{
+    PyObject* a = NULL;
+    PyObject* b = NULL;
+    PyObject* result = NULL;
+    PyObject* obj_x = NULL;
+    PyObject* obj_y = NULL;
+    PyArrayObject* array_x = NULL;
+    PyArrayObject* array_y = NULL;
+    PyObject* obj_metric = Py_None;
+    intptr_t metric;
+    Py_ssize_t n_candidates = 16;
+    Py_ssize_t max_clusters = 1024;
+    Py_ssize_t n_threads = 1;
+    static const char *kwlist[] = { (const char*)"x",
+                                    (const char*)"y",
+                                    (const char*)"metric",
+                                    (const char*)"n_candidates",
+                                    (const char*)"max_clusters",
+                                    (const char*)"n_threads",
+                                    NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|Onnn", (char**)kwlist,
+                                     &obj_x, &obj_y, &obj_metric, &n_candidates,
+                                     &max_clusters, &n_threads)) {
+        return NULL;
+    }
+    if (as_metric(obj_metric, &metric) < 0) {
+        return NULL;
+    }
+    if (n_candidates < 1) {
+        PyErr_SetString(PyExc_ValueError, "n_candidates must be positive");
+        return NULL;
+    }
+    if (max_clusters < 1) {
+        PyErr_SetString(PyExc_ValueError, "max_clusters must be positive");
+        return NULL;
+    }
+    if (n_threads < 1) {
+        PyErr_SetString(PyExc_ValueError, "n_threads must be positive");
+        return NULL;
+    }
+
+    array_x = as_points_array(obj_x, "x");
+    if (!array_x) {
+        goto cleanup;
+    }
+    array_y = as_points_array(obj_y, "y");
+    if (!array_y) {
+        goto cleanup;
+    }
+    npy_intp dim_points = PyArray_DIM(array_x, 1);
+    if (PyArray_DIM(array_y, 1) != dim_points) {
+        PyErr_SetString(PyExc_ValueError,
+                        "x and y must have the same number of coordinates");
+        goto cleanup;
+    }
+
+    npy_intp num_x = PyArray_DIM(array_x, 0);
+    npy_intp num_y = PyArray_DIM(array_y, 0);
+    npy_intp dim[1] = { num_x < num_y ? num_x : num_y };
+    a = PyArray_SimpleNew(1, dim, NPY_INT64);
+    if (!a)
+        goto cleanup;
+
+    b = PyArray_SimpleNew(1, dim, NPY_INT64);
+    if (!b)
+        goto cleanup;
+
+    int64_t* a_data = PyArray_DATA((PyArrayObject*)a);
+    int64_t* b_data = PyArray_DATA((PyArrayObject*)b);
+    const double* x_data = PyArray_DATA(array_x);
+    const double* y_data = PyArray_DATA(array_y);
+    int ret;
+    NPY_BEGIN_ALLOW_THREADS
+    ret = multiscale_rectangular_linear_sum_assignment(
+      num_x, num_y, dim_points, x_data, y_data,
+      metric, n_candidates, max_clusters, n_threads, a_data, b_data);
+    NPY_END_ALLOW_THREADS
+
+    if (ret != 0) {
+        set_lsap_error(ret);
+        goto cleanup;
+    }
+
+    result = Py_BuildValue("OO", a, b);
+
+cleanup:
+    Py_XDECREF((PyObject*)array_x);
+    Py_XDECREF((PyObject*)array_y);
+    Py_XDECREF(a);
+    Py_XDECREF(b);
+    return result;
+}
+
 static PyObject*
-linear_sum_assignment(PyObject* self, PyObject* args, PyObject* kwargs)
+axial_assignment(PyObject* self, PyObject* args, PyObject* kwargs)
 {
     PyObject* a = NULL;
     PyObject* b = NULL;
+    PyObject* c = NULL;
+    PyObject* bounds = NULL;
     PyObject* result = NULL;
     PyObject* obj_cost = NULL;
     PyArrayObject* obj_cont = NULL;
     int maximize = 0;
-    PyObject* obj_subrows = Py_None;
-    PyObject* obj_subcols = Py_None;
-    PyArrayObject* array_subrows = NULL;
-    PyArrayObject* array_subcols = NULL;
-    intptr_t *subrows = NULL;
-    intptr_t n_subrows = 0;
-    intptr_t *subcols = NULL;
-    intptr_t n_subcols = 0;
-    static const char *kwlist[] = { (const char*)"cost_matrix",
+    Py_ssize_t max_iter = 100;
+    Py_ssize_t n_threads = 1;
+    intptr_t dtype;
+    static const char *kwlist[] = { (const char*)"cost_tensor",
                                     (const char*)"maximize",
-                                    (const char*)"subrows",
-                                    (const char*)"subcols",
+                                    (const char*)"max_iter",
+                                    (const char*)"n_threads",
                                     NULL};
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|pOO", (char**)kwlist,
-                                     &obj_cost, &maximize, &obj_subrows, &obj_subcols)) {
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|pnn", (char**)kwlist,
+                                     &obj_cost, &maximize, &max_iter, &n_threads)) {
         return NULL;
     }
-
-    intptr_t npy_typ = NPY_DOUBLE;
-    intptr_t dtype = LSAP_DOUBLE;
-    if (PyArray_Check(obj_cost)) {
-        intptr_t tmp_npy_typ = PyArray_TYPE((PyArrayObject*)obj_cost);
-        intptr_t tmp_dtype = convert_npy_typ_to_lsap_typ(tmp_npy_typ);
-        if (tmp_dtype != LSAP_INVALID) {
-            npy_typ = tmp_npy_typ;
-            dtype = tmp_dtype;
-        }
-    }
-
-    obj_cont = (PyArrayObject*)PyArray_ContiguousFromAny(obj_cost, npy_typ, 0, 0);
-    if (!obj_cont) {
+    if (max_iter < 1) {
+        PyErr_SetString(PyExc_ValueError, "max_iter must be positive");
         return NULL;
     }
-
-    if (PyArray_NDIM(obj_cont) != 2) {
-        PyErr_Format(PyExc_ValueError,
-                     "expected a matrix (2-D array), got a %d array",
-                     PyArray_NDIM(obj_cont));
-        goto cleanup;
-    }
-
-    void* cost_matrix = PyArray_DATA(obj_cont);
-    if (cost_matrix == NULL) {
-        PyErr_SetString(PyExc_TypeError, "invalid cost matrix object");
-        goto cleanup;
+    if (n_threads < 1) {
+        PyErr_SetString(PyExc_ValueError, "n_threads must be positive");
+        return NULL;
     }
 
-    if (obj_subrows != Py_None) {
-        array_subrows = (PyArrayObject*)PyArray_ContiguousFromAny(obj_subrows, NPY_INTP, 0, 0);
-        if (!array_subrows) {
-            return NULL;
-        }
-        if (PyArray_NDIM(array_subrows) != 1) {
-            PyErr_Format(PyExc_ValueError,
-                        "subrows expected a 1-D array, got a %d array",
-                        PyArray_NDIM(array_subrows));
-            goto cleanup;
-        }
-        subrows = (intptr_t *)PyArray_DATA(array_subrows);
-        if (subrows == NULL) {
-            PyErr_SetString(PyExc_TypeError, "invalid subrows array object");
-            goto cleanup;
-        }
-        n_subrows = PyArray_DIM(array_subrows, 0);
-    }
-    if (obj_subcols != Py_None) {
-        array_subcols = (PyArrayObject*)PyArray_ContiguousFromAny(obj_subcols, NPY_INTP, 0, 0);
-        if (!array_subcols) {
-            return NULL;
-        }
-        if (PyArray_NDIM(array_subcols) != 1) {
-            PyErr_Format(PyExc_ValueError,
-                        "subcols expected a 1-D array, got a %d array",
-                        PyArray_NDIM(array_subcols));
-            goto cleanup;
-        }
-        subcols = (intptr_t *)PyArray_DATA(array_subcols);
-        if (subcols == NULL) {
-            PyErr_SetString(PyExc_TypeError, "invalid subcols array object");
-            goto cleanup;
-        }
-        n_subcols = PyArray_DIM(array_subcols, 0);
+    obj_cont = as_cost_array_nd(self, obj_cost, 3, -1, NULL, &dtype);
+    if (!obj_cont) {
+        return NULL;
     }
+    void* cost_tensor = PyArray_DATA(obj_cont);
 
-    npy_intp num_rows = PyArray_DIM(obj_cont, 0);
-    npy_intp num_cols = PyArray_DIM(obj_cont, 1);
-    npy_intp dim_num_rows = n_subrows ? n_subrows : num_rows;
-    npy_intp dim_num_cols = n_subcols ? n_subcols : num_cols;
-    npy_intp dim[1] = { dim_num_rows < dim_num_cols ? dim_num_rows : dim_num_cols };
+    npy_intp n1 = PyArray_DIM(obj_cont, 0);
+    npy_intp n2 = PyArray_DIM(obj_cont, 1);
+    npy_intp n3 = PyArray_DIM(obj_cont, 2);
+    npy_intp n = n1 < n2 ? n1 : n2;
+    npy_intp dim[1] = { n < n3 ? n : n3 };
     a = PyArray_SimpleNew(1, dim, NPY_INT64);
     if (!a)
         goto cleanup;
@@ -175,44 +1388,44 @@ linear_sum_assignment(PyObject* self, PyObject* args, PyObject* kwargs)
     if (!b)
         goto cleanup;
 
+    c = PyArray_SimpleNew(1, dim, NPY_INT64);
+    if (!c)
+        goto cleanup;
+
+    npy_intp dim_bounds[2] = { max_iter, 2 };
+    bounds = PyArray_SimpleNew(2, dim_bounds, NPY_DOUBLE);
+    if (!bounds)
+        goto cleanup;
+
     int64_t* a_data = PyArray_DATA((PyArrayObject*)a);
     int64_t* b_data = PyArray_DATA((PyArrayObject*)b);
+    int64_t* c_data = PyArray_DATA((PyArrayObject*)c);
+    double* bounds_data = PyArray_DATA((PyArrayObject*)bounds);
+    intptr_t n_iter = 0;
     int ret;
     NPY_BEGIN_ALLOW_THREADS
-    ret = solve_rectangular_linear_sum_assignment_dtype(
-      num_rows, num_cols, cost_matrix, dtype, maximize,
-      subrows, n_subrows, subcols, n_subcols,
-      a_data, b_data);
+    ret = axial_assignment_dtype(
+      n1, n2, n3, cost_tensor, dtype, maximize, max_iter, n_threads,
+      a_data, b_data, c_data, bounds_data, &n_iter);
     NPY_END_ALLOW_THREADS
 
-    if (ret == RECTANGULAR_LSAP_INFEASIBLE) {
-        PyErr_SetString(PyExc_ValueError, "cost matrix is infeasible");
-        goto cleanup;
-    }
-    else if (ret == RECTANGULAR_LSAP_INVALID) {
-        PyErr_SetString(PyExc_ValueError,
-                        "matrix contains invalid numeric entries");
-        goto cleanup;
-    }
-    else if (ret == RECTANGULAR_LSAP_SUBSCRIPT_INVALID) {
-        PyErr_SetString(PyExc_ValueError,
-                        "subrows or subcols is invalid");
-        goto cleanup;
-    }
-    else if (ret == RECTANGULAR_LSAP_DTYPE_INVALID) {
-        PyErr_SetString(PyExc_ValueError,
-                        "dtype is invalid");
+    if (ret != 0) {
+        set_lsap_error(ret);
         goto cleanup;
     }
 
-    result = Py_BuildValue("OO", a, b);
+    PyObject* bounds_head = PySequence_GetSlice(bounds, 0, n_iter);
+    if (bounds_head) {
+        result = Py_BuildValue("OOOO", a, b, c, bounds_head);
+    }
+    Py_XDECREF(bounds_head);
 
 cleanup:
-    Py_XDECREF((PyObject*)array_subcols);
-    Py_XDECREF((PyObject*)array_subrows);
     Py_XDECREF((PyObject*)obj_cont);
     Py_XDECREF(a);
     Py_XDECREF(b);
+    Py_XDECREF(c);
+    Py_XDECREF(bounds);
     return result;
 }
 
@@ -236,6 +1449,77 @@ static PyMethodDef lsap_methods[] = {
 "subcols : array (default: None)\n"
 "    Use sub cols from cost matrix if not None.\n"
 "\n"
+"k : int (default: None)\n"
+"    Only assign the k cheapest disjoint pairs if not None. The remaining\n"
+"    rows and columns stay unassigned. Must not exceed min(nr, nc).\n"
+"\n"
+"objective : str (default: 'sum')\n"
+"    'sum' minimizes the sum of the assigned entries. 'bottleneck'\n"
+"    minimizes the largest assigned entry (maximizes the smallest one if\n"
+"    maximize). 'bottleneck_sum' minimizes the sum among the assignments\n"
+"    that are optimal for 'bottleneck'.\n"
+"\n"
+"method : str (default: 'exact')\n"
+"    'exact' runs the shortest augmenting path solver. 'sinkhorn' computes\n"
+"    an approximate assignment by entropic regularization. 'greedy' matches\n"
+"    the cheapest entries of every row and improves the matching by local\n"
+"    search, for hard latency budgets. The approximations only work with\n"
+"    the 'sum' objective and without k. 'auto' picks an exact engine from\n"
+"    the shape, dtype and sampled density of finite entries, see\n"
+"    return_stats.\n"
+"\n"
+"epsilon : float (default: 3e-3)\n"
+"    'sinkhorn' only. Final regularization relative to the range of the\n"
+"    finite costs. Smaller is more accurate and takes more iterations.\n"
+"\n"
+"max_iter : int (default: 1000)\n"
+"    'sinkhorn': limit of scaling iterations over all stages. 'greedy':\n"
+"    limit of local search passes.\n"
+"\n"
+"repair : bool (default: False)\n"
+"    'sinkhorn' only. Make the rounded assignment optimal with the exact\n"
+"    solver, warm started from the Sinkhorn potentials.\n"
+"\n"
+"n_threads : int (default: 1)\n"
+"    'sinkhorn' and 'greedy' only. Number of threads of the passes over the\n"
+"    cost matrix.\n"
+"\n"
+"return_bound : bool (default: False)\n"
+"    'greedy' only. Also return the cost of the assignment and a dual bound\n"
+"    on the optimal cost, so the optimality gap is known.\n"
+"\n"
+"row_order : str (default: 'index')\n"
+"    'exact' only. The order in which rows are augmented: 'index',\n"
+"    'random' (a fixed shuffle), 'regret' (largest gap between the\n"
+"    cheapest and second cheapest entry first) or 'min_cost' (cheapest\n"
+"    entry first). Does not change the cost of the result, only the work\n"
+"    to reach it.\n"
+"\n"
+"return_stats : bool (default: False)\n"
+"    Also return a dict describing the solve: 'engine' that ran, the\n"
+"    'reason' it was chosen, and the sampled 'density' of finite entries\n"
+"    (nan if not sampled). The exact engine on a full assignment also\n"
+"    reports 'validation_seconds', 'setup_seconds', 'augment_seconds',\n"
+"    the number of 'augmentations', 'columns_scanned', 'dual_updates'\n"
+"    and 'tie_breaks', 'path_length_mean' and 'path_length_max' in rows,\n"
+"    and the solver 'workspace_bytes'. They are zero for other engines,\n"
+"    except 'workspace_bytes' of the exact engines.\n"
+"\n"
+"trace : int (default: 0)\n"
+"    With return_stats and the exact engine on a full assignment, keep the\n"
+"    last trace augmentations in stats['trace'], oldest first. It is a\n"
+"    structured array with the 'row' assigned (a column if nr > nc),\n"
+"    'path_length', 'columns_scanned', 'start' and 'duration' in seconds\n"
+"    from the start of the solve, and 'path_cost'. See\n"
+"    nanolsap.trace_to_chrome.\n"
+"\n"
+"memory_limit : int (default: None)\n"
+"    Bytes the call may allocate beyond the cost matrix, for the copy of\n"
+"    the cost matrix, the solver workspace, the result and the trace, see\n"
+"    estimate_memory. MemoryError is raised before allocating what does\n"
+"    not fit; 'auto' first falls back from the sparse to the dense exact\n"
+"    engine. None for no limit.\n"
+"\n"
 "Returns\n"
 "-------\n"
 "row_ind, col_ind : array\n"
@@ -245,6 +1529,14 @@ static PyMethodDef lsap_methods[] = {
 "    sorted; in the case of a square cost matrix they will be equal to\n"
 "    ``numpy.arange(cost_matrix.shape[0])``.\n"
 "\n"
+"cost, bound : float\n"
+"    Only with return_bound. The cost of the assignment and a bound on the\n"
+"    optimal cost, from below when minimizing and from above when\n"
+"    maximizing.\n"
+"\n"
+"stats : dict\n"
+"    Only with return_stats, always last.\n"
+"\n"
 "See Also\n"
 "--------\n"
 "scipy.sparse.csgraph.min_weight_full_bipartite_matching : for sparse inputs\n"
@@ -296,24 +1588,433 @@ static PyMethodDef lsap_methods[] = {
 "array([1, 0, 2])\n"
 ">>> cost[row_ind, col_ind].sum()\n"
 "5\n"},
+    { "estimate_memory",
+      (PyCFunction)estimate_memory,
+      METH_VARARGS | METH_KEYWORDS,
+"Memory a linear_sum_assignment call would take, without solving.\n"
+"\n"
+"Parameters\n"
+"----------\n"
+"cost_matrix, maximize, subrows, subcols, k, objective, method, repair,\n"
+"n_threads, row_order, trace\n"
+"    As for ``linear_sum_assignment``.\n"
+"\n"
+"Returns\n"
+"-------\n"
+"estimate : dict\n"
+"    The 'engine' that would run and the sampled 'density' of finite\n"
+"    entries (nan if not sampled), with the bytes beyond the cost matrix:\n"
+"    'copy_bytes' of the contiguous copy of the cost matrix (zero when it\n"
+"    is read in place), 'workspace_bytes' of the solver arrays at their\n"
+"    peak, 'output_bytes' of the result, 'trace_bytes' of the trace\n"
+"    buffer, and their sum 'total_bytes', the smallest memory_limit the\n"
+"    call succeeds with.\n"
+"\n"
+"Notes\n"
+"-----\n"
+"The workspace is exact for the dense engines. For 'exact_sparse' it\n"
+"follows from the sampled density, so the actual one may differ by the\n"
+"sampling error. Allocator overhead is not counted. Only the subscripts\n"
+"are validated, not the entries of the cost matrix. The dual bound of\n"
+"return_bound is not counted.\n"},
+    { "verify_assignment",
+      (PyCFunction)verify_assignment,
+      METH_VARARGS | METH_KEYWORDS,
+"Check an assignment and bound how far it is from optimal.\n"
+"\n"
+"Parameters\n"
+"----------\n"
+"cost_matrix : array\n"
+"    The cost matrix of the bipartite graph.\n"
+"\n"
+"row_ind, col_ind : array\n"
+"    The assignment, in the format of ``linear_sum_assignment``.\n"
+"\n"
+"u, v : array (default: None)\n"
+"    Optional dual variables of the rows and columns (of subrows and\n"
+"    subcols if given), with u[i] + v[j] <= cost_matrix[i, j] (>= if\n"
+"    maximize). Both or neither.\n"
+"\n"
+"maximize : bool (default: False)\n"
+"    Whether the assignment maximizes the weight.\n"
+"\n"
+"subrows, subcols : array (default: None)\n"
+"    As for ``linear_sum_assignment``.\n"
+"\n"
+"tol : float (default: 1e-9)\n"
+"    Gap, relative to the cost, up to which the assignment is optimal.\n"
+"\n"
+"n_threads : int (default: 1)\n"
+"    Number of threads scanning the cost matrix.\n"
+"\n"
+"Returns\n"
+"-------\n"
+"certificate : dict\n"
+"    'valid' if the pairs are min(nr, nc) distinct rows and columns with\n"
+"    finite entries, their 'cost', a 'bound' on the optimal cost, from\n"
+"    below when minimizing and from above when maximizing, the 'gap'\n"
+"    between them (nan if not valid) and whether it shows the assignment\n"
+"    'proven_optimal'. 'max_violation' is the largest violation of dual\n"
+"    feasibility by u and v, and 'max_slack' of complementary slackness,\n"
+"    the largest reduced cost of an assigned pair or dual of a free\n"
+"    column. Both are zero without duals.\n"
+"\n"
+"Notes\n"
+"-----\n"
+"The bound is the dual objective of u and v made feasible: v is clamped\n"
+"to be non-positive when nr < nc and u[i] is the row minimum of the\n"
+"reduced costs. Without duals it is that of the row minima and, for\n"
+"square views, the column minima. That bound is seldom tight, so without\n"
+"duals 'proven_optimal' is usually False even for an optimal assignment,\n"
+"and always False for a rectangular one unless every row gets its\n"
+"cheapest column. The cost matrix is read in place for all dtypes in one\n"
+"pass over the rows, two without duals.\n"},
+    { "get_tuning",
+      (PyCFunction)get_tuning,
+      METH_NOARGS,
+"The machine dependent thresholds in use, see set_tuning.\n"
+"\n"
+"Returns\n"
+"-------\n"
+"tuning : dict\n"
+"    'sparse_density' and 'entries_per_thread'.\n"},
+    { "set_tuning",
+      (PyCFunction)set_tuning,
+      METH_VARARGS | METH_KEYWORDS,
+"Set the machine dependent thresholds of the solvers for the process.\n"
+"\n"
+"Parameters\n"
+"----------\n"
+"sparse_density : float (default: None)\n"
+"    method='auto' runs the sparse exact engine on views whose sampled\n"
+"    density of finite entries is at most sparse_density.\n"
+"\n"
+"entries_per_thread : int (default: None)\n"
+"    'sinkhorn' and 'greedy' start one thread per entries_per_thread\n"
+"    entries of the view, up to n_threads.\n"
+"\n"
+"defaults : bool (default: False)\n"
+"    Start from the built-in values instead of the current ones.\n"
+"\n"
+"Notes\n"
+"-----\n"
+"Values left None are kept. nanolsap.autotune measures both on the\n"
+"current machine. The cost of the results does not depend on them, only\n"
+"the time to reach them.\n"},
+    { "k_best_assignments",
+      (PyCFunction)k_best_assignments,
+      METH_VARARGS | METH_KEYWORDS,
+"Find the k best solutions of the linear sum assignment problem.\n"
+"\n"
+"Parameters\n"
+"----------\n"
+"cost_matrix : array\n"
+"    The cost matrix of the bipartite graph.\n"
+"\n"
+"k : int\n"
+"    Number of assignments to return.\n"
+"\n"
+"maximize : bool (default: False)\n"
+"    Rank by decreasing weight if true.\n"
+"\n"
+"subrows : array (default: None)\n"
+"    Use sub rows from cost matrix if not None.\n"
+"\n"
+"subcols : array (default: None)\n"
+"    Use sub cols from cost matrix if not None.\n"
+"\n"
+"n_threads : int (default: 1)\n"
+"    Number of threads solving the child subproblems of a partition.\n"
+"\n"
+"Returns\n"
+"-------\n"
+"row_ind, col_ind : array\n"
+"    Arrays of shape (m, min(nr, nc)). Row t holds the t-th best assignment\n"
+"    in the same format as ``linear_sum_assignment``. m is smaller than k if\n"
+"    fewer than k assignments exist.\n"
+"\n"
+"costs : array\n"
+"    The m assignment costs, non-decreasing (non-increasing if maximize).\n"
+"\n"
+"Notes\n"
+"-----\n"
+"Uses Murty's partitioning. Each child subproblem reuses the assignment\n"
+"and dual variables of its parent and is solved by a single shortest\n"
+"augmenting path. Forced and forbidden entries are applied as a view on\n"
+"the cost matrix, which is never copied.\n"},
+    { "transport",
+      (PyCFunction)transport,
+      METH_VARARGS | METH_KEYWORDS,
+"Solve the transportation problem (earth mover's distance).\n"
+"\n"
+"Parameters\n"
+"----------\n"
+"cost_matrix : array\n"
+"    The cost of moving a unit of mass from row i to column j.\n"
+"\n"
+"supply : array\n"
+"    Non-negative mass of each row.\n"
+"\n"
+"demand : array\n"
+"    Non-negative mass of each column.\n"
+"\n"
+"maximize : bool (default: False)\n"
+"    Calculates a maximum weight transport if true.\n"
+"\n"
+"subrows : array (default: None)\n"
+"    Use sub rows from cost matrix if not None. supply is indexed like\n"
+"    subrows.\n"
+"\n"
+"subcols : array (default: None)\n"
+"    Use sub cols from cost matrix if not None. demand is indexed like\n"
+"    subcols.\n"
+"\n"
+"max_iter : int (default: None)\n"
+"    Raise RuntimeError after this many simplex pivots if not None.\n"
+"\n"
+"Returns\n"
+"-------\n"
+"row_ind, col_ind, flow : array\n"
+"    The nonzero entries of the optimal flow, sorted by row and column.\n"
+"    There are at most nr + nc - 1 of them.\n"
+"\n"
+"cost : float\n"
+"    ``(cost_matrix[row_ind, col_ind] * flow).sum()``.\n"
+"\n"
+"Notes\n"
+"-----\n"
+"If the total supply and demand differ, only the smaller total is moved.\n"
+"Infinite entries can not carry flow; ValueError is raised if the masses\n"
+"can not be moved otherwise.\n"
+"\n"
+"This implementation is a primal network simplex on the spanning tree\n"
+"of the bipartite graph, with block pricing of the entering arc and a\n"
+"strongly feasible tree to prevent cycling. The cost matrix is read in\n"
+"place for all dtypes.\n"},
+    { "multiscale_assignment",
+      (PyCFunction)multiscale_assignment,
+      METH_VARARGS | METH_KEYWORDS,
+"Solve the linear sum assignment problem between two point sets.\n"
+"\n"
+"Parameters\n"
+"----------\n"
+"x : array\n"
+"    The (nx, dim) points of the rows.\n"
+"\n"
+"y : array\n"
+"    The (ny, dim) points of the columns.\n"
+"\n"
+"metric : str (default: 'euclidean')\n"
+"    The cost of a pair, 'euclidean' or 'sqeuclidean' distance.\n"
+"\n"
+"n_candidates : int (default: 16)\n"
+"    Number of candidate columns of lowest reduced cost per row and per\n"
+"    cluster, and of columns added per row when the candidates miss the\n"
+"    optimum.\n"
+"\n"
+"max_clusters : int (default: 1024)\n"
+"    Largest number of clusters per point set at the coarsest level.\n"
+"\n"
+"n_threads : int (default: 1)\n"
+"    Number of threads building the candidate lists and checking the\n"
+"    reduced costs.\n"
+"\n"
+"Returns\n"
+"-------\n"
+"row_ind, col_ind : array\n"
+"    Indices into x and y of the assigned pairs, in the format of\n"
+"    ``linear_sum_assignment``.\n"
+"\n"
+"Notes\n"
+"-----\n"
+"Both point sets are clustered by a k-d tree at several depths, and the\n"
+"cluster centroids are matched by transportation problems with the\n"
+"cluster sizes as masses, from the coarsest level to the finest. Every\n"
+"level starts from the potentials of the coarser one and only considers\n"
+"the children of the clusters linked by its flow and the clusters of\n"
+"lowest reduced cost. A sparse shortest augmenting path solver then\n"
+"matches the points on the same kind of candidates.\n"
+"The result is optimal: every pair of the two sets is checked against\n"
+"the final dual variables with a k-d tree, and the pairs of negative\n"
+"reduced cost are added to the candidates until there are none.\n"
+"The cost matrix is never formed.\n"},
+    { "axial_assignment",
+      (PyCFunction)axial_assignment,
+      METH_VARARGS | METH_KEYWORDS,
+"Solve the axial 3-D assignment problem approximately.\n"
+"\n"
+"Parameters\n"
+"----------\n"
+"cost_tensor : array\n"
+"    The (n1, n2, n3) cost of every triple.\n"
+"\n"
+"maximize : bool (default: False)\n"
+"    Calculates a maximum weight assignment if true.\n"
+"\n"
+"max_iter : int (default: 100)\n"
+"    Limit of Lagrangian iterations, each one or two 2-D assignments.\n"
+"\n"
+"n_threads : int (default: 1)\n"
+"    Number of threads evaluating the relaxed 2-D costs.\n"
+"\n"
+"Returns\n"
+"-------\n"
+"i_ind, j_ind, k_ind : array\n"
+"    The min(n1, n2, n3) assigned triples, sorted by i_ind. Every index\n"
+"    occurs at most once per axis.\n"
+"\n"
+"bounds : array\n"
+"    Shape (n_iter, 2), the best primal cost and the best dual bound after\n"
+"    every iteration. The dual bound is from below when minimizing and\n"
+"    from above when maximizing, so the last row bounds the optimality\n"
+"    gap of the result.\n"
+"\n"
+"Notes\n"
+"-----\n"
+"The axial 3-D assignment problem is NP-hard. The constraints of the\n"
+"largest axis are relaxed with Lagrange multipliers, which leaves a 2-D\n"
+"assignment problem on the cheapest k of every (i, j) pair. The\n"
+"multipliers follow subgradient steps, every 2-D solve is warm started\n"
+"from the previous one, and a feasible assignment is recovered from\n"
+"every relaxed solution by assigning its pairs to the third axis. The\n"
+"iterations stop early when the bounds meet.\n"
+"The cost tensor is read in place for all dtypes.\n"},
     { NULL, NULL, 0, NULL }
 };
 
+/* C entry points for compiled callers, exported the way Cython exports
+   cdef functions: __pyx_capi__ maps each name to a PyCapsule of the
+   function pointer, named by its C signature.  numba.extending.
+   get_cython_function_address and Cython's cimport read them, so jitted
+   loops call the solver without creating Python objects. */
+struct capi_function {
+    const char* name;
+    void* pointer;
+    const char* signature;
+};
+
+static const struct capi_function capi_functions[] = {
+    {"lsap_solve_dtype", (void*)lsap_solve_dtype,
+     "int (intptr_t, intptr_t, void *, intptr_t, bool, intptr_t const *, intptr_t, "
+     "intptr_t const *, intptr_t, intptr_t, intptr_t, struct lsap_options const *, "
+     "int64_t *, int64_t *)"},
+    {"solve_rectangular_linear_sum_assignment_dtype",
+     (void*)solve_rectangular_linear_sum_assignment_dtype,
+     "int (intptr_t, intptr_t, void *, intptr_t, bool, intptr_t const *, intptr_t, "
+     "intptr_t const *, intptr_t, int64_t *, int64_t *)"},
+    {"lsap_options_init", (void*)lsap_options_init, "void (struct lsap_options *)"},
+    {"lsap_abi_version", (void*)lsap_abi_version, "int (void)"},
+    {"lsap_solver_create", (void*)lsap_solver_create, "struct lsap_solver *(intptr_t)"},
+    {"lsap_solver_destroy", (void*)lsap_solver_destroy, "void (struct lsap_solver *)"},
+    {"lsap_solver_solve", (void*)lsap_solver_solve,
+     "int (struct lsap_solver *, struct lsap_matrix const *, bool, intptr_t const *, "
+     "intptr_t, intptr_t const *, intptr_t, intptr_t, intptr_t, "
+     "struct lsap_options const *, int64_t *, int64_t *)"},
+    {"lsap_solver_stats", (void*)lsap_solver_stats,
+     "int (struct lsap_solver const *, struct lsap_stats *)"},
+    {"lsap_solver_duals", (void*)lsap_solver_duals,
+     "int (struct lsap_solver const *, double *, double *)"},
+    {"lsap_solver_workspace_bytes", (void*)lsap_solver_workspace_bytes,
+     "intptr_t (struct lsap_solver const *)"},
+    { NULL, NULL, NULL }
+};
+
+static PyObject*
+capi_table(void)
+{
+    PyObject* table = PyDict_New();
+    if (table == NULL) {
+        return NULL;
+    }
+    for (const struct capi_function* f = capi_functions; f->name != NULL; f++) {
+        PyObject* capsule = PyCapsule_New(f->pointer, f->signature, NULL);
+        if (capsule == NULL || PyDict_SetItemString(table, f->name, capsule) < 0) {
+            Py_XDECREF(capsule);
+            Py_DECREF(table);
+            return NULL;
+        }
+        Py_DECREF(capsule);
+    }
+    return table;
+}
+
+static int
+lsap_exec(PyObject* module)
+{
+    import_array1(-1);
+    struct lsap_module_state* state = get_module_state(module);
+    PyObject* numpy = PyImport_ImportModule("numpy");
+    if (numpy == NULL) {
+        return -1;
+    }
+    state->from_dlpack = PyObject_GetAttrString(numpy, "from_dlpack");
+    Py_DECREF(numpy);
+    if (state->from_dlpack == NULL) {
+        PyErr_Clear();
+    }
+    PyObject* table = capi_table();
+    if (table == NULL || PyModule_AddObject(module, "__pyx_capi__", table) < 0) {
+        Py_XDECREF(table);
+        return -1;
+    }
+    return 0;
+}
+
+static int
+lsap_traverse(PyObject* module, visitproc visit, void* arg)
+{
+    struct lsap_module_state* state = get_module_state(module);
+    if (state != NULL) {
+        Py_VISIT(state->from_dlpack);
+    }
+    return 0;
+}
+
+static int
+lsap_clear(PyObject* module)
+{
+    struct lsap_module_state* state = get_module_state(module);
+    if (state != NULL) {
+        Py_CLEAR(state->from_dlpack);
+    }
+    return 0;
+}
+
+static void
+lsap_free(void* module)
+{
+    lsap_clear((PyObject*)module);
+}
+
+/* The solvers share no state between calls and run without the GIL, the
+   tuned thresholds are atomics, so free-threaded builds need no GIL for
+   this module.  numpy's C API table is per process, so subinterpreters
+   must share the main GIL. */
+static PyModuleDef_Slot lsap_slots[] = {
+    {Py_mod_exec, (void*)lsap_exec},
+#ifdef Py_mod_multiple_interpreters
+    {Py_mod_multiple_interpreters, Py_MOD_MULTIPLE_INTERPRETERS_SUPPORTED},
+#endif
+#ifdef Py_mod_gil
+    {Py_mod_gil, Py_MOD_GIL_NOT_USED},
+#endif
+    {0, NULL}
+};
+
 static struct PyModuleDef moduledef = {
     PyModuleDef_HEAD_INIT,
     "_lsap",
     "Solves the rectangular linear sum assignment.",
-    -1,
+    sizeof(struct lsap_module_state),
     lsap_methods,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
+    lsap_slots,
+    lsap_traverse,
+    lsap_clear,
+    lsap_free,
 };
 
 PyMODINIT_FUNC
 PyInit__lsap(void)
 {
-    import_array();
-    return PyModule_Create(&moduledef);
+    return PyModuleDef_Init(&moduledef);
 }
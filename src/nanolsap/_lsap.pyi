@@ -1,12 +1,117 @@
-from typing import Any, Optional, Tuple
+from typing import Any, Dict, Optional, Tuple, Union
 
 import numpy.typing as npt
 
+__pyx_capi__: Dict[str, Any]
+
 
 def linear_sum_assignment(
     cost_matrix: npt.ArrayLike,
     maximize: bool = False,
     subrows: Optional[npt.ArrayLike] = None,
     subcols: Optional[npt.ArrayLike] = None,
+    k: Optional[int] = None,
+    objective: str = "sum",
+    method: str = "exact",
+    epsilon: Optional[float] = None,
+    max_iter: Optional[int] = None,
+    repair: bool = False,
+    n_threads: int = 1,
+    return_bound: bool = False,
+    row_order: str = "index",
+    return_stats: bool = False,
+    trace: int = 0,
+    memory_limit: Optional[int] = None,
+) -> Union[
+    Tuple[npt.NDArray[Any], npt.NDArray[Any]],
+    Tuple[npt.NDArray[Any], npt.NDArray[Any], float, float],
+    Tuple[npt.NDArray[Any], npt.NDArray[Any], Dict[str, Any]],
+    Tuple[npt.NDArray[Any], npt.NDArray[Any], float, float, Dict[str, Any]],
+]:
+    ...
+
+
+def estimate_memory(
+    cost_matrix: npt.ArrayLike,
+    maximize: bool = False,
+    subrows: Optional[npt.ArrayLike] = None,
+    subcols: Optional[npt.ArrayLike] = None,
+    k: Optional[int] = None,
+    objective: str = "sum",
+    method: str = "exact",
+    repair: bool = False,
+    n_threads: int = 1,
+    row_order: str = "index",
+    trace: int = 0,
+) -> Dict[str, Any]:
+    ...
+
+
+def verify_assignment(
+    cost_matrix: npt.ArrayLike,
+    row_ind: npt.ArrayLike,
+    col_ind: npt.ArrayLike,
+    u: Optional[npt.ArrayLike] = None,
+    v: Optional[npt.ArrayLike] = None,
+    maximize: bool = False,
+    subrows: Optional[npt.ArrayLike] = None,
+    subcols: Optional[npt.ArrayLike] = None,
+    tol: float = 1e-9,
+    n_threads: int = 1,
+) -> Dict[str, Any]:
+    ...
+
+
+def get_tuning() -> Dict[str, Any]:
+    ...
+
+
+def set_tuning(
+    sparse_density: Optional[float] = None,
+    entries_per_thread: Optional[int] = None,
+    defaults: bool = False,
+) -> None:
+    ...
+
+
+def k_best_assignments(
+    cost_matrix: npt.ArrayLike,
+    k: int,
+    maximize: bool = False,
+    subrows: Optional[npt.ArrayLike] = None,
+    subcols: Optional[npt.ArrayLike] = None,
+    n_threads: int = 1,
+) -> Tuple[npt.NDArray[Any], npt.NDArray[Any], npt.NDArray[Any]]:
+    ...
+
+
+def transport(
+    cost_matrix: npt.ArrayLike,
+    supply: npt.ArrayLike,
+    demand: npt.ArrayLike,
+    maximize: bool = False,
+    subrows: Optional[npt.ArrayLike] = None,
+    subcols: Optional[npt.ArrayLike] = None,
+    max_iter: Optional[int] = None,
+) -> Tuple[npt.NDArray[Any], npt.NDArray[Any], npt.NDArray[Any], float]:
+    ...
+
+
+def multiscale_assignment(
+    x: npt.ArrayLike,
+    y: npt.ArrayLike,
+    metric: str = "euclidean",
+    n_candidates: int = 16,
+    max_clusters: int = 1024,
+    n_threads: int = 1,
 ) -> Tuple[npt.NDArray[Any], npt.NDArray[Any]]:
     ...
+
+
+def axial_assignment(
+    cost_tensor: npt.ArrayLike,
+    maximize: bool = False,
+    max_iter: int = 100,
+    n_threads: int = 1,
+) -> Tuple[npt.NDArray[Any], npt.NDArray[Any], npt.NDArray[Any], npt.NDArray[Any]]:
+    ...
@@ -0,0 +1,118 @@
+"""Capture of linear_sum_assignment calls for offline replay.
+
+Set NANOLSAP_CAPTURE to a directory before importing nanolsap, and a
+sample of the calls is saved there, one .npz file per call:
+
+    NANOLSAP_CAPTURE=/tmp/lsap python service.py
+    python -m nanolsap.replay /tmp/lsap --set method=auto
+
+NANOLSAP_CAPTURE_RATE is the fraction of calls kept (default 1), and
+NANOLSAP_CAPTURE_MATRIX what is kept of the cost matrix: 'full', 'sample'
+(default, a hash of the matrix and an evenly spaced submatrix of at most
+SAMPLE_SIZE rows and columns) or 'none' (shape, dtype and arguments
+only). Without NANOLSAP_CAPTURE nothing is wrapped.
+"""
+
+import functools
+import hashlib
+import itertools
+import json
+import os
+import random
+import threading
+import time
+
+import numpy as np
+
+SAMPLE_SIZE = 256
+MATRIX_MODES = ("full", "sample", "none")
+_ARGUMENTS = ("cost_matrix", "maximize", "subrows", "subcols", "k", "objective", "method",
+              "epsilon", "max_iter", "repair", "n_threads", "return_bound", "row_order",
+              "return_stats", "trace", "memory_limit")
+
+
+def sample_indices(n, size=SAMPLE_SIZE):
+    """At most size evenly spaced indices of range(n)."""
+    return np.unique(np.linspace(0, n - 1, min(n, size)).astype(np.intp)) if n else np.arange(0)
+
+
+def matrix_hash(cost):
+    return hashlib.sha256(np.ascontiguousarray(cost).view(np.uint8).data).hexdigest()
+
+
+def capturing(func, directory, rate=1.0, matrix="sample"):
+    """Wrap func, a linear_sum_assignment, to save a fraction rate of its
+    calls to directory."""
+    if matrix not in MATRIX_MODES:
+        raise ValueError("matrix must be one of %s, got %r" % (MATRIX_MODES, matrix))
+    os.makedirs(directory, exist_ok=True)
+    counter = itertools.count()
+    rng = random.Random()
+    # the solves run concurrently on free-threaded builds, the draws not
+    lock = threading.Lock()
+
+    @functools.wraps(func)
+    def wrapper(*args, **kwargs):
+        with lock:
+            draw = rng.random()
+        if draw >= rate:
+            return func(*args, **kwargs)
+        start = time.perf_counter()
+        result = func(*args, **kwargs)
+        seconds = time.perf_counter() - start
+        try:
+            call = dict(zip(_ARGUMENTS, args))
+            call.update(kwargs)
+            with lock:
+                index = next(counter)
+            _save(os.path.join(directory, "call-%d-%d.npz" % (os.getpid(), index)),
+                  call, result, seconds, matrix)
+        except Exception:
+            # capture must never break the caller
+            pass
+        return result
+
+    return wrapper
+
+
+def from_environ(func):
+    """Wrap func as configured by the NANOLSAP_CAPTURE variables, or return
+    it unchanged if NANOLSAP_CAPTURE is not set."""
+    directory = os.environ.get("NANOLSAP_CAPTURE")
+    if not directory:
+        return func
+    return capturing(func, directory,
+                     rate=float(os.environ.get("NANOLSAP_CAPTURE_RATE", "1")),
+                     matrix=os.environ.get("NANOLSAP_CAPTURE_MATRIX", "sample"))
+
+
+def _save(filename, call, result, seconds, matrix):
+    cost = np.asarray(call.pop("cost_matrix"))
+    arrays = {}
+    for name in ("subrows", "subcols"):
+        if call.get(name) is not None:
+            arrays[name] = np.asarray(call.pop(name), dtype=np.intp)
+    row_ind, col_ind = result[0], result[1]
+    meta = {
+        "shape": list(cost.shape),
+        "dtype": cost.dtype.str,
+        "kwargs": call,
+        "seconds": seconds,
+        "matrix": matrix,
+        "cost": float(cost[row_ind, col_ind].sum()) if cost.ndim == 2 else None,
+    }
+    if matrix == "full":
+        arrays["cost_matrix"] = cost
+    elif matrix == "sample" and cost.ndim == 2:
+        meta["hash"] = matrix_hash(cost)
+        arrays["sample_rows"] = sample_indices(cost.shape[0])
+        arrays["sample_cols"] = sample_indices(cost.shape[1])
+        arrays["cost_matrix"] = cost[np.ix_(arrays["sample_rows"], arrays["sample_cols"])]
+    np.savez(filename, meta=np.array(json.dumps(meta, default=_jsonable)), **arrays)
+
+
+def _jsonable(value):
+    # numpy scalars among the arguments
+    if hasattr(value, "item"):
+        return value.item()
+    return str(value)
@@ -0,0 +1,71 @@
+import math
+import time
+
+import numpy as np
+
+from ._lsap import estimate_memory, linear_sum_assignment
+from .capture import sample_indices
+
+PROBE_SIZE = 256
+# arguments of linear_sum_assignment that do not change what is allocated
+_IGNORED = ("epsilon", "max_iter", "return_bound", "return_stats", "memory_limit")
+
+
+def estimate(cost_matrix, probe_size=PROBE_SIZE, **options):
+    """Predict the memory and time of linear_sum_assignment(cost_matrix,
+    **options) without solving it.
+
+    Returns the dict of estimate_memory, with 'seconds', a prediction of
+    the wall time, and 'exponent', the growth of the time with the size
+    fitted for the prediction. Views of at most probe_size rows and
+    columns are solved and timed instead, with a nan exponent. Larger ones
+    are predicted from the time of two evenly spaced submatrices of the
+    same aspect ratio, with probe_size // 2 and probe_size rows or columns,
+    as a power of the size with an exponent clamped to [1, 3]. 'seconds'
+    is nan if a submatrix is infeasible.
+    """
+    cost = np.asarray(cost_matrix)
+    memory = {name: value for name, value in options.items() if name not in _IGNORED}
+    result = estimate_memory(cost, **memory)
+
+    solve = {name: value for name, value in options.items()
+             if name not in ("subrows", "subcols", "return_stats", "memory_limit")}
+    rows = np.arange(cost.shape[0])
+    cols = np.arange(cost.shape[1])
+    if options.get("subrows") is not None:
+        rows = np.asarray(options["subrows"], dtype=np.intp)
+    if options.get("subcols") is not None:
+        cols = np.asarray(options["subcols"], dtype=np.intp)
+    size = max(len(rows), len(cols))
+    if size <= probe_size:
+        result["seconds"] = _time(cost[np.ix_(rows, cols)], solve)
+        result["exponent"] = math.nan
+        return result
+
+    sizes = (max(probe_size // 2, 1), probe_size)
+    seconds = []
+    for m in sizes:
+        sub = cost[np.ix_(rows[sample_indices(len(rows), max(1, len(rows) * m // size))],
+                          cols[sample_indices(len(cols), max(1, len(cols) * m // size))])]
+        probe = dict(solve)
+        if probe.get("k") is not None:
+            probe["k"] = max(1, min(sub.shape) * probe["k"] // min(len(rows), len(cols)))
+        seconds.append(_time(sub, probe))
+    exponent = math.log(max(seconds[1], 1e-9) / max(seconds[0], 1e-9)) / math.log(sizes[1] / sizes[0])
+    exponent = min(max(exponent, 1.0), 3.0)
+    result["seconds"] = seconds[1] * (size / sizes[1]) ** exponent
+    result["exponent"] = exponent
+    return result
+
+
+def _time(cost, options, repeat=3):
+    """Best wall time of solving cost, nan if infeasible."""
+    best = math.inf
+    for _ in range(repeat):
+        start = time.perf_counter()
+        try:
+            linear_sum_assignment(cost, **options)
+        except ValueError:
+            return math.nan
+        best = min(best, time.perf_counter() - start)
+    return best
@@ -0,0 +1,141 @@
+"""Calls of the solver from Numba jitted code, with array pointers and no
+Python object, through the C entry points nanolsap._lsap exports in its
+Cython style __pyx_capi__ table:
+
+    import numba
+    from nanolsap.numba_support import linear_sum_assignment
+
+    @numba.njit
+    def total_cost(costs):
+        total = 0.0
+        for cost in costs:
+            row_ind, col_ind = linear_sum_assignment(cost)
+            for t in range(len(row_ind)):
+                total += cost[row_ind[t], col_ind[t]]
+        return total
+
+The functions are jitted themselves, so they also work from Python. For
+loops over many matrices, create_solver returns a handle whose workspace
+solve_into reuses, reading the cost matrix in place whatever its strides.
+"""
+
+import ctypes
+
+import numba
+import numpy as np
+from numba.extending import get_cython_function_address, overload
+from numba.np.numpy_support import as_dtype
+
+# enum LSAP_TYPES by dtype.char
+_DTYPE_CHARS = "?bBhHiIlLqQfdg"
+LSAP_SOLVER_STATS = 1
+
+_ptr = ctypes.c_void_p
+_int = ctypes.c_ssize_t
+# handles are passed as integers
+_handle = ctypes.c_ssize_t
+
+
+def _function(name, restype, *argtypes):
+    address = get_cython_function_address("nanolsap._lsap", name)
+    return ctypes.CFUNCTYPE(restype, *argtypes)(address)
+
+
+_solve = _function("lsap_solve_dtype", ctypes.c_int,
+                   _int, _int, _ptr, _int, ctypes.c_bool, _ptr, _int, _ptr, _int,
+                   _int, _int, _ptr, _ptr, _ptr)
+_solver_create = _function("lsap_solver_create", _handle, _int)
+_solver_destroy = _function("lsap_solver_destroy", None, _handle)
+_solver_solve = _function("lsap_solver_solve", ctypes.c_int,
+                          _handle, _ptr, ctypes.c_bool, _ptr, _int, _ptr, _int,
+                          _int, _int, _ptr, _ptr, _ptr)
+_solver_duals = _function("lsap_solver_duals", ctypes.c_int, _handle, _ptr, _ptr)
+
+
+def _lsap_dtype(cost):
+    pass
+
+
+@overload(_lsap_dtype)
+def _lsap_dtype_overload(cost):
+    char = np.dtype(as_dtype(cost.dtype)).char
+    if char not in _DTYPE_CHARS:
+        return None
+    code = _DTYPE_CHARS.index(char)
+    return lambda cost: code
+
+
+@numba.njit
+def _check(ret):
+    # the messages of linear_sum_assignment
+    if ret == -1:
+        raise ValueError("cost matrix is infeasible")
+    if ret == -2:
+        raise ValueError("matrix contains invalid numeric entries")
+    if ret == -12:
+        raise ValueError("strides must be multiples of the item size")
+    if ret == -11:
+        raise MemoryError("solver workspace exceeds memory_limit")
+    if ret != 0:
+        raise RuntimeError("solver failed")
+
+
+@numba.njit
+def linear_sum_assignment(cost_matrix, maximize=False):
+    """The exact linear sum assignment of the 2-D cost_matrix as
+    (row_ind, col_ind), like nanolsap.linear_sum_assignment."""
+    cost = np.ascontiguousarray(cost_matrix)
+    n = min(cost.shape[0], cost.shape[1])
+    row_ind = np.empty(n, np.int64)
+    col_ind = np.empty(n, np.int64)
+    if n > 0:
+        _check(_solve(cost.shape[0], cost.shape[1], cost.ctypes, _lsap_dtype(cost), maximize,
+                      0, 0, 0, 0, -1, 0, 0, row_ind.ctypes, col_ind.ctypes))
+    return row_ind, col_ind
+
+
+@numba.njit
+def create_solver(flags=0):
+    """A solver handle for solve_into, flags is 0 or LSAP_SOLVER_STATS.
+    Release it with destroy_solver."""
+    solver = _solver_create(flags)
+    if solver == 0:
+        raise MemoryError("cannot create a solver")
+    return solver
+
+
+@numba.njit
+def destroy_solver(solver):
+    _solver_destroy(solver)
+
+
+@numba.njit
+def solve_into(solver, cost_matrix, row_ind, col_ind, maximize=False):
+    """Solve cost_matrix, of any strides, with the workspace of solver
+    and write the min(nr, nc) pairs to the int64 arrays row_ind and
+    col_ind. Returns the number of pairs."""
+    nr, nc = cost_matrix.shape
+    n = min(nr, nc)
+    if len(row_ind) < n or len(col_ind) < n:
+        raise ValueError("row_ind and col_ind must hold min(nr, nc) pairs")
+    # struct lsap_matrix, whose zero strides, of broadcast arrays, are real
+    # ones since LSAP_ABI_VERSION 2 and solved on a copy in the handle
+    matrix = np.empty(6, np.intp)
+    matrix[0] = cost_matrix.ctypes.data
+    matrix[1] = _lsap_dtype(cost_matrix)
+    matrix[2] = nr
+    matrix[3] = nc
+    matrix[4] = cost_matrix.strides[0]
+    matrix[5] = cost_matrix.strides[1]
+    _check(_solver_solve(solver, matrix.ctypes, maximize, 0, 0, 0, 0, -1, 0, 0,
+                         row_ind.ctypes, col_ind.ctypes))
+    return n
+
+
+@numba.njit
+def solver_duals(solver, u, v):
+    """Write the duals of the last solve_into to the float64 arrays u, one
+    per row, and v, one per column: u[i] + v[j] <= cost[i, j] with
+    equality on the pairs (>= when maximizing)."""
+    if _solver_duals(solver, u.ctypes, v.ctypes) != 0:
+        raise ValueError("the last solve has no duals")
@@ -0,0 +1,362 @@
+/*
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+1. Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following
+   disclaimer in the documentation and/or other materials provided
+   with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived
+   from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+Axial 3-D assignment by Lagrangian relaxation: pick min(n1, n2, n3)
+triples (i, j, k) of the cost tensor, every index at most once, with the
+smallest total cost.  The constraints of the largest axis k are relaxed
+with multipliers lambda_k, which leaves the 2-D assignment problem
+
+    D[i, j] = min_k C[i, j, k] - lambda_k
+
+whose optimal cost plus sum(lambda) is a lower bound.  The multipliers
+follow subgradient steps of Polyak size towards the best primal cost:
+
+    ML Fisher. The Lagrangian relaxation method for solving integer
+    programming problems. Management Science 27(1):1-18, 1981
+
+Each relaxed problem differs from the previous one by the multipliers
+only, so the 2-D solver is warm started from the previous assignment and
+column duals and only augments the rows whose pairs are no longer tight.
+A feasible 3-D assignment, the upper bound, is recovered by assigning the
+pairs of the relaxed solution to the k axis with a second 2-D solve, and
+improved by reassigning one axis at a time with the other two fixed.
+
+The tensor is read in place through a strided view, the axes permuted so
+that the relaxed one is the largest.  D is a transform of that view and
+is evaluated once per iteration into a dense buffer, since the 2-D solver
+reads every entry many times.
+*/
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include "rectangular_lsap.h"
+#include "rectangular_lsap_impl.h"
+#include "warm_start.h"
+#include "parallel_for.h"
+
+// iterations without a better lower bound before the step is halved
+#define AXIAL_STALL 3
+
+// Strided view of a contiguous 3-D cost tensor with permutable axes.
+template <typename T> class tensor3d {
+public:
+    tensor3d(const T *d, intptr_t n1, intptr_t n2, intptr_t n3)
+            : m_d(d), m_negative(false) {
+        m_shape[0] = n1;
+        m_shape[1] = n2;
+        m_shape[2] = n3;
+        m_stride[0] = n2 * n3;
+        m_stride[1] = n3;
+        m_stride[2] = 1;
+    }
+    double get(intptr_t i, intptr_t j, intptr_t k) const {
+        double r = m_d[i * m_stride[0] + j * m_stride[1] + k * m_stride[2]];
+        return m_negative ? -r : r;
+    }
+    intptr_t shape(int axis) const {
+        return m_shape[axis];
+    }
+    // axis t of the view is axis axes[t] of the tensor
+    void permute(const int axes[3]) {
+        intptr_t shape[3], stride[3];
+        for (int t = 0; t < 3; t++) {
+            shape[t] = m_shape[axes[t]];
+            stride[t] = m_stride[axes[t]];
+        }
+        std::copy(shape, shape + 3, m_shape);
+        std::copy(stride, stride + 3, m_stride);
+    }
+    void negative() {
+        m_negative = !m_negative;
+    }
+
+private:
+    const T *m_d;
+    intptr_t m_shape[3];
+    intptr_t m_stride[3];
+    bool m_negative;
+};
+
+// The relaxed 2-D costs D[i, j] = min_k C[i, j, k] - lambda[k] as a lazy
+// transform of the tensor view.
+template <typename T> class relaxed_matrix2d {
+public:
+    relaxed_matrix2d(const tensor3d<T>& cost, const std::vector<double>& lambda)
+            : m_cost(cost), m_lambda(lambda) {
+    }
+    double get(intptr_t i, intptr_t j, intptr_t* p_k) const {
+        double best = INFINITY;
+        *p_k = -1;
+        for (intptr_t k = 0; k < m_cost.shape(2); k++) {
+            double c = m_cost.get(i, j, k) - m_lambda[k];
+            if (c < best) {
+                best = c;
+                *p_k = k;
+            }
+        }
+        return best;
+    }
+
+private:
+    const tensor3d<T>& m_cost;
+    const std::vector<double>& m_lambda;
+};
+
+// The costs of moving the triples p of a 3-D assignment along one axis,
+// entry (p, x) is the cost of triple p with its index on axis replaced by x.
+template <typename T> class triple_matrix2d {
+public:
+    triple_matrix2d(const tensor3d<T>& cost, const std::vector<intptr_t>& triples, int axis)
+            : m_cost(cost), m_triples(triples), m_axis(axis) {
+    }
+    double get(intptr_t p, intptr_t x) const {
+        intptr_t t[3] = {m_triples[3 * p], m_triples[3 * p + 1], m_triples[3 * p + 2]};
+        t[m_axis] = x;
+        return m_cost.get(t[0], t[1], t[2]);
+    }
+
+private:
+    const tensor3d<T>& m_cost;
+    const std::vector<intptr_t>& m_triples;
+    int m_axis;
+};
+
+// Reassign one axis of the triples at a time with a 2-D solve, keeping the
+// other two fixed, until a round over the axes gains nothing.  Every step
+// is optimal given the others, so the cost never increases.  Returns the
+// final cost.
+template <typename T> static double
+improve_triples(const tensor3d<T>& tensor, intptr_t m, std::vector<intptr_t>& triples,
+                double total)
+{
+    std::vector<intptr_t> x4p(m);
+    while (true) {
+        double before = total;
+        for (int axis = 0; axis < 3; axis++) {
+            triple_matrix2d<T> view(tensor, triples, axis);
+            std::fill(x4p.begin(), x4p.end(), -1);
+            if (solve_view(m, tensor.shape(axis), view, -1, x4p) != 0) {
+                continue;
+            }
+            total = 0;
+            for (intptr_t p = 0; p < m; p++) {
+                total += view.get(p, x4p[p]);
+            }
+            for (intptr_t p = 0; p < m; p++) {
+                triples[3 * p + axis] = x4p[p];
+            }
+        }
+        if (!(total < before - 1e-12 * std::fabs(before))) {
+            return total;
+        }
+    }
+}
+
+template <typename T> static int
+solve_axial(intptr_t n1, intptr_t n2, intptr_t n3, const T* cost, bool maximize,
+            intptr_t max_iter, intptr_t n_threads, int64_t* a, int64_t* b, int64_t* c,
+            double* bounds, intptr_t* p_n_iter)
+{
+    *p_n_iter = 0;
+
+    // handle trivial inputs
+    if (n1 == 0 || n2 == 0 || n3 == 0) {
+        return 0;
+    }
+    if (max_iter < 1) {
+        return RECTANGULAR_LSAP_INVALID;
+    }
+    int ret = check_cost(n1 * n2, n3, cost, maximize);
+    if (ret != 0) {
+        return ret;
+    }
+
+    // sort the axes by length, the last and largest one is relaxed
+    int axes[3] = {0, 1, 2};
+    intptr_t shape[3] = {n1, n2, n3};
+    std::stable_sort(axes, axes + 3, [&](int s, int t) {
+        return shape[s] < shape[t];
+    });
+    tensor3d<T> tensor(cost, n1, n2, n3);
+    tensor.permute(axes);
+    if (maximize) {
+        tensor.negative();
+    }
+    intptr_t nr = tensor.shape(0);
+    intptr_t nc = tensor.shape(1);
+    intptr_t nk = tensor.shape(2);
+    // with nr == nk every k is used, otherwise k may stay free and lambda <= 0
+    bool equality = nr == nk;
+
+    std::vector<double> lambda(nk, 0);
+    relaxed_matrix2d<T> relaxed(tensor, lambda);
+    std::vector<double> dense(nr * nc);
+    std::vector<intptr_t> argk(nr * nc);
+    matrix2d<double> costmat{dense.data(), nr, nc};
+
+    std::vector<double> u(nr, 0);
+    std::vector<double> v(nc, 0);
+    std::vector<intptr_t> col4row(nr, -1);
+    std::vector<intptr_t> row4col(nc, -1);
+    std::vector<intptr_t> triples(3 * nr);
+    std::vector<intptr_t> best_triples;
+    std::vector<intptr_t> k4row(nr);
+    std::vector<double> g(nk);
+    triple_matrix2d<T> pairs(tensor, triples, 2);
+
+    double upper = INFINITY;
+    double lower = -INFINITY;
+    double theta = 0.5;
+    intptr_t stall = 0;
+    intptr_t iter = 0;
+    while (iter < max_iter) {
+        parallel_for(nr, std::max<intptr_t>(n_threads, 1), [&](intptr_t i, intptr_t) {
+            for (intptr_t j = 0; j < nc; j++) {
+                dense[i * nc + j] = relaxed.get(i, j, &argk[i * nc + j]);
+            }
+        });
+        if (iter > 0) {
+            ret = warm_start(nr, nc, costmat, u, v, col4row, row4col);
+        }
+        if (ret == 0) {
+            ret = solve_from(nr, nc, costmat, u, v, col4row, row4col);
+        }
+        if (ret != 0) {
+            // a pair without any finite k cannot be part of a 3-D assignment
+            return ret;
+        }
+
+        // dual bound and subgradient
+        double dual = 0;
+        std::fill(g.begin(), g.end(), 1.0);
+        for (intptr_t k = 0; k < nk; k++) {
+            dual += lambda[k];
+        }
+        for (intptr_t i = 0; i < nr; i++) {
+            dual += dense[i * nc + col4row[i]];
+            g[argk[i * nc + col4row[i]]] -= 1;
+        }
+
+        // primal bound, the relaxed pairs with their k assigned exactly and
+        // improved one axis at a time
+        for (intptr_t i = 0; i < nr; i++) {
+            triples[3 * i] = i;
+            triples[3 * i + 1] = col4row[i];
+            triples[3 * i + 2] = -1;
+        }
+        std::fill(k4row.begin(), k4row.end(), -1);
+        if (solve_view(nr, nk, pairs, -1, k4row) == 0) {
+            double primal = 0;
+            for (intptr_t i = 0; i < nr; i++) {
+                primal += pairs.get(i, k4row[i]);
+                triples[3 * i + 2] = k4row[i];
+            }
+            primal = improve_triples(tensor, nr, triples, primal);
+            if (primal < upper) {
+                upper = primal;
+                best_triples = triples;
+            }
+        }
+
+        if (lower == -INFINITY || dual > lower + 1e-12 * std::fabs(lower)) {
+            lower = dual;
+            stall = 0;
+        } else if (++stall >= AXIAL_STALL) {
+            theta /= 2;
+            stall = 0;
+        }
+        bounds[2 * iter] = maximize ? -upper : upper;
+        bounds[2 * iter + 1] = maximize ? -lower : lower;
+        iter++;
+
+        if (upper - lower <= 1e-9 * std::max(1.0, std::fabs(upper))) {
+            break;
+        }
+        // a multiplier at its bound with the step pointing out stays put
+        double norm2 = 0;
+        for (intptr_t k = 0; k < nk; k++) {
+            if (!equality && lambda[k] >= 0 && g[k] > 0) {
+                g[k] = 0;
+            }
+            norm2 += g[k] * g[k];
+        }
+        if (norm2 == 0 || theta < 1e-6) {
+            break;
+        }
+        double target = upper < INFINITY ? upper : dual + 0.05 * (std::fabs(dual) + 1);
+        double step = theta * (target - dual) / norm2;
+        for (intptr_t k = 0; k < nk; k++) {
+            lambda[k] += step * g[k];
+            if (!equality) {
+                lambda[k] = std::min(lambda[k], 0.0);
+            }
+        }
+    }
+    *p_n_iter = iter;
+    if (upper == INFINITY) {
+        return RECTANGULAR_LSAP_INFEASIBLE;
+    }
+
+    // back to the tensor axes, sorted by the first one
+    std::vector<std::vector<int64_t> > result(nr, std::vector<int64_t>(3));
+    for (intptr_t i = 0; i < nr; i++) {
+        for (int t = 0; t < 3; t++) {
+            result[i][axes[t]] = best_triples[3 * i + t];
+        }
+    }
+    std::sort(result.begin(), result.end());
+    for (intptr_t i = 0; i < nr; i++) {
+        a[i] = result[i][0];
+        b[i] = result[i][1];
+        c[i] = result[i][2];
+    }
+    return 0;
+}
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int axial_assignment_dtype(
+    intptr_t n1, intptr_t n2, intptr_t n3, void* input_cost, intptr_t dtype, bool maximize,
+    intptr_t max_iter, intptr_t n_threads, int64_t* a, int64_t* b, int64_t* c,
+    double* bounds, intptr_t* p_n_iter)
+{
+    return lsap_validated([&]() -> int {
+        LSAP_DTYPE_SWITCH(dtype, T,
+            return solve_axial(n1, n2, n3, (const T *)input_cost, maximize,
+                               max_iter, n_threads, a, b, c, bounds, p_n_iter));
+    }(), n1, n2);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,440 @@
+/*
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+1. Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following
+   disclaimer in the documentation and/or other materials provided
+   with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived
+   from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+
+This code solves the bottleneck assignment problem: find an assignment
+whose largest entry is minimal.  It searches the threshold over the
+distinct cost values; an assignment exists below a threshold if the
+bipartite graph of the entries <= threshold has a matching of the
+required size, found with Hopcroft-Karp:
+
+    JE Hopcroft, RM Karp. An n^5/2 algorithm for maximum matchings in
+    bipartite graphs. SIAM Journal on Computing 2(4):225-231, 1973
+
+The matching is kept between thresholds: raising the threshold only adds
+edges, lowering it drops the matched edges above it.  Every candidate
+threshold comes from a scan of the view, no sorted copy of the cost
+matrix is made unless few candidates are left.
+*/
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include "rectangular_lsap.h"
+#include "rectangular_lsap_impl.h"
+
+// Entries above the threshold read as infinity.
+template <typename M> class threshold_matrix2d {
+public:
+    threshold_matrix2d(const M& cost, double threshold)
+            : m_cost(cost), m_threshold(threshold) {
+    }
+    double get(intptr_t i, intptr_t j) const {
+        double r = m_cost.get(i, j);
+        return r <= m_threshold ? r : INFINITY;
+    }
+private:
+    const M& m_cost;
+    double m_threshold;
+};
+
+// Maximum cardinality matching on the entries c < INFINITY, c <= threshold,
+// continued from the matching in col4row / row4col and stopped once it has
+// need pairs.  Returns the matching size.
+template <typename M> class hopcroft_karp {
+public:
+    hopcroft_karp(intptr_t nr, intptr_t nc, const M& cost)
+            : col4row(nr, -1), row4col(nc, -1),
+            m_nr(nr), m_nc(nc), m_cost(cost),
+            m_dist(nr), m_queue(nr), m_next(nr), m_stack(nr), m_limit(-1) {
+    }
+
+    bool allowed(intptr_t i, intptr_t j, double threshold) const {
+        double c = m_cost.get(i, j);
+        return c <= threshold && c < INFINITY;
+    }
+
+    // drop the matched entries above the threshold
+    void restrict(double threshold) {
+        for (intptr_t i = 0; i < m_nr; i++) {
+            intptr_t j = col4row[i];
+            if (j >= 0 && !allowed(i, j, threshold)) {
+                col4row[i] = -1;
+                row4col[j] = -1;
+            }
+        }
+    }
+
+    intptr_t size() const {
+        intptr_t n = 0;
+        for (intptr_t i = 0; i < m_nr; i++) {
+            n += col4row[i] >= 0;
+        }
+        return n;
+    }
+
+    intptr_t run(double threshold, intptr_t need) {
+        intptr_t matched = size();
+        while (matched < need && bfs(threshold)) {
+            for (intptr_t i = 0; i < m_nr && matched < need; i++) {
+                if (col4row[i] == -1 && dfs(i, threshold)) {
+                    matched++;
+                }
+            }
+        }
+        return matched;
+    }
+
+    std::vector<intptr_t> col4row;
+    std::vector<intptr_t> row4col;
+
+private:
+    static const intptr_t UNREACHED = -1;
+
+    // layer the rows by alternating distance from the free rows, returns
+    // whether a free column is reachable
+    bool bfs(double threshold) {
+        intptr_t head = 0, tail = 0;
+        for (intptr_t i = 0; i < m_nr; i++) {
+            if (col4row[i] == -1) {
+                m_dist[i] = 0;
+                m_queue[tail++] = i;
+            } else {
+                m_dist[i] = UNREACHED;
+            }
+            m_next[i] = 0;
+        }
+        m_limit = UNREACHED;
+        while (head < tail) {
+            intptr_t i = m_queue[head++];
+            if (m_limit != UNREACHED && m_dist[i] >= m_limit) {
+                break;
+            }
+            for (intptr_t j = 0; j < m_nc; j++) {
+                if (!allowed(i, j, threshold)) {
+                    continue;
+                }
+                intptr_t i2 = row4col[j];
+                if (i2 == -1) {
+                    if (m_limit == UNREACHED) {
+                        m_limit = m_dist[i] + 1;
+                    }
+                } else if (m_dist[i2] == UNREACHED) {
+                    m_dist[i2] = m_dist[i] + 1;
+                    m_queue[tail++] = i2;
+                }
+            }
+        }
+        return m_limit != UNREACHED;
+    }
+
+    // find an augmenting path from the free row root along the layers,
+    // iterative so that long paths do not exhaust the stack
+    bool dfs(intptr_t root, double threshold) {
+        intptr_t top = 0;
+        m_stack[top++] = root;
+        while (top > 0) {
+            intptr_t i = m_stack[top - 1];
+            bool advanced = false;
+            for (; m_next[i] < m_nc; m_next[i]++) {
+                intptr_t j = m_next[i];
+                if (!allowed(i, j, threshold)) {
+                    continue;
+                }
+                intptr_t i2 = row4col[j];
+                if (i2 == -1) {
+                    if (m_dist[i] + 1 != m_limit) {
+                        continue;
+                    }
+                    // flip the path on the stack, each row takes the
+                    // column its m_next points at
+                    for (intptr_t s = top - 1; s >= 0; s--) {
+                        intptr_t r = m_stack[s];
+                        intptr_t c = m_next[r];
+                        col4row[r] = c;
+                        row4col[c] = r;
+                    }
+                    return true;
+                }
+                if (m_dist[i2] == m_dist[i] + 1) {
+                    m_stack[top++] = i2;
+                    advanced = true;
+                    break;
+                }
+            }
+            if (!advanced) {
+                // dead end, never visit this row again in this phase
+                m_dist[i] = UNREACHED;
+                top--;
+                if (top > 0) {
+                    m_next[m_stack[top - 1]]++;
+                }
+            }
+        }
+        return false;
+    }
+
+    intptr_t m_nr;
+    intptr_t m_nc;
+    const M& m_cost;
+    std::vector<intptr_t> m_dist;
+    std::vector<intptr_t> m_queue;
+    std::vector<intptr_t> m_next;
+    std::vector<intptr_t> m_stack;
+    intptr_t m_limit;
+};
+
+// Small deterministic generator for sampling thresholds.
+static inline uint64_t
+splitmix64(uint64_t *state)
+{
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Collect the entries of the view strictly inside (lo, hi): all of them if
+// there are at most max_exact, otherwise a uniform sample.  Returns the
+// number of entries inside, *p_exact tells whether values holds all.
+template <typename M> static size_t
+collect_candidates(intptr_t nr, intptr_t nc, const M& cost, double lo, double hi,
+                   std::vector<double>& values, uint64_t *state, bool *p_exact)
+{
+    const size_t max_exact = 1 << 16;
+    const size_t n_samples = 1023;
+
+    values.clear();
+    size_t count = 0;
+    bool sampling = false;
+    for (intptr_t i = 0; i < nr; i++) {
+        for (intptr_t j = 0; j < nc; j++) {
+            double c = cost.get(i, j);
+            if (!(c > lo && c < hi)) {
+                continue;
+            }
+            count++;
+            if (!sampling && values.size() < max_exact) {
+                values.push_back(c);
+                continue;
+            }
+            if (!sampling) {
+                // too many candidates, keep a random subset and continue
+                // with reservoir sampling
+                for (size_t s = 0; s < n_samples; s++) {
+                    size_t r = s + splitmix64(state) % (values.size() - s);
+                    std::swap(values[s], values[r]);
+                }
+                values.resize(n_samples);
+                sampling = true;
+            }
+            uint64_t r = splitmix64(state) % count;
+            if (r < n_samples) {
+                values[r] = c;
+            }
+        }
+    }
+    *p_exact = !sampling;
+    return count;
+}
+
+// Find the bottleneck assignment of need pairs on a prepared view with
+// nr <= nc.  With refine, the sum of the entries is minimized among the
+// bottleneck optimal assignments.
+template <typename M> static int
+solve_bottleneck(intptr_t nr, intptr_t nc, const M& cost, intptr_t k, bool refine,
+                 std::vector<intptr_t>& col4row)
+{
+    intptr_t need = (k >= 0 && k < nr) ? k : nr;
+    if (need == 0) {
+        return 0;
+    }
+
+    hopcroft_karp<M> hk(nr, nc, cost);
+
+    // any feasible assignment bounds the answer from above
+    if (hk.run(INFINITY, need) < need) {
+        return RECTANGULAR_LSAP_INFEASIBLE;
+    }
+    std::vector<intptr_t> best = hk.col4row;
+    double hi = -INFINITY;
+    for (intptr_t i = 0; i < nr; i++) {
+        if (best[i] >= 0) {
+            hi = std::max(hi, cost.get(i, best[i]));
+        }
+    }
+
+    // every row must be assigned, so no threshold below the largest
+    // row minimum can work
+    double lo = -INFINITY;
+    if (need == nr) {
+        for (intptr_t i = 0; i < nr; i++) {
+            double rowmin = INFINITY;
+            for (intptr_t j = 0; j < nc; j++) {
+                rowmin = std::min(rowmin, cost.get(i, j));
+            }
+            lo = std::max(lo, rowmin);
+        }
+        lo = std::nextafter(lo, -INFINITY);
+    }
+
+    // cut (lo, hi) at the sampled median until the remaining candidates
+    // fit in memory, then binary search over them without rescanning
+    std::vector<double> values;
+    uint64_t state = 0;
+    bool exact = false;
+    while (!exact) {
+        if (collect_candidates(nr, nc, cost, lo, hi, values, &state, &exact) == 0) {
+            break;
+        }
+        if (exact) {
+            std::sort(values.begin(), values.end());
+            values.erase(std::unique(values.begin(), values.end()), values.end());
+        } else {
+            std::nth_element(values.begin(), values.begin() + values.size() / 2, values.end());
+            values.assign(1, values[values.size() / 2]);
+        }
+
+        // values[first] is the lowest candidate not known to be infeasible
+        size_t first = 0, last = values.size();
+        while (first < last) {
+            size_t mid = first + (last - first) / 2;
+            double threshold = values[mid];
+            hk.restrict(threshold);
+            if (hk.run(threshold, need) >= need) {
+                best = hk.col4row;
+                // the matching found may be better than the threshold
+                hi = -INFINITY;
+                for (intptr_t i = 0; i < nr; i++) {
+                    if (best[i] >= 0) {
+                        hi = std::max(hi, cost.get(i, best[i]));
+                    }
+                }
+                last = std::lower_bound(values.begin() + first, values.begin() + mid, hi) - values.begin();
+            } else {
+                lo = threshold;
+                first = mid + 1;
+            }
+        }
+    }
+
+    if (refine) {
+        threshold_matrix2d<M> bounded{cost, hi};
+        return solve_view(nr, nc, bounded, k, col4row);
+    }
+
+    // Hopcroft-Karp may add several pairs per phase, keep the first need
+    intptr_t n = 0;
+    for (intptr_t i = 0; i < nr; i++) {
+        if (best[i] >= 0 && n < need) {
+            col4row[i] = best[i];
+            n++;
+        }
+    }
+    return 0;
+}
+
+template <typename T> static int
+bottleneck(intptr_t nr, intptr_t nc, const T* cost, bool maximize,
+           const intptr_t *subrows, intptr_t n_subrows, const intptr_t *subcols, intptr_t n_subcols,
+           intptr_t k, bool refine, const struct lsap_options* options,
+           int64_t* a, int64_t* b)
+{
+    // handle trivial inputs
+    if (nr == 0 || nc == 0) {
+        return 0;
+    }
+
+    matrix2d<T> costmat{cost, nr, nc};
+    bool transpose;
+    int ret = make_cost_view(&nr, &nc, cost, maximize, &subrows, n_subrows,
+                             &subcols, n_subcols, costmat, &transpose);
+    if (ret != 0) {
+        return ret;
+    }
+
+    if (k > nr) {
+        return RECTANGULAR_LSAP_K_INVALID;
+    }
+    if (!within_memory_limit(options, bottleneck_workspace_bytes(nr, nc, k, refine))) {
+        return RECTANGULAR_LSAP_MEMORY_LIMIT;
+    }
+    std::vector<intptr_t> col4row(nr, -1);
+    ret = solve_bottleneck(nr, nc, costmat, k, refine, col4row);
+    if (ret != 0) {
+        return ret;
+    }
+
+    return write_result(nr, col4row, transpose, subrows, subcols, a, b);
+}
+
+// col4row, hopcroft_karp, the best matching and the candidate values, with
+// the exact solve on top when refining
+intptr_t
+bottleneck_workspace_bytes(intptr_t nr, intptr_t nc, intptr_t k, bool refine)
+{
+    intptr_t values = std::min<intptr_t>(nr * nc, 1 << 16) * sizeof(double);
+    intptr_t bytes = (7 * nr + nc) * sizeof(intptr_t) + values;
+    if (refine) {
+        bytes += exact_workspace_bytes(nr, nc, k, LSAP_ROW_ORDER_INDEX);
+    }
+    return bytes;
+}
+
+int lsap_bottleneck_dtype(
+    intptr_t nr, intptr_t nc, void* input_cost, intptr_t dtype, bool maximize,
+    const intptr_t *subrows, intptr_t n_subrows, const intptr_t *subcols, intptr_t n_subcols,
+    intptr_t k, bool refine, const struct lsap_options* options,
+    int64_t* a, int64_t* b)
+{
+    LSAP_DTYPE_SWITCH(dtype, T,
+        return bottleneck(nr, nc, (const T *)input_cost, maximize,
+                          subrows, n_subrows, subcols, n_subcols,
+                          k, refine, options, a, b));
+}
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int bottleneck_rectangular_linear_sum_assignment_dtype(
+    intptr_t nr, intptr_t nc, void* input_cost, intptr_t dtype, bool maximize,
+    const intptr_t *subrows, intptr_t n_subrows, const intptr_t *subcols, intptr_t n_subcols,
+    intptr_t k, bool refine, const struct lsap_options* options,
+    int64_t* a, int64_t* b)
+{
+    return lsap_validated(
+        lsap_bottleneck_dtype(nr, nc, input_cost, dtype, maximize, subrows, n_subrows,
+                              subcols, n_subcols, k, refine, options, a, b), nr, nc);
+}
+
+#ifdef __cplusplus
+}
+#endif
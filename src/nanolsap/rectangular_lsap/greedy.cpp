@@ -0,0 +1,389 @@
+/*
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+1. Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following
+   disclaimer in the documentation and/or other materials provided
+   with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived
+   from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+Approximate assignment for tight latency budgets.  Every row keeps its
+GREEDY_CANDIDATES cheapest columns, found in one pass over the row with a
+small sorted buffer.  The pass is scalar, entries are read through the
+cost view with its subscripts and dtype, and most of them only cost a
+comparison with the last candidate.  The candidate entries of all rows
+are matched greedily in order of increasing cost; a row left without a
+free candidate takes its cheapest free column, and a row without any
+finite free column is matched by a breadth first augmenting path over
+the finite entries.
+
+The matching is then improved by local search over the candidates: a row
+moves to a cheaper free column, swaps columns with the owner of a cheaper
+column (2-opt), or rotates columns with the owner of a cheaper column and
+the owner of one of its candidates (3-opt).  Each pass is O(nr * K^2) for
+K candidates and the number of passes is bounded by max_iter.
+
+The lower bound is the dual objective of the row minima u and, for square
+problems, the column minima v of the reduced costs.  Any u, v with
+u_i + v_j <= c_ij bound the optimum from below, for rectangular problems
+v <= 0 is required as well so v = 0 there.
+*/
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include "rectangular_lsap.h"
+#include "rectangular_lsap_impl.h"
+#include "warm_start.h"
+#include "parallel_for.h"
+
+// candidate columns kept per row
+#define GREEDY_CANDIDATES 8
+// rows of one work item of the parallel passes
+#define GREEDY_ROW_BLOCK 64
+
+template <typename M> class greedy {
+    const M& m_cost;
+    intptr_t m_nr;
+    intptr_t m_nc;
+    intptr_t m_k;
+
+public:
+    greedy(const M& cost, intptr_t nr, intptr_t nc)
+            : m_cost(cost), m_nr(nr), m_nc(nc), m_k(std::min<intptr_t>(nc, GREEDY_CANDIDATES)),
+            cand_col(nr * m_k, -1), cand_cost(nr * m_k, INFINITY),
+            col4row(nr, -1), row4col(nc, -1) {
+    }
+
+    // Keep the m_k cheapest finite columns of every row, cheapest first.
+    void candidates(intptr_t n_threads) {
+        intptr_t n_items = (m_nr + GREEDY_ROW_BLOCK - 1) / GREEDY_ROW_BLOCK;
+        parallel_for(n_items, n_threads, [&](intptr_t item, intptr_t) {
+            intptr_t end = std::min(m_nr, (item + 1) * GREEDY_ROW_BLOCK);
+            for (intptr_t i = item * GREEDY_ROW_BLOCK; i < end; i++) {
+                intptr_t* col = &cand_col[i * m_k];
+                double* cst = &cand_cost[i * m_k];
+                double worst = INFINITY;
+                for (intptr_t j = 0; j < m_nc; j++) {
+                    double c = m_cost.get(i, j);
+                    if (!(c < worst)) {
+                        continue;
+                    }
+                    // insert into the sorted buffer, dropping the last
+                    intptr_t t = m_k - 1;
+                    for (; t > 0 && cst[t - 1] > c; t--) {
+                        cst[t] = cst[t - 1];
+                        col[t] = col[t - 1];
+                    }
+                    cst[t] = c;
+                    col[t] = j;
+                    worst = cst[m_k - 1];
+                }
+            }
+        });
+    }
+
+    // Dual lower bound from the row minima, tightened by the column minima
+    // of the reduced costs when square.
+    double lower_bound(intptr_t n_threads) {
+        double bound = 0;
+        for (intptr_t i = 0; i < m_nr; i++) {
+            bound += cand_cost[i * m_k];
+        }
+        if (m_nr < m_nc || bound == INFINITY) {
+            return bound;
+        }
+        intptr_t n_items = (m_nr + GREEDY_ROW_BLOCK - 1) / GREEDY_ROW_BLOCK;
+        n_threads = std::min(n_threads, n_items);
+        std::vector<std::vector<double> > v(n_threads, std::vector<double>(m_nc, INFINITY));
+        parallel_for(n_items, n_threads, [&](intptr_t item, intptr_t tid) {
+            std::vector<double>& vt = v[tid];
+            intptr_t end = std::min(m_nr, (item + 1) * GREEDY_ROW_BLOCK);
+            for (intptr_t i = item * GREEDY_ROW_BLOCK; i < end; i++) {
+                double u = cand_cost[i * m_k];
+                for (intptr_t j = 0; j < m_nc; j++) {
+                    vt[j] = std::min(vt[j], m_cost.get(i, j) - u);
+                }
+            }
+        });
+        for (intptr_t j = 0; j < m_nc; j++) {
+            double vj = v[0][j];
+            for (intptr_t t = 1; t < n_threads; t++) {
+                vj = std::min(vj, v[t][j]);
+            }
+            bound += vj;
+        }
+        return bound;
+    }
+
+    // Greedy matching of the candidate entries, then the leftover rows.
+    int match() {
+        std::vector<intptr_t> order(m_nr * m_k);
+        for (size_t t = 0; t < order.size(); t++) {
+            order[t] = t;
+        }
+        std::sort(order.begin(), order.end(), [&](intptr_t s, intptr_t t) {
+            return cand_cost[s] < cand_cost[t];
+        });
+        for (intptr_t t: order) {
+            intptr_t i = t / m_k;
+            intptr_t j = cand_col[t];
+            if (cand_cost[t] == INFINITY) {
+                break;
+            }
+            if (col4row[i] == -1 && row4col[j] == -1) {
+                col4row[i] = j;
+                row4col[j] = i;
+            }
+        }
+
+        for (intptr_t i = 0; i < m_nr; i++) {
+            if (col4row[i] >= 0) {
+                continue;
+            }
+            double best = INFINITY;
+            intptr_t jbest = -1;
+            for (intptr_t j = 0; j < m_nc; j++) {
+                double c = m_cost.get(i, j);
+                if (row4col[j] == -1 && c < best) {
+                    best = c;
+                    jbest = j;
+                }
+            }
+            if (jbest >= 0) {
+                col4row[i] = jbest;
+                row4col[jbest] = i;
+            } else if (!augment_bfs(m_nc, m_cost, i, col4row, row4col)) {
+                return RECTANGULAR_LSAP_INFEASIBLE;
+            }
+        }
+        return 0;
+    }
+
+    // One pass of moves to free columns, 2-opt and 3-opt over the
+    // candidates, returns whether the cost decreased.
+    bool improve() {
+        bool improved = false;
+        for (intptr_t i = 0; i < m_nr; i++) {
+            intptr_t j = col4row[i];
+            double ci = m_cost.get(i, j);
+            for (intptr_t s = 0; s < m_k; s++) {
+                intptr_t j2 = cand_col[i * m_k + s];
+                double c12 = cand_cost[i * m_k + s];
+                if (!(c12 < ci)) {
+                    break;
+                }
+                if (j2 == j) {
+                    continue;
+                }
+                intptr_t i2 = row4col[j2];
+                if (i2 == -1) {
+                    assign(i, j2);
+                    row4col[j] = -1;
+                    improved = true;
+                    break;
+                }
+                double gain = ci - c12 + m_cost.get(i2, j2);
+                if (better(m_cost.get(i2, j), gain)) {
+                    assign(i, j2);
+                    assign(i2, j);
+                    improved = true;
+                    break;
+                }
+                if (rotate(i, j, i2, j2, gain)) {
+                    improved = true;
+                    break;
+                }
+            }
+        }
+        return improved;
+    }
+
+    // Sum of the assigned entries of the view.
+    double cost() const {
+        double total = 0;
+        for (intptr_t i = 0; i < m_nr; i++) {
+            total += m_cost.get(i, col4row[i]);
+        }
+        return total;
+    }
+
+    std::vector<intptr_t> cand_col;
+    std::vector<double> cand_cost;
+    std::vector<intptr_t> col4row;
+    std::vector<intptr_t> row4col;
+
+private:
+    void assign(intptr_t i, intptr_t j) {
+        col4row[i] = j;
+        row4col[j] = i;
+    }
+
+    // A move with an added cost of c pays off against gain, with some slack
+    // for rounding so that the passes terminate.
+    static bool better(double c, double gain) {
+        return c < gain - 1e-12 * (std::fabs(c) + std::fabs(gain));
+    }
+
+    // 3-opt: i takes j2 from i2, i2 takes one of its candidates j3 from i3
+    // and i3 takes j, or j3 is free and j is released.
+    bool rotate(intptr_t i, intptr_t j, intptr_t i2, intptr_t j2, double gain) {
+        for (intptr_t s = 0; s < m_k; s++) {
+            intptr_t j3 = cand_col[i2 * m_k + s];
+            double c23 = cand_cost[i2 * m_k + s];
+            if (!(c23 < gain)) {
+                break;
+            }
+            if (j3 == j2 || j3 == j) {
+                continue;
+            }
+            intptr_t i3 = row4col[j3];
+            if (i3 == -1) {
+                if (better(c23, gain)) {
+                    assign(i, j2);
+                    assign(i2, j3);
+                    row4col[j] = -1;
+                    return true;
+                }
+                continue;
+            }
+            if (better(c23 + m_cost.get(i3, j), gain + m_cost.get(i3, j3))) {
+                assign(i, j2);
+                assign(i2, j3);
+                assign(i3, j);
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+template <typename T> static int
+solve_greedy(intptr_t nr, intptr_t nc, const T* cost, bool maximize,
+             const intptr_t *subrows, intptr_t n_subrows, const intptr_t *subcols, intptr_t n_subcols,
+             const struct lsap_options* options, int64_t* a, int64_t* b,
+             double* p_cost, double* p_bound)
+{
+    if (p_cost != nullptr) {
+        *p_cost = 0;
+    }
+    if (p_bound != nullptr) {
+        *p_bound = 0;
+    }
+
+    // handle trivial inputs
+    if (nr == 0 || nc == 0) {
+        return 0;
+    }
+
+    matrix2d<T> costmat{cost, nr, nc};
+    bool transpose;
+    int ret = make_cost_view(&nr, &nc, cost, maximize, &subrows, n_subrows,
+                             &subcols, n_subcols, costmat, &transpose);
+    if (ret != 0) {
+        return ret;
+    }
+    intptr_t n_threads = tuned_threads(options->n_threads, nr * nc);
+    if (!within_memory_limit(options, greedy_workspace_bytes(nr, nc, n_threads,
+                                                             p_bound != nullptr))) {
+        return RECTANGULAR_LSAP_MEMORY_LIMIT;
+    }
+
+    greedy<matrix2d<T> > gr(costmat, nr, nc);
+    gr.candidates(n_threads);
+    ret = gr.match();
+    if (ret != 0) {
+        return ret;
+    }
+    for (intptr_t iter = 0; options->max_iter < 0 || iter < options->max_iter; iter++) {
+        if (!gr.improve()) {
+            break;
+        }
+    }
+
+    // the view is negated when maximizing, the bound is then from above
+    if (p_cost != nullptr) {
+        double total = gr.cost();
+        *p_cost = maximize ? -total : total;
+    }
+    if (p_bound != nullptr) {
+        double bound = gr.lower_bound(n_threads);
+        *p_bound = maximize ? -bound : bound;
+    }
+
+    return write_result(nr, gr.col4row, transpose, subrows, subcols, a, b);
+}
+
+// the candidates, col4row and row4col, then the largest of the sort of the
+// candidates, a breadth first search and the bound, which has a row of
+// column minima per thread when square
+intptr_t
+greedy_workspace_bytes(intptr_t nr, intptr_t nc, intptr_t n_threads, bool bound)
+{
+    intptr_t k = std::min<intptr_t>(nc, GREEDY_CANDIDATES);
+    intptr_t base = nr * k * (sizeof(intptr_t) + sizeof(double)) + (nr + nc) * sizeof(intptr_t);
+    intptr_t extra = std::max(nr * k, nr + nc) * sizeof(intptr_t);
+    if (bound && nr == nc) {
+        intptr_t n_items = (nr + GREEDY_ROW_BLOCK - 1) / GREEDY_ROW_BLOCK;
+        n_threads = std::min(std::max<intptr_t>(n_threads, 1), n_items);
+        extra = std::max<intptr_t>(extra, n_threads * nc * sizeof(double));
+    }
+    return base + extra;
+}
+
+int lsap_greedy_dtype(
+    intptr_t nr, intptr_t nc, void* input_cost, intptr_t dtype, bool maximize,
+    const intptr_t *subrows, intptr_t n_subrows, const intptr_t *subcols, intptr_t n_subcols,
+    const struct lsap_options* options, int64_t* a, int64_t* b,
+    double* p_cost, double* p_bound)
+{
+    struct lsap_options defaults;
+    if (options == nullptr) {
+        lsap_options_init(&defaults);
+        options = &defaults;
+    }
+    LSAP_DTYPE_SWITCH(dtype, T,
+        return solve_greedy(nr, nc, (const T *)input_cost, maximize,
+                            subrows, n_subrows, subcols, n_subcols,
+                            options, a, b, p_cost, p_bound));
+}
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int greedy_rectangular_linear_sum_assignment_dtype(
+    intptr_t nr, intptr_t nc, void* input_cost, intptr_t dtype, bool maximize,
+    const intptr_t *subrows, intptr_t n_subrows, const intptr_t *subcols, intptr_t n_subcols,
+    const struct lsap_options* options, int64_t* a, int64_t* b,
+    double* p_cost, double* p_bound)
+{
+    return lsap_validated(
+        lsap_greedy_dtype(nr, nc, input_cost, dtype, maximize, subrows, n_subrows,
+                          subcols, n_subcols, options, a, b, p_cost, p_bound), nr, nc);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,327 @@
+/*
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+1. Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following
+   disclaimer in the documentation and/or other materials provided
+   with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived
+   from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+This code enumerates the k best assignments with Murty's partitioning:
+
+    KG Murty. An algorithm for ranking all the assignments in order of
+    increasing cost. Operations Research 16(3):682-687, 1968
+
+Every child subproblem differs from its parent by one forbidden entry
+plus rows forced to keep their parent column.  The parent assignment and
+dual variables stay optimal for everything but the row of the forbidden
+entry, so a child is solved by removing that row and running one shortest
+augmenting path, O(nc^2) instead of a full O(nr*nc^2) solve (c.f. Miller,
+Stone and Cox, Optimizing Murty's ranked assignment method, 1997).
+
+Rectangular problems are solved in their square form: nc - nr dummy rows
+of zero cost absorb the unassigned columns, which keeps the parent duals
+valid when a child frees a column.
+*/
+
+#include <cmath>
+#include <map>
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include "rectangular_lsap.h"
+#include "rectangular_lsap_impl.h"
+#include "parallel_for.h"
+
+// Forced and forbidden entries of a subproblem as a view over the original
+// cost buffer: nothing is copied, constrained entries read as infinity.
+template <typename T> class constrained_matrix2d {
+public:
+    constrained_matrix2d(const matrix2d<T>& cost, intptr_t nr,
+                         const std::vector<intptr_t>& forced_col,
+                         const std::vector<intptr_t>& forced_row,
+                         const std::vector<std::vector<intptr_t> >& forbidden)
+            : m_cost(cost), m_nr(nr),
+            m_forced_col(forced_col), m_forced_row(forced_row),
+            m_forbidden(forbidden) {
+    }
+    double get(intptr_t i, intptr_t j) const {
+        if (m_forced_row[j] >= 0 && m_forced_row[j] != i) {
+            return INFINITY;
+        }
+        if (i >= m_nr) {
+            return 0;
+        }
+        if (m_forced_col[i] >= 0 && m_forced_col[i] != j) {
+            return INFINITY;
+        }
+        const std::vector<intptr_t>& f = m_forbidden[i];
+        if (std::find(f.begin(), f.end(), j) != f.end()) {
+            return INFINITY;
+        }
+        return m_cost.get(i, j);
+    }
+private:
+    const matrix2d<T>& m_cost;
+    intptr_t m_nr;
+    const std::vector<intptr_t>& m_forced_col;
+    const std::vector<intptr_t>& m_forced_row;
+    const std::vector<std::vector<intptr_t> >& m_forbidden;
+};
+
+struct murty_node {
+    double cost;
+    // square form: nc rows including the dummy ones
+    std::vector<intptr_t> col4row;
+    std::vector<double> u;
+    std::vector<double> v;
+    // (row, col) pairs, rows of the view
+    std::vector<std::pair<intptr_t, intptr_t> > forced;
+    std::vector<std::pair<intptr_t, intptr_t> > forbidden;
+};
+
+// Per thread scratch space of the augmenting path step.
+struct murty_workspace {
+    murty_workspace(intptr_t n)
+            : shortestPathCosts(n), path(n, -1), row4col(n), SR(n), SC(n),
+            remaining(n), forbidden(n), forced_col(n, -1), forced_row(n, -1) {
+    }
+    std::vector<double> shortestPathCosts;
+    std::vector<intptr_t> path;
+    std::vector<intptr_t> row4col;
+    std::vector<bool> SR;
+    std::vector<bool> SC;
+    std::vector<intptr_t> remaining;
+    std::vector<std::vector<intptr_t> > forbidden;
+    std::vector<intptr_t> forced_col;
+    std::vector<intptr_t> forced_row;
+};
+
+template <typename M> static double
+assignment_cost(intptr_t nr, const M& cost, const std::vector<intptr_t>& col4row)
+{
+    double r = 0;
+    for (intptr_t i = 0; i < nr; i++) {
+        r += cost.get(i, col4row[i]);
+    }
+    return r;
+}
+
+// Solve child t of parent: the first t unforced rows of branch keep their
+// parent column, entry (branch[t], parent column) is forbidden.  Returns
+// false if the child has no feasible assignment.
+template <typename T> static bool
+solve_child(intptr_t nr, intptr_t nc, const matrix2d<T>& costmat,
+            const murty_node& parent, const std::vector<intptr_t>& branch,
+            intptr_t t, murty_workspace& ws, murty_node& child)
+{
+    child.forced = parent.forced;
+    child.forbidden = parent.forbidden;
+    for (intptr_t s = 0; s < t; s++) {
+        child.forced.push_back(std::make_pair(branch[s], parent.col4row[branch[s]]));
+    }
+    intptr_t curRow = branch[t];
+    child.forbidden.push_back(std::make_pair(curRow, parent.col4row[curRow]));
+
+    std::fill(ws.forced_col.begin(), ws.forced_col.end(), -1);
+    std::fill(ws.forced_row.begin(), ws.forced_row.end(), -1);
+    for (auto& f: ws.forbidden) {
+        f.clear();
+    }
+    for (auto& p: child.forced) {
+        ws.forced_col[p.first] = p.second;
+        ws.forced_row[p.second] = p.first;
+    }
+    for (auto& p: child.forbidden) {
+        ws.forbidden[p.first].push_back(p.second);
+    }
+    constrained_matrix2d<T> view{costmat, nr, ws.forced_col, ws.forced_row, ws.forbidden};
+
+    // warm start from the parent, only curRow is left to assign
+    child.u = parent.u;
+    child.v = parent.v;
+    child.col4row = parent.col4row;
+    for (intptr_t i = 0; i < nc; i++) {
+        ws.row4col[child.col4row[i]] = i;
+    }
+    ws.row4col[child.col4row[curRow]] = -1;
+    child.col4row[curRow] = -1;
+
+    double minVal;
+    intptr_t sink = augmenting_path(nc, view, child.u, child.v, ws.path, ws.row4col,
+                                    ws.shortestPathCosts, curRow, ws.SR, ws.SC,
+                                    ws.remaining, &minVal);
+    if (sink < 0) {
+        return false;
+    }
+    augment(nc, nc, curRow, sink, minVal, child.u, child.v, ws.shortestPathCosts,
+            ws.path, child.col4row, ws.row4col, ws.SR, ws.SC);
+
+    child.cost = assignment_cost(nr, view, child.col4row);
+    return child.cost != INFINITY;
+}
+
+template <typename T> static int
+k_best(intptr_t nr, intptr_t nc, const T* cost, bool maximize,
+       const intptr_t *subrows, intptr_t n_subrows, const intptr_t *subcols, intptr_t n_subcols,
+       intptr_t k, intptr_t n_threads, int64_t* a, int64_t* b, double* costs,
+       intptr_t* p_found)
+{
+    *p_found = 0;
+    if (k <= 0) {
+        return 0;
+    }
+
+    matrix2d<T> costmat{cost, nr, nc};
+    bool transpose;
+    int ret = make_cost_view(&nr, &nc, cost, maximize, &subrows, n_subrows,
+                             &subcols, n_subcols, costmat, &transpose);
+    if (ret != 0) {
+        return ret;
+    }
+
+    // handle trivial inputs, the empty assignment is the only one
+    if (nr == 0) {
+        costs[0] = 0;
+        *p_found = 1;
+        return 0;
+    }
+
+    // root problem: plain solve of the real rows, then the dummy rows take
+    // the free columns, which are tight since those have v[j] == 0.
+    murty_workspace root_ws(nc);
+    murty_node root;
+    root.u.assign(nc, 0);
+    root.v.assign(nc, 0);
+    root.col4row.assign(nc, -1);
+    std::fill(root_ws.row4col.begin(), root_ws.row4col.end(), -1);
+    {
+        constrained_matrix2d<T> view{costmat, nr, root_ws.forced_col,
+                                     root_ws.forced_row, root_ws.forbidden};
+        for (intptr_t curRow = 0; curRow < nr; curRow++) {
+            double minVal;
+            intptr_t sink = augmenting_path(nc, view, root.u, root.v, root_ws.path,
+                                            root_ws.row4col, root_ws.shortestPathCosts,
+                                            curRow, root_ws.SR, root_ws.SC,
+                                            root_ws.remaining, &minVal);
+            if (sink < 0) {
+                return RECTANGULAR_LSAP_INFEASIBLE;
+            }
+            augment(nc, nc, curRow, sink, minVal, root.u, root.v,
+                    root_ws.shortestPathCosts, root_ws.path, root.col4row,
+                    root_ws.row4col, root_ws.SR, root_ws.SC);
+        }
+        intptr_t i = nr;
+        for (intptr_t j = 0; j < nc; j++) {
+            if (root_ws.row4col[j] == -1) {
+                root.col4row[i++] = j;
+            }
+        }
+        root.cost = assignment_cost(nr, view, root.col4row);
+    }
+
+    if (n_threads < 1) {
+        n_threads = 1;
+    }
+    std::vector<murty_workspace> workspaces(n_threads, murty_workspace(nc));
+
+    // nodes ordered by cost, ties in creation order
+    std::multimap<double, murty_node> queue;
+    queue.insert(std::make_pair(root.cost, std::move(root)));
+
+    intptr_t found = 0;
+    std::vector<intptr_t> branch;
+    std::vector<murty_node> children;
+    std::vector<char> feasible;
+    while (found < k && !queue.empty()) {
+        murty_node node = std::move(queue.begin()->second);
+        queue.erase(queue.begin());
+
+        // output the assignment, sorted like the plain solve
+        std::vector<intptr_t> col4row(node.col4row.begin(), node.col4row.begin() + nr);
+        write_result(nr, col4row, transpose, subrows, subcols, a + found * nr, b + found * nr);
+        costs[found] = maximize ? -node.cost : node.cost;
+        found++;
+        if (found == k) {
+            break;
+        }
+
+        // partition on the real rows that are not forced yet
+        std::vector<bool> is_forced(nr, false);
+        for (auto& p: node.forced) {
+            is_forced[p.first] = true;
+        }
+        branch.clear();
+        for (intptr_t i = 0; i < nr; i++) {
+            if (!is_forced[i]) {
+                branch.push_back(i);
+            }
+        }
+
+        intptr_t n_children = branch.size();
+        children.assign(n_children, murty_node());
+        feasible.assign(n_children, 0);
+        parallel_for(n_children, n_threads, [&](intptr_t t, intptr_t tid) {
+            feasible[t] = solve_child(nr, nc, costmat, node, branch, t,
+                                      workspaces[tid], children[t]);
+        });
+
+        for (intptr_t t = 0; t < n_children; t++) {
+            if (feasible[t]) {
+                double c = children[t].cost;
+                queue.insert(std::make_pair(c, std::move(children[t])));
+            }
+        }
+
+        // nodes beyond the k - found cheapest can never be reported
+        while ((intptr_t)queue.size() > k - found) {
+            queue.erase(std::prev(queue.end()));
+        }
+    }
+
+    *p_found = found;
+    return 0;
+}
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int k_best_rectangular_linear_sum_assignment_dtype(
+    intptr_t nr, intptr_t nc, void* input_cost, intptr_t dtype, bool maximize,
+    const intptr_t *subrows, intptr_t n_subrows, const intptr_t *subcols, intptr_t n_subcols,
+    intptr_t k, intptr_t n_threads, int64_t* a, int64_t* b, double* costs,
+    intptr_t* p_found)
+{
+    return lsap_validated([&]() -> int {
+        LSAP_DTYPE_SWITCH(dtype, T,
+            return k_best(nr, nc, (const T *)input_cost, maximize,
+                          subrows, n_subrows, subcols, n_subcols,
+                          k, n_threads, a, b, costs, p_found));
+    }(), nr, nc);
+}
+
+#ifdef __cplusplus
+}
+#endif
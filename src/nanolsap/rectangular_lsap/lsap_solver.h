@@ -0,0 +1,108 @@
+/*
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+1. Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following
+   disclaimer in the documentation and/or other materials provided
+   with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived
+   from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef LSAP_SOLVER_H
+#define LSAP_SOLVER_H
+
+#include "rectangular_lsap.h"
+
+/* Version of the C ABI: these functions and the structs of
+   rectangular_lsap.h they take.  It is the SOVERSION of the shared
+   library and changes whenever a struct or signature does, so a program
+   can compare lsap_abi_version() with the LSAP_ABI_VERSION it was
+   compiled with. */
+#define LSAP_ABI_VERSION 2
+
+/* lsap_solver_create flags */
+#define LSAP_SOLVER_STATS 1   /* keep the lsap_stats of every solve */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* lsap_matrix stride of C order: nc items apart for rows, one item for
+   columns.  A stride of 0 is a real one, of a broadcast matrix. */
+#define LSAP_STRIDE_C_ORDER INTPTR_MIN
+
+/* An nr x nc cost matrix of dtype (enum LSAP_TYPES) in memory, entry
+   (i, j) at data + i * row_stride + j * col_stride bytes.  Row major and
+   column major matrices, padded or not, are solved in place by the exact
+   engine; other layouts, such as zero or negative strides, and the other
+   engines work on a contiguous copy kept in the handle. */
+struct lsap_matrix {
+   const void* data;
+   intptr_t dtype;
+   intptr_t nr;
+   intptr_t nc;
+   intptr_t row_stride;
+   intptr_t col_stride;
+};
+
+/* Solver state reused across solves: the arrays of the exact engine keep
+   their capacity, so repeated solves of similar size do not allocate.
+   A handle is not thread safe, use one per thread. */
+typedef struct lsap_solver lsap_solver;
+
+LSAP_API int lsap_abi_version(void);
+
+/* flags is 0 or LSAP_SOLVER_STATS.  NULL if out of memory. */
+LSAP_API lsap_solver* lsap_solver_create(intptr_t flags);
+LSAP_API void lsap_solver_destroy(lsap_solver* solver);
+
+/* lsap_solve_dtype on cost.  a and b receive
+   k pairs, or min(n_rows, n_cols) pairs of the subscripted matrix when
+   k < 0, sorted by row.  Returns RECTANGULAR_LSAP_STRIDE_INVALID when a
+   stride is not a multiple of the item size. */
+LSAP_API int lsap_solver_solve(
+    lsap_solver* solver, const struct lsap_matrix* cost, bool maximize,
+    const intptr_t *subrows, intptr_t n_subrows, const intptr_t *subcols, intptr_t n_subcols,
+    intptr_t k, intptr_t objective, const struct lsap_options* options,
+    int64_t* a, int64_t* b);
+
+/* The stats of the last solve: those of options->stats if it was given,
+   otherwise collected when the handle was created with
+   LSAP_SOLVER_STATS.  RECTANGULAR_LSAP_INVALID if there are none. */
+LSAP_API int lsap_solver_stats(const lsap_solver* solver, struct lsap_stats* stats);
+
+/* Duals of the last solve, one per row (subrows) in u and one per column
+   (subcols) in v: u_i + v_j <= c_ij with equality on the assigned pairs
+   (>= when maximizing), so sum(u) + sum(v) is the optimal cost.  Only
+   full assignments by the exact engines have them,
+   RECTANGULAR_LSAP_INVALID otherwise. */
+LSAP_API int lsap_solver_duals(const lsap_solver* solver, double* u, double* v);
+
+/* Bytes the handle holds for reuse. */
+LSAP_API intptr_t lsap_solver_workspace_bytes(const lsap_solver* solver);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,960 @@
+/*
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+1. Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following
+   disclaimer in the documentation and/or other materials provided
+   with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived
+   from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+Coarse-to-fine assignment of two point sets, with costs given by a metric
+on the points instead of a matrix.  Both sets are split by a k-d tree,
+the leaves at the same depth are the clusters of a level.  The coarsest
+level is a transportation problem between the cluster centroids with the
+cluster sizes as masses, solved by the network simplex.
+
+Every finer level is two deeper, four times as many clusters, down to a
+few points per cluster.  Its column potentials are the c-transform of
+the row potentials of the coarser level, and its candidate arcs are the
+children of the clusters linked by the coarser flow, which admit a full
+transport, and the clusters of lowest reduced cost.  Successive shortest
+paths from these potentials solve it.
+
+The points get the c-transform of the finest cluster potentials, pairs
+along the finest flow, which admit a full assignment, and candidates of
+lowest reduced cost.  The sparse shortest augmenting path solver is
+exact on the candidate graph, and a search of the k-d tree of the
+columns bounded by the potentials finds the pairs of negative reduced
+cost outside of it.  They join the candidates until there are none, so
+the assignment is optimal over all pairs.
+*/
+
+#include <cmath>
+#include <memory>
+#include <numeric>
+#include <queue>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include "rectangular_lsap.h"
+#include "rectangular_lsap_impl.h"
+#include "sparse_solver.h"
+#include "parallel_for.h"
+#include "network_simplex.h"
+
+// least rows per cluster of the finest cluster level
+#define MULTISCALE_CLUSTER_SIZE 4
+
+static double
+point_cost(const double* p, const double* q, intptr_t dim, intptr_t metric)
+{
+    double s = 0;
+    for (intptr_t d = 0; d < dim; d++) {
+        double t = p[d] - q[d];
+        s += t * t;
+    }
+    return metric == LSAP_METRIC_SQEUCLIDEAN ? s : std::sqrt(s);
+}
+
+// Leaves of a k-d tree of the given depth, grouping the points by cluster.
+class kd_clusters {
+public:
+    kd_clusters(const double* x, intptr_t n, intptr_t dim, intptr_t depth)
+            : order(n), start(1, 0), cluster(n) {
+        std::iota(order.begin(), order.end(), 0);
+        // depth first, so clusters close in the tree get close ids
+        std::vector<std::pair<std::pair<intptr_t, intptr_t>, intptr_t> > stack;
+        stack.push_back(std::make_pair(std::make_pair(0, n), 0));
+        while (!stack.empty()) {
+            intptr_t begin = stack.back().first.first;
+            intptr_t end = stack.back().first.second;
+            intptr_t level = stack.back().second;
+            stack.pop_back();
+            if (begin == end) {
+                continue;
+            }
+            if (level == depth || end - begin == 1) {
+                add_cluster(x, dim, begin, end);
+                continue;
+            }
+
+            // split the widest dimension at the median
+            intptr_t axis = 0;
+            double widest = -1;
+            for (intptr_t d = 0; d < dim; d++) {
+                double lo = INFINITY, hi = -INFINITY;
+                for (intptr_t t = begin; t < end; t++) {
+                    double c = x[order[t] * dim + d];
+                    lo = std::min(lo, c);
+                    hi = std::max(hi, c);
+                }
+                if (hi - lo > widest) {
+                    widest = hi - lo;
+                    axis = d;
+                }
+            }
+            intptr_t mid = begin + (end - begin) / 2;
+            std::nth_element(order.begin() + begin, order.begin() + mid, order.begin() + end,
+                             [x, dim, axis](intptr_t a, intptr_t b)
+                             {return x[a * dim + axis] < x[b * dim + axis];});
+            stack.push_back(std::make_pair(std::make_pair(mid, end), level + 1));
+            stack.push_back(std::make_pair(std::make_pair(begin, mid), level + 1));
+        }
+    }
+
+    intptr_t size() const {
+        return start.size() - 1;
+    }
+
+    // the points of cluster c are order[start[c]], ..., order[start[c + 1] - 1]
+    std::vector<intptr_t> order;
+    std::vector<intptr_t> start;
+    std::vector<intptr_t> cluster;
+    std::vector<double> centroid;
+
+private:
+    void add_cluster(const double* x, intptr_t dim, intptr_t begin, intptr_t end) {
+        intptr_t c = size();
+        for (intptr_t d = 0; d < dim; d++) {
+            double s = 0;
+            for (intptr_t t = begin; t < end; t++) {
+                s += x[order[t] * dim + d];
+            }
+            centroid.push_back(s / (end - begin));
+        }
+        for (intptr_t t = begin; t < end; t++) {
+            cluster[order[t]] = c;
+        }
+        start.push_back(end);
+    }
+};
+
+// k-d tree with small leaves for nearest neighbor queries.
+class kd_tree {
+public:
+    kd_tree(const double* x, intptr_t n, intptr_t dim, intptr_t metric)
+            : m_x(x), m_dim(dim), m_metric(metric), m_order(n) {
+        std::iota(m_order.begin(), m_order.end(), 0);
+        if (n > 0) {
+            build(0, n);
+        }
+    }
+
+    // the k nearest points of p, appended to out as (cost, index)
+    void query(const double* p, intptr_t k, std::vector<std::pair<double, intptr_t> >& out,
+               std::vector<std::pair<double, intptr_t> >& heap) const {
+        heap.clear();
+        if (k > 0 && !m_nodes.empty()) {
+            search(0, p, k, heap);
+        }
+        for (auto& e: heap) {
+            out.push_back(std::make_pair(cost(e.first), e.second));
+        }
+    }
+
+    // Set the weights of the points for below, kept by pointer.
+    void set_weights(const double* weight) {
+        m_weight = weight;
+        m_wmax.resize(m_nodes.size());
+        // children come after their parent
+        for (intptr_t id = m_nodes.size() - 1; id >= 0; id--) {
+            const node& nd = m_nodes[id];
+            if (nd.axis < 0) {
+                double w = -INFINITY;
+                for (intptr_t t = nd.begin; t < nd.end; t++) {
+                    w = std::max(w, weight[m_order[t]]);
+                }
+                m_wmax[id] = w;
+            } else {
+                m_wmax[id] = std::max(m_wmax[nd.left], m_wmax[nd.right]);
+            }
+        }
+    }
+
+    // the at most k points j of lowest cost(p, j) - weight[j] below bound,
+    // appended to out as (cost, index)
+    void below(const double* p, intptr_t k, double bound,
+               std::vector<std::pair<double, intptr_t> >& out,
+               std::vector<std::pair<double, intptr_t> >& heap) const {
+        heap.clear();
+        if (k > 0 && !m_nodes.empty()) {
+            search_below(0, p, k, bound, heap);
+        }
+        for (auto& e: heap) {
+            out.push_back(std::make_pair(e.first + m_weight[e.second], e.second));
+        }
+    }
+
+private:
+    struct node {
+        intptr_t begin;
+        intptr_t end;
+        intptr_t axis;      // -1 for a leaf
+        double split;
+        intptr_t left;
+        intptr_t right;
+    };
+
+    double cost(double sq) const {
+        return m_metric == LSAP_METRIC_SQEUCLIDEAN ? sq : std::sqrt(sq);
+    }
+
+    intptr_t build(intptr_t begin, intptr_t end) {
+        intptr_t id = m_nodes.size();
+        m_nodes.push_back(node{begin, end, -1, 0, -1, -1});
+        // bounding box, its widest dimension is split
+        intptr_t axis = 0;
+        double widest = -1;
+        for (intptr_t d = 0; d < m_dim; d++) {
+            double lo = INFINITY, hi = -INFINITY;
+            for (intptr_t t = begin; t < end; t++) {
+                double c = m_x[m_order[t] * m_dim + d];
+                lo = std::min(lo, c);
+                hi = std::max(hi, c);
+            }
+            m_box.push_back(lo);
+            m_box.push_back(hi);
+            if (hi - lo > widest) {
+                widest = hi - lo;
+                axis = d;
+            }
+        }
+        if (end - begin <= 8) {
+            return id;
+        }
+        intptr_t mid = begin + (end - begin) / 2;
+        const double* x = m_x;
+        intptr_t dim = m_dim;
+        std::nth_element(m_order.begin() + begin, m_order.begin() + mid, m_order.begin() + end,
+                         [x, dim, axis](intptr_t a, intptr_t b)
+                         {return x[a * dim + axis] < x[b * dim + axis];});
+        double split = m_x[m_order[mid] * m_dim + axis];
+        intptr_t left = build(begin, mid);
+        intptr_t right = build(mid, end);
+        m_nodes[id].axis = axis;
+        m_nodes[id].split = split;
+        m_nodes[id].left = left;
+        m_nodes[id].right = right;
+        return id;
+    }
+
+    // squared distance of p to the bounding box of node id
+    double box_distance(intptr_t id, const double* p) const {
+        const double* box = &m_box[2 * id * m_dim];
+        double s = 0;
+        for (intptr_t d = 0; d < m_dim; d++) {
+            double t = std::max(box[2 * d] - p[d], p[d] - box[2 * d + 1]);
+            if (t > 0) {
+                s += t * t;
+            }
+        }
+        return s;
+    }
+
+    // heap is a max-heap of (cost - weight, index) of at most k entries
+    // below bound
+    void search_below(intptr_t id, const double* p, intptr_t k, double bound,
+                      std::vector<std::pair<double, intptr_t> >& heap) const {
+        if ((intptr_t)heap.size() == k) {
+            bound = heap.front().first;
+        }
+        if (cost(box_distance(id, p)) - m_wmax[id] >= bound) {
+            return;
+        }
+        const node& nd = m_nodes[id];
+        if (nd.axis < 0) {
+            for (intptr_t t = nd.begin; t < nd.end; t++) {
+                intptr_t j = m_order[t];
+                double r = cost(point_cost(p, m_x + j * m_dim, m_dim, LSAP_METRIC_SQEUCLIDEAN)) -
+                           m_weight[j];
+                if ((intptr_t)heap.size() < k) {
+                    if (r < bound) {
+                        heap.push_back(std::make_pair(r, j));
+                        std::push_heap(heap.begin(), heap.end());
+                    }
+                } else if (r < heap.front().first) {
+                    std::pop_heap(heap.begin(), heap.end());
+                    heap.back() = std::make_pair(r, j);
+                    std::push_heap(heap.begin(), heap.end());
+                }
+            }
+            return;
+        }
+        bool left_first = p[nd.axis] < nd.split;
+        search_below(left_first ? nd.left : nd.right, p, k, bound, heap);
+        search_below(left_first ? nd.right : nd.left, p, k, bound, heap);
+    }
+
+    // heap is a max-heap of (squared distance, index) of at most k entries
+    void search(intptr_t id, const double* p, intptr_t k,
+                std::vector<std::pair<double, intptr_t> >& heap) const {
+        const node& nd = m_nodes[id];
+        if (nd.axis < 0) {
+            for (intptr_t t = nd.begin; t < nd.end; t++) {
+                intptr_t j = m_order[t];
+                double sq = point_cost(p, m_x + j * m_dim, m_dim, LSAP_METRIC_SQEUCLIDEAN);
+                if ((intptr_t)heap.size() < k) {
+                    heap.push_back(std::make_pair(sq, j));
+                    std::push_heap(heap.begin(), heap.end());
+                } else if (sq < heap.front().first) {
+                    std::pop_heap(heap.begin(), heap.end());
+                    heap.back() = std::make_pair(sq, j);
+                    std::push_heap(heap.begin(), heap.end());
+                }
+            }
+            return;
+        }
+        double gap = p[nd.axis] - nd.split;
+        intptr_t near = gap < 0 ? nd.left : nd.right;
+        intptr_t far = gap < 0 ? nd.right : nd.left;
+        search(near, p, k, heap);
+        if ((intptr_t)heap.size() < k || gap * gap < heap.front().first) {
+            search(far, p, k, heap);
+        }
+    }
+
+    const double* m_x;
+    intptr_t m_dim;
+    intptr_t m_metric;
+    std::vector<intptr_t> m_order;
+    std::vector<node> m_nodes;
+    // lowest and highest coordinate of every dimension, by node
+    std::vector<double> m_box;
+    const double* m_weight = nullptr;
+    // largest weight below every node
+    std::vector<double> m_wmax;
+};
+
+// Candidate columns of every row: its n_candidates columns of lowest
+// reduced cost with the weights set on tree_y, the columns it is one of
+// the n_candidates nearest rows of, and its paired column if any.
+static void
+build_candidates(const double* x, intptr_t nx, const double* y, intptr_t ny, intptr_t dim,
+                 intptr_t metric, const kd_tree& tree_x, const kd_tree& tree_y,
+                 const std::vector<intptr_t>& paired, intptr_t n_candidates,
+                 intptr_t n_threads, sparse_cost& cost)
+{
+    typedef std::pair<double, intptr_t> pair;
+    struct scratch {
+        std::vector<pair> near;
+        std::vector<pair> heap;
+    };
+    std::vector<scratch> work(n_threads);
+    intptr_t n_near = n_candidates;
+
+    // the nearest rows of every column, so no column is left out
+    std::vector<pair> reverse(ny * n_near);
+    std::vector<intptr_t> reverse_count(ny);
+    parallel_for(ny, n_threads, [&](intptr_t j, intptr_t tid) {
+        std::vector<pair>& near = work[tid].near;
+        near.clear();
+        tree_x.query(y + j * dim, n_near, near, work[tid].heap);
+        std::copy(near.begin(), near.end(), reverse.begin() + j * n_near);
+        reverse_count[j] = near.size();
+    });
+    std::vector<intptr_t> rptr(nx + 1, 0);
+    for (intptr_t j = 0; j < ny; j++) {
+        for (intptr_t t = 0; t < reverse_count[j]; t++) {
+            rptr[reverse[j * n_near + t].second + 1]++;
+        }
+    }
+    std::partial_sum(rptr.begin(), rptr.end(), rptr.begin());
+    std::vector<pair> by_row(rptr[nx]);
+    std::vector<intptr_t> fill(rptr.begin(), rptr.end() - 1);
+    for (intptr_t j = 0; j < ny; j++) {
+        for (intptr_t t = 0; t < reverse_count[j]; t++) {
+            const pair& e = reverse[j * n_near + t];
+            by_row[fill[e.second]++] = pair(e.first, j);
+        }
+    }
+
+    std::vector<intptr_t> cap(nx + 1, 0);
+    for (intptr_t i = 0; i < nx; i++) {
+        cap[i + 1] = n_near + rptr[i + 1] - rptr[i] + 1;
+    }
+    std::partial_sum(cap.begin(), cap.end(), cap.begin());
+    std::vector<pair> slots(cap[nx]);
+    std::vector<intptr_t> count(nx);
+
+    parallel_for(nx, n_threads, [&](intptr_t i, intptr_t tid) {
+        std::vector<pair>& near = work[tid].near;
+        near.clear();
+        tree_y.below(x + i * dim, n_near, INFINITY, near, work[tid].heap);
+        near.insert(near.end(), by_row.begin() + rptr[i], by_row.begin() + rptr[i + 1]);
+        if (paired[i] >= 0) {
+            intptr_t j = paired[i];
+            near.push_back(std::make_pair(point_cost(x + i * dim, y + j * dim, dim, metric), j));
+        }
+        std::sort(near.begin(), near.end(),
+                  [](const pair& a, const pair& b)
+                  {return a.second < b.second;});
+        intptr_t n = 0;
+        for (intptr_t t = 0; t < (intptr_t)near.size(); t++) {
+            if (t == 0 || near[t].second != near[t - 1].second) {
+                slots[cap[i] + n++] = near[t];
+            }
+        }
+        count[i] = n;
+    });
+
+    cost.nr = nx;
+    cost.nc = ny;
+    cost.indptr.assign(nx + 1, 0);
+    for (intptr_t i = 0; i < nx; i++) {
+        cost.indptr[i + 1] = cost.indptr[i] + count[i];
+    }
+    cost.indices.resize(cost.indptr[nx]);
+    cost.data.resize(cost.indptr[nx]);
+    for (intptr_t i = 0; i < nx; i++) {
+        for (intptr_t t = 0; t < count[i]; t++) {
+            cost.data[cost.indptr[i] + t] = slots[cap[i] + t].first;
+            cost.indices[cost.indptr[i] + t] = slots[cap[i] + t].second;
+        }
+    }
+}
+
+// Append the arcs extra[i], (cost, column), to the rows of cost.
+static void
+add_arcs(sparse_cost& cost, const std::vector<std::vector<std::pair<double, intptr_t> > >& extra)
+{
+    intptr_t nr = cost.nr;
+    std::vector<intptr_t> indptr(nr + 1, 0);
+    for (intptr_t i = 0; i < nr; i++) {
+        indptr[i + 1] = indptr[i] + cost.indptr[i + 1] - cost.indptr[i] + extra[i].size();
+    }
+    std::vector<intptr_t> indices(indptr[nr]);
+    std::vector<double> data(indptr[nr]);
+    for (intptr_t i = 0; i < nr; i++) {
+        intptr_t t = indptr[i];
+        for (intptr_t s = cost.indptr[i]; s < cost.indptr[i + 1]; s++, t++) {
+            indices[t] = cost.indices[s];
+            data[t] = cost.data[s];
+        }
+        for (auto& e: extra[i]) {
+            indices[t] = e.second;
+            data[t++] = e.first;
+        }
+    }
+    cost.indptr.swap(indptr);
+    cost.indices.swap(indices);
+    cost.data.swap(data);
+}
+
+// Solve a level on its candidate graph from the assignment and duals
+// given.  The result is optimal if no pair has a negative reduced cost,
+// the candidates or not: a search of the k-d tree of the columns, bounded
+// by the largest v below every node, finds the columns of lowest reduced
+// cost of every row.  Those below -tol join the candidates and the solve
+// resumes, until none is left.
+static int
+solve_level(const double* x, intptr_t nx, intptr_t dim, kd_tree& tree_y,
+            intptr_t n_candidates, intptr_t n_threads, double tol, sparse_cost& cost,
+            std::vector<double>& u, std::vector<double>& v,
+            std::vector<intptr_t>& col4row, std::vector<intptr_t>& row4col)
+{
+    typedef std::pair<double, intptr_t> pair;
+    sparse_solver solver(cost.nc);
+    std::vector<std::vector<pair> > extra(nx);
+    std::vector<std::vector<pair> > heaps(n_threads);
+    sparse_row_reduction(cost, v, col4row, row4col, 64);
+    for (;;) {
+        int ret = sparse_warm_start(cost, u, v, col4row, row4col);
+        if (ret == 0) {
+            ret = solver.solve_from(cost, u, v, col4row, row4col);
+        }
+        if (ret != 0) {
+            return ret;
+        }
+        tree_y.set_weights(v.data());
+        std::vector<intptr_t> found(n_threads, 0);
+        parallel_for(nx, n_threads, [&](intptr_t i, intptr_t tid) {
+            extra[i].clear();
+            tree_y.below(x + i * dim, n_candidates, u[i] - tol, extra[i], heaps[tid]);
+            found[tid] += extra[i].size();
+        });
+        if (std::accumulate(found.begin(), found.end(), (intptr_t)0) == 0) {
+            return 0;
+        }
+        add_arcs(cost, extra);
+    }
+}
+
+// Successive shortest paths on a sparse transportation problem with
+// integral masses, for the cluster levels.  Only arcs of zero reduced cost
+// c - u - v carry flow, so from a column the search goes on at no cost to
+// the rows shipping to it.
+class sparse_transport {
+public:
+    explicit sparse_transport(const sparse_cost& cost)
+            : m_cost(cost), m_colptr(cost.nc + 1, 0), m_arcs(cost.indptr[cost.nr]),
+            m_row_of(cost.indptr[cost.nr]), m_dist(cost.nc, INFINITY), m_pred(cost.nc, -1),
+            m_done(cost.nc, 0), m_row_dist(cost.nr, INFINITY), m_row_pred(cost.nr, -1) {
+        for (intptr_t t = 0; t < cost.indptr[cost.nr]; t++) {
+            m_colptr[cost.indices[t] + 1]++;
+        }
+        std::partial_sum(m_colptr.begin(), m_colptr.end(), m_colptr.begin());
+        std::vector<intptr_t> fill(m_colptr.begin(), m_colptr.end() - 1);
+        for (intptr_t i = 0; i < cost.nr; i++) {
+            for (intptr_t t = cost.indptr[i]; t < cost.indptr[i + 1]; t++) {
+                m_arcs[fill[cost.indices[t]]++] = t;
+                m_row_of[t] = i;
+            }
+        }
+    }
+
+    // Ship all of supply.  demand is the room left in every column and
+    // flow the flow on every arc, both updated.  u and v must leave no arc
+    // a negative reduced cost.  The rows go in a shuffled order, neighbor
+    // clusters one after the other compete for the same columns; a fixed
+    // seed keeps the solver deterministic.
+    int solve(std::vector<intptr_t> supply, std::vector<intptr_t>& demand,
+              std::vector<double>& u, std::vector<double>& v, std::vector<intptr_t>& flow) {
+        std::vector<intptr_t> order(m_cost.nr);
+        std::iota(order.begin(), order.end(), 0);
+        std::mt19937 rng(0);
+        std::shuffle(order.begin(), order.end(), rng);
+        for (intptr_t i: order) {
+            while (supply[i] > 0) {
+                if (!augment(i, supply, demand, u, v, flow)) {
+                    return RECTANGULAR_LSAP_INFEASIBLE;
+                }
+            }
+        }
+        return 0;
+    }
+
+private:
+    bool augment(intptr_t source, std::vector<intptr_t>& supply, std::vector<intptr_t>& demand,
+                 std::vector<double>& u, std::vector<double>& v, std::vector<intptr_t>& flow) {
+        // (distance, column without room, column), columns with room win ties
+        typedef std::pair<std::pair<double, int>, intptr_t> entry;
+        std::priority_queue<entry, std::vector<entry>, std::greater<entry> > heap;
+        m_rows.clear();
+        m_cols.clear();
+        m_touched.clear();
+
+        intptr_t sink = -1;
+        double minVal = 0;
+        double base = 0;
+        m_row_dist[source] = 0;
+        m_rows.push_back(source);
+        intptr_t scanned = 0;
+        while (true) {
+            for (; scanned < (intptr_t)m_rows.size(); scanned++) {
+                intptr_t i = m_rows[scanned];
+                for (intptr_t t = m_cost.indptr[i]; t < m_cost.indptr[i + 1]; t++) {
+                    intptr_t j = m_cost.indices[t];
+                    if (m_done[j]) {
+                        continue;
+                    }
+                    double r = base + m_cost.data[t] - u[i] - v[j];
+                    if (r < m_dist[j]) {
+                        if (m_dist[j] == INFINITY) {
+                            m_touched.push_back(j);
+                        }
+                        m_dist[j] = r;
+                        m_pred[j] = t;
+                        heap.push(entry(std::make_pair(r, demand[j] > 0 ? 0 : 1), j));
+                    }
+                }
+            }
+
+            intptr_t j = -1;
+            while (!heap.empty() && j < 0) {
+                j = heap.top().second;
+                if (m_done[j] || heap.top().first.first != m_dist[j]) {
+                    j = -1;
+                }
+                heap.pop();
+            }
+            if (j < 0) {
+                break;
+            }
+            m_done[j] = 1;
+            if (demand[j] > 0) {
+                sink = j;
+                minVal = m_dist[j];
+                break;
+            }
+            m_cols.push_back(j);
+            base = m_dist[j];
+            for (intptr_t s = m_colptr[j]; s < m_colptr[j + 1]; s++) {
+                intptr_t t = m_arcs[s];
+                intptr_t i = m_row_of[t];
+                if (flow[t] > 0 && m_row_dist[i] == INFINITY) {
+                    m_row_dist[i] = base;
+                    m_row_pred[i] = t;
+                    m_rows.push_back(i);
+                }
+            }
+        }
+
+        if (sink >= 0) {
+            for (intptr_t i: m_rows) {
+                u[i] += minVal - m_row_dist[i];
+            }
+            for (intptr_t c: m_cols) {
+                v[c] -= minVal - m_dist[c];
+            }
+            // the path alternates forward arcs and arcs of flow backward
+            intptr_t delta = std::min(supply[source], demand[sink]);
+            for (intptr_t i = m_row_of[m_pred[sink]]; i != source; ) {
+                intptr_t t = m_row_pred[i];
+                delta = std::min(delta, flow[t]);
+                i = m_row_of[m_pred[m_cost.indices[t]]];
+            }
+            for (intptr_t j = sink; ; ) {
+                intptr_t t = m_pred[j];
+                flow[t] += delta;
+                intptr_t i = m_row_of[t];
+                if (i == source) {
+                    break;
+                }
+                flow[m_row_pred[i]] -= delta;
+                j = m_cost.indices[m_row_pred[i]];
+            }
+            supply[source] -= delta;
+            demand[sink] -= delta;
+        }
+
+        for (intptr_t j: m_touched) {
+            m_dist[j] = INFINITY;
+            m_pred[j] = -1;
+            m_done[j] = 0;
+        }
+        for (intptr_t i: m_rows) {
+            m_row_dist[i] = INFINITY;
+            m_row_pred[i] = -1;
+        }
+        return sink >= 0;
+    }
+
+    const sparse_cost& m_cost;
+    // the arcs into every column
+    std::vector<intptr_t> m_colptr;
+    std::vector<intptr_t> m_arcs;
+    std::vector<intptr_t> m_row_of;
+    std::vector<double> m_dist;
+    std::vector<intptr_t> m_pred;
+    std::vector<char> m_done;
+    std::vector<double> m_row_dist;
+    std::vector<intptr_t> m_row_pred;
+    std::vector<intptr_t> m_rows;
+    std::vector<intptr_t> m_cols;
+    std::vector<intptr_t> m_touched;
+};
+
+// The potentials of the points y from those of the row clusters cx: the
+// c-transform v[j] = min over p of cost(centroid p, y[j]) - u[p], the
+// largest v that leaves no pair of a centroid and a point a negative
+// reduced cost.
+static void
+c_transform(const kd_clusters& cx, const std::vector<double>& u, const double* y, intptr_t ny,
+            intptr_t dim, intptr_t metric, intptr_t n_threads, std::vector<double>& v)
+{
+    typedef std::pair<double, intptr_t> pair;
+    kd_tree tree(cx.centroid.data(), cx.size(), dim, metric);
+    tree.set_weights(u.data());
+    std::vector<std::vector<pair> > near(n_threads);
+    std::vector<std::vector<pair> > heaps(n_threads);
+    v.resize(ny);
+    parallel_for(ny, n_threads, [&](intptr_t j, intptr_t tid) {
+        near[tid].clear();
+        tree.below(y + j * dim, 1, INFINITY, near[tid], heaps[tid]);
+        v[j] = near[tid][0].first - u[near[tid][0].second];
+    });
+}
+
+// flow between two clusters of a level
+struct cluster_flow {
+    intptr_t p;
+    intptr_t q;
+    intptr_t f;
+};
+
+// Transport between the clusters of a finer level, from the flow and
+// potentials of the coarser one, cx0 and cy0.  The candidate columns of a
+// cluster are the children of the clusters its parent ships to, which
+// admit a full transport, and its n_candidates clusters of lowest reduced
+// cost with the column potentials prolonged by c_transform.  flows, u and
+// v are replaced by those of the finer level.
+static int
+refine_clusters(const kd_clusters& cx0, const kd_clusters& cy0,
+                const kd_clusters& cx, const kd_clusters& cy, intptr_t dim, intptr_t metric,
+                intptr_t n_candidates, intptr_t n_threads, std::vector<cluster_flow>& flows,
+                std::vector<double>& u, std::vector<double>& v)
+{
+    typedef std::pair<double, intptr_t> pair;
+    intptr_t kx = cx.size();
+    intptr_t ky = cy.size();
+    std::vector<intptr_t> parent_x(kx), parent_y(ky);
+    for (intptr_t p = 0; p < kx; p++) {
+        parent_x[p] = cx0.cluster[cx.order[cx.start[p]]];
+    }
+    for (intptr_t q = 0; q < ky; q++) {
+        parent_y[q] = cy0.cluster[cy.order[cy.start[q]]];
+    }
+    std::vector<intptr_t> child_ptr(cy0.size() + 1, 0);
+    for (intptr_t q = 0; q < ky; q++) {
+        child_ptr[parent_y[q] + 1]++;
+    }
+    std::partial_sum(child_ptr.begin(), child_ptr.end(), child_ptr.begin());
+    std::vector<intptr_t> children(ky);
+    std::vector<intptr_t> fill(child_ptr.begin(), child_ptr.end() - 1);
+    for (intptr_t q = 0; q < ky; q++) {
+        children[fill[parent_y[q]]++] = q;
+    }
+    std::vector<std::vector<intptr_t> > links(cx0.size());
+    for (const cluster_flow& e: flows) {
+        links[e.p].push_back(e.q);
+    }
+
+    std::vector<double> pv;
+    c_transform(cx0, u, cy.centroid.data(), ky, dim, metric, n_threads, pv);
+    kd_tree tree_y(cy.centroid.data(), ky, dim, metric);
+    tree_y.set_weights(pv.data());
+    std::vector<std::vector<pair> > near(kx);
+    std::vector<std::vector<pair> > heaps(n_threads);
+    parallel_for(kx, n_threads, [&](intptr_t p, intptr_t tid) {
+        const double* c = &cx.centroid[p * dim];
+        tree_y.below(c, n_candidates, INFINITY, near[p], heaps[tid]);
+        for (intptr_t b: links[parent_x[p]]) {
+            for (intptr_t s = child_ptr[b]; s < child_ptr[b + 1]; s++) {
+                intptr_t q = children[s];
+                near[p].push_back(pair(point_cost(c, &cy.centroid[q * dim], dim, metric), q));
+            }
+        }
+        std::sort(near[p].begin(), near[p].end(),
+                  [](const pair& a, const pair& b)
+                  {return a.second < b.second;});
+        near[p].erase(std::unique(near[p].begin(), near[p].end(),
+                                  [](const pair& a, const pair& b)
+                                  {return a.second == b.second;}),
+                      near[p].end());
+    });
+
+    sparse_cost cost;
+    cost.nr = kx;
+    cost.nc = ky;
+    cost.indptr.assign(kx + 1, 0);
+    for (intptr_t p = 0; p < kx; p++) {
+        cost.indptr[p + 1] = cost.indptr[p] + near[p].size();
+    }
+    for (intptr_t p = 0; p < kx; p++) {
+        for (const pair& e: near[p]) {
+            cost.data.push_back(e.first);
+            cost.indices.push_back(e.second);
+        }
+    }
+
+    // the rows at their cheapest arc
+    u.assign(kx, INFINITY);
+    for (intptr_t p = 0; p < kx; p++) {
+        for (intptr_t t = cost.indptr[p]; t < cost.indptr[p + 1]; t++) {
+            u[p] = std::min(u[p], cost.data[t] - pv[cost.indices[t]]);
+        }
+    }
+    v.swap(pv);
+    std::vector<intptr_t> supply(kx), demand(ky);
+    for (intptr_t p = 0; p < kx; p++) {
+        supply[p] = cx.start[p + 1] - cx.start[p];
+    }
+    for (intptr_t q = 0; q < ky; q++) {
+        demand[q] = cy.start[q + 1] - cy.start[q];
+    }
+    std::vector<intptr_t> flow(cost.indptr[kx], 0);
+    int ret = sparse_transport(cost).solve(supply, demand, u, v, flow);
+    if (ret != 0) {
+        return ret;
+    }
+    flows.clear();
+    for (intptr_t p = 0; p < kx; p++) {
+        for (intptr_t t = cost.indptr[p]; t < cost.indptr[p + 1]; t++) {
+            if (flow[t] > 0) {
+                flows.push_back(cluster_flow{p, cost.indices[t], flow[t]});
+            }
+        }
+    }
+    return 0;
+}
+
+static int
+multiscale(intptr_t nx, intptr_t ny, intptr_t dim, const double* x, const double* y,
+           intptr_t metric, intptr_t n_candidates, intptr_t max_clusters, intptr_t n_threads,
+           int64_t* a, int64_t* b)
+{
+    // handle trivial inputs
+    if (nx == 0 || ny == 0) {
+        return 0;
+    }
+    if (metric != LSAP_METRIC_EUCLIDEAN && metric != LSAP_METRIC_SQEUCLIDEAN) {
+        return RECTANGULAR_LSAP_METRIC_INVALID;
+    }
+    for (intptr_t t = 0; t < nx * dim; t++) {
+        if (!std::isfinite(x[t])) {
+            return RECTANGULAR_LSAP_INVALID;
+        }
+    }
+    for (intptr_t t = 0; t < ny * dim; t++) {
+        if (!std::isfinite(y[t])) {
+            return RECTANGULAR_LSAP_INVALID;
+        }
+    }
+
+    // the rows must be the smaller set
+    bool transpose = ny < nx;
+    if (transpose) {
+        std::swap(x, y);
+        std::swap(nx, ny);
+    }
+
+    // the rows in a shuffled order for the same reason as in
+    // sparse_transport, point sets often come sorted
+    std::vector<intptr_t> perm(nx);
+    std::iota(perm.begin(), perm.end(), 0);
+    std::mt19937 rng(0);
+    std::shuffle(perm.begin(), perm.end(), rng);
+    std::vector<double> shuffled(nx * dim);
+    for (intptr_t i = 0; i < nx; i++) {
+        std::copy(x + perm[i] * dim, x + (perm[i] + 1) * dim, shuffled.begin() + i * dim);
+    }
+    x = shuffled.data();
+
+    // depth of the coarsest level, every finer one is two deeper
+    intptr_t depth = 0;
+    while ((intptr_t)2 << depth <= std::max<intptr_t>(max_clusters, 1)) {
+        depth++;
+    }
+    std::unique_ptr<kd_clusters> cx(new kd_clusters(x, nx, dim, depth));
+    std::unique_ptr<kd_clusters> cy(new kd_clusters(y, ny, dim, depth));
+    intptr_t kx = cx->size();
+    intptr_t ky = cy->size();
+
+    // coarsest level, sizes of the clusters moved between their centroids
+    std::vector<double> coarse(kx * ky);
+    double max_cost = 0;
+    for (intptr_t p = 0; p < kx; p++) {
+        for (intptr_t q = 0; q < ky; q++) {
+            double c = point_cost(&cx->centroid[p * dim], &cy->centroid[q * dim], dim, metric);
+            coarse[p * ky + q] = c;
+            max_cost = std::max(max_cost, c);
+        }
+    }
+    matrix2d<double> coarsemat{coarse.data(), kx, ky};
+    bool dummy_row = nx < ny;
+    network_simplex<matrix2d<double> > ns(coarsemat, kx, ky, dummy_row, false, 0);
+    ns.set_eps(1e-12 * (max_cost + 1));
+    std::vector<double> supply(kx), demand(ky);
+    for (intptr_t p = 0; p < kx; p++) {
+        supply[p] = cx->start[p + 1] - cx->start[p];
+    }
+    for (intptr_t q = 0; q < ky; q++) {
+        demand[q] = cy->start[q + 1] - cy->start[q];
+    }
+    if (dummy_row) {
+        supply.push_back(ny - nx);
+    }
+    ns.init(supply, demand);
+    ns.run(-1);
+    std::vector<cluster_flow> flows;
+    for (intptr_t node = 0; node < ns.R() + ns.C(); node++) {
+        intptr_t parent = ns.parent[node];
+        if (parent < 0 || !(ns.flow[node] > 0)) {
+            continue;
+        }
+        intptr_t p = node < ns.R() ? node : parent;
+        intptr_t q = (node < ns.R() ? parent : node) - ns.R();
+        if (p < kx) {
+            flows.push_back(cluster_flow{p, q, (intptr_t)std::llround(ns.flow[node])});
+        }
+    }
+    std::vector<double> u(ns.pot.begin(), ns.pot.begin() + kx);
+    std::vector<double> v(ns.pot.begin() + ns.R(), ns.pot.end());
+
+    // finer cluster levels down to MULTISCALE_CLUSTER_SIZE rows per cluster
+    while (((intptr_t)4 << depth) * MULTISCALE_CLUSTER_SIZE <= nx) {
+        depth += 2;
+        std::unique_ptr<kd_clusters> fx(new kd_clusters(x, nx, dim, depth));
+        std::unique_ptr<kd_clusters> fy(new kd_clusters(y, ny, dim, depth));
+        int ret = refine_clusters(*cx, *cy, *fx, *fy, dim, metric, n_candidates, n_threads,
+                                  flows, u, v);
+        if (ret != 0) {
+            return ret;
+        }
+        cx.swap(fx);
+        cy.swap(fy);
+    }
+
+    // The flow is integral, pairing the points of the clusters along it in
+    // order gives a full assignment among the candidates.
+    std::vector<intptr_t> paired(nx, -1);
+    std::vector<intptr_t> next_x(cx->start.begin(), cx->start.end() - 1);
+    std::vector<intptr_t> next_y(cy->start.begin(), cy->start.end() - 1);
+    for (const cluster_flow& e: flows) {
+        for (intptr_t f = e.f; f > 0; f--) {
+            if (next_x[e.p] < cx->start[e.p + 1] && next_y[e.q] < cy->start[e.q + 1]) {
+                paired[cx->order[next_x[e.p]++]] = cy->order[next_y[e.q]++];
+            }
+        }
+    }
+    c_transform(*cx, u, y, ny, dim, metric, n_threads, v);
+    u.assign(nx, 0);
+
+    // finest level on the candidate graph
+    kd_tree tree_x(x, nx, dim, metric);
+    kd_tree tree_y(y, ny, dim, metric);
+    tree_y.set_weights(v.data());
+    sparse_cost cost;
+    build_candidates(x, nx, y, ny, dim, metric, tree_x, tree_y, paired, n_candidates,
+                     n_threads, cost);
+    std::vector<intptr_t> col4row(nx, -1);
+    std::vector<intptr_t> row4col(ny, -1);
+    int ret = solve_level(x, nx, dim, tree_y, n_candidates, n_threads, 1e-9 * (max_cost + 1),
+                          cost, u, v, col4row, row4col);
+    if (ret != 0) {
+        return ret;
+    }
+    std::vector<intptr_t> result(nx);
+    for (intptr_t i = 0; i < nx; i++) {
+        result[perm[i]] = col4row[i];
+    }
+    return write_result(nx, result, transpose, nullptr, nullptr, a, b);
+}
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int multiscale_rectangular_linear_sum_assignment(
+    intptr_t nx, intptr_t ny, intptr_t dim, const double* x, const double* y,
+    intptr_t metric, intptr_t n_candidates, intptr_t max_clusters, intptr_t n_threads,
+    int64_t* a, int64_t* b)
+{
+    return lsap_validated(multiscale(nx, ny, dim, x, y, metric, n_candidates, max_clusters,
+                                     std::max<intptr_t>(n_threads, 1), a, b), nx, ny);
+}
+
+#ifdef __cplusplus
+}
+#endif
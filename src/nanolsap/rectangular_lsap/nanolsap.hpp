@@ -0,0 +1,218 @@
+/*
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+1. Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following
+   disclaimer in the documentation and/or other materials provided
+   with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived
+   from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+Header-only C++ interface of the exact solver.  nanolsap::solve takes the
+costs from any Accessor with
+
+    double get(intptr_t i, intptr_t j) const;     // any arithmetic type
+
+and, optionally,
+
+    const T* row(intptr_t i) const;   // the nc entries of row i
+
+which the scan of the shortest path search then reads directly.  The
+transposition of tall matrices and the negation when maximizing are
+template parameters of the view, so the scan compiles to the accessor
+itself, without dtype switch or virtual call.  Nothing needs linking.
+*/
+
+#ifndef NANOLSAP_HPP
+#define NANOLSAP_HPP
+
+// the semaphores of the USDT probes are defined by the library
+#ifndef NANOLSAP_NO_USDT
+#define NANOLSAP_NO_USDT
+#endif
+
+#include <cmath>
+#include <vector>
+#include <utility>
+#include <type_traits>
+#include "rectangular_lsap.h"
+#include "rectangular_lsap_impl.h"
+
+namespace nanolsap {
+
+// A row major matrix of T with rows stride entries apart, such as the
+// data() and outerStride() of a row major Eigen::Map.
+template <typename T> class dense_accessor {
+public:
+    dense_accessor(const T* data, intptr_t stride) : m_data(data), m_stride(stride) {
+    }
+    T get(intptr_t i, intptr_t j) const {
+        return m_data[i * m_stride + j];
+    }
+    const T* row(intptr_t i) const {
+        return m_data + i * m_stride;
+    }
+private:
+    const T* m_data;
+    intptr_t m_stride;
+};
+
+// Costs computed by f(i, j), a lambda for instance.
+template <typename F> class function_accessor {
+public:
+    explicit function_accessor(F f) : m_f(f) {
+    }
+    double get(intptr_t i, intptr_t j) const {
+        return m_f(i, j);
+    }
+private:
+    F m_f;
+};
+
+template <typename F> function_accessor<F>
+make_accessor(F f)
+{
+    return function_accessor<F>(f);
+}
+
+namespace detail {
+
+template <typename A> class has_row {
+    template <typename B> static auto test(int)
+        -> decltype(std::declval<const B&>().row(intptr_t(0)), std::true_type());
+    template <typename B> static std::false_type test(...);
+public:
+    static const bool value = decltype(test<A>(0))::value;
+};
+
+// Entry (i, j) of A, through row(i) when A has it.
+template <typename A> double
+entry(const A& cost, intptr_t i, intptr_t j, std::true_type)
+{
+    return static_cast<double>(cost.row(i)[j]);
+}
+
+template <typename A> double
+entry(const A& cost, intptr_t i, intptr_t j, std::false_type)
+{
+    return static_cast<double>(cost.get(i, j));
+}
+
+// The view the solver works on: transposed so that nr <= nc and negated
+// when maximizing.  Row spans are used when A has them and the view is not
+// transposed, row(i) is then invariant in the scan of row i.
+template <typename A, bool Transpose, bool Negate>
+class accessor_view {
+public:
+    explicit accessor_view(const A& cost) : m_cost(cost) {
+    }
+    double get(intptr_t i, intptr_t j) const {
+        typedef std::integral_constant<bool, has_row<A>::value && !Transpose> row;
+        double c = Transpose ? entry(m_cost, j, i, row()) : entry(m_cost, i, j, row());
+        return Negate ? -c : c;
+    }
+private:
+    const A& m_cost;
+};
+
+// RECTANGULAR_LSAP_INVALID for NaN and -inf entries (+inf when maximizing)
+template <typename A> int
+check_accessor(const A& cost, intptr_t nr, intptr_t nc, bool maximize)
+{
+    double forbidden = maximize ? INFINITY : -INFINITY;
+    for (intptr_t i = 0; i < nr; i++) {
+        for (intptr_t j = 0; j < nc; j++) {
+            double c = static_cast<double>(cost.get(i, j));
+            if (c != c || c == forbidden) {
+                return RECTANGULAR_LSAP_INVALID;
+            }
+        }
+    }
+    return 0;
+}
+
+template <typename V> int
+solve_accessor(intptr_t nr, intptr_t nc, const V& view, bool transpose, bool maximize,
+               int64_t* a, int64_t* b, double* u, double* v)
+{
+    std::vector<double> du(nr, 0);
+    std::vector<double> dv(nc, 0);
+    std::vector<intptr_t> col4row(nr, -1);
+    std::vector<intptr_t> row4col(nc, -1);
+    int ret = solve_from(nr, nc, view, du, dv, col4row, row4col);
+    if (ret != 0) {
+        return ret;
+    }
+    write_result(nr, col4row, transpose, nullptr, nullptr, a, b);
+    if (u != nullptr && v != nullptr) {
+        double sign = maximize ? -1 : 1;
+        const std::vector<double>& ru = transpose ? dv : du;
+        const std::vector<double>& rv = transpose ? du : dv;
+        for (size_t i = 0; i < ru.size(); i++) {
+            u[i] = sign * ru[i];
+        }
+        for (size_t j = 0; j < rv.size(); j++) {
+            v[j] = sign * rv[j];
+        }
+    }
+    return 0;
+}
+
+} // namespace detail
+
+// Assign min(nr, nc) pairs of the nr x nc costs of cost at the smallest
+// (largest when maximizing) total, as solve_rectangular_linear_sum_assignment
+// does: a and b receive the pairs sorted by row, and the return value is 0
+// or an RECTANGULAR_LSAP_* error.  All entries are checked first.  When u
+// and v are not nullptr they receive the nr and nc duals, u_i + v_j <= c_ij
+// with equality on the pairs (>= when maximizing).
+template <typename Accessor> int
+solve(const Accessor& cost, intptr_t nr, intptr_t nc, int64_t* a, int64_t* b,
+      bool maximize = false, double* u = nullptr, double* v = nullptr)
+{
+    if (nr == 0 || nc == 0) {
+        return 0;
+    }
+    int ret = detail::check_accessor(cost, nr, nc, maximize);
+    if (ret != 0) {
+        return ret;
+    }
+    if (nc < nr) {
+        if (maximize) {
+            detail::accessor_view<Accessor, true, true> view(cost);
+            return detail::solve_accessor(nc, nr, view, true, true, a, b, u, v);
+        }
+        detail::accessor_view<Accessor, true, false> view(cost);
+        return detail::solve_accessor(nc, nr, view, true, false, a, b, u, v);
+    }
+    if (maximize) {
+        detail::accessor_view<Accessor, false, true> view(cost);
+        return detail::solve_accessor(nr, nc, view, false, true, a, b, u, v);
+    }
+    detail::accessor_view<Accessor, false, false> view(cost);
+    return detail::solve_accessor(nr, nc, view, false, false, a, b, u, v);
+}
+
+} // namespace nanolsap
+
+#endif
@@ -0,0 +1,338 @@
+/*
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+1. Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following
+   disclaimer in the documentation and/or other materials provided
+   with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived
+   from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+Primal network simplex for the transportation problem on a dense
+bipartite graph, shared by transport() and the coarse levels of the
+multiscale solver.  Not part of the public interface.
+*/
+
+#ifndef NETWORK_SIMPLEX_H
+#define NETWORK_SIMPLEX_H
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+
+// Nodes 0..R-1 are rows (supplies), R..R+C-1 are columns (demands).  Arcs
+// always go from a row to a column and have no capacity.  Infinite entries
+// are kept out of the pricing and cost a large penalty in the tree.
+//
+// The tree is kept strongly feasible: rooted at a row, every arc of zero
+// flow points away from the root, so it hangs a column below a row.  The
+// leaving arc rule of pivot preserves this, and with it no degenerate
+// pivot repeats a tree, so run terminates (Cunningham 1976).  Rows and
+// columns of zero mass carry no flow and are left out of the tree and the
+// pricing, as no strongly feasible tree can hold two of them.
+template <typename M> class network_simplex {
+    const M& m_cost;
+    intptr_t m_nr;
+    intptr_t m_nc;
+    intptr_t m_R;
+    intptr_t m_C;
+    intptr_t m_N;
+    double m_penalty;
+    double m_eps = 0;
+
+public:
+    network_simplex(const M& cost, intptr_t nr, intptr_t nc, bool dummy_row, bool dummy_col,
+                    double penalty)
+            : m_cost(cost), m_nr(nr), m_nc(nc),
+            m_R(nr + dummy_row), m_C(nc + dummy_col), m_N(m_R + m_C),
+            m_penalty(penalty),
+            parent(m_N, -1), flow(m_N, 0), pot(m_N, 0), depth(m_N, 0),
+            first_child(m_N, -1), next_sibling(m_N, -1), prev_sibling(m_N, -1),
+            m_stack(m_N) {
+    }
+
+    // entry of the extended matrix, the dummy row and column cost nothing
+    double arc_cost(intptr_t i, intptr_t j) const {
+        if (i >= m_nr || j >= m_nc) {
+            return 0;
+        }
+        double c = m_cost.get(i, j);
+        return c == INFINITY ? m_penalty : c;
+    }
+
+    bool arc_forbidden(intptr_t i, intptr_t j) const {
+        return i < m_nr && j < m_nc && m_cost.get(i, j) == INFINITY;
+    }
+
+    // North-west corner rule over the rows and columns of positive mass,
+    // every step adds one node to a chain.  When a row and a column run out
+    // together the next column comes first: its arc of zero flow hangs
+    // below the row, and the next row then gets a positive flow, so the
+    // tree starts strongly feasible.
+    void init(std::vector<double> supply, std::vector<double> demand) {
+        m_rows.clear();
+        m_cols.clear();
+        for (intptr_t i = 0; i < m_R; i++) {
+            if (supply[i] > 0) {
+                m_rows.push_back(i);
+            }
+        }
+        for (intptr_t j = 0; j < m_C; j++) {
+            if (demand[j] > 0) {
+                m_cols.push_back(j);
+            }
+        }
+        if (m_rows.empty() || m_cols.empty()) {
+            return;
+        }
+        intptr_t n_rows = m_rows.size();
+        intptr_t n_cols = m_cols.size();
+        intptr_t ip = 0, jp = 0;
+        intptr_t child = m_R + m_cols[0], par = m_rows[0];
+        for (;;) {
+            intptr_t i = m_rows[ip], j = m_cols[jp];
+            double f = std::min(supply[i], demand[j]);
+            supply[i] -= f;
+            demand[j] -= f;
+            link(child, par, f);
+            if (ip == n_rows - 1 && jp == n_cols - 1) {
+                // rounding leftovers of the totals are dropped here
+                break;
+            }
+            if (jp < n_cols - 1 && (supply[i] > 0 || !(demand[j] > 0) || ip == n_rows - 1)) {
+                jp++;
+                child = m_R + m_cols[jp];
+                par = i;
+            } else {
+                ip++;
+                child = m_rows[ip];
+                par = m_R + j;
+            }
+        }
+        compute_potentials();
+    }
+
+    // Run the simplex, returns the number of pivots or -1 at max_iter.
+    intptr_t run(intptr_t max_iter) {
+        // arcs are priced by their positions in m_rows and m_cols
+        const intptr_t n_rows = m_rows.size();
+        const intptr_t n_cols = m_cols.size();
+        const intptr_t n_arcs = n_rows * n_cols;
+        intptr_t block = std::max<intptr_t>((intptr_t)std::sqrt((double)n_arcs), 10);
+        intptr_t next = 0;
+        intptr_t iter = 0;
+        for (;;) {
+            // block search for the most negative reduced cost
+            double best = -m_eps;
+            intptr_t best_arc = -1;
+            intptr_t scanned = 0;
+            intptr_t cnt = 0;
+            intptr_t ip = n_cols > 0 ? next / n_cols : 0;
+            intptr_t jp = n_cols > 0 ? next % n_cols : 0;
+            while (scanned < n_arcs) {
+                intptr_t i = m_rows[ip], j = m_cols[jp];
+                if (!arc_forbidden(i, j)) {
+                    double rc = arc_cost(i, j) - pot[i] - pot[m_R + j];
+                    if (rc < best) {
+                        best = rc;
+                        best_arc = i * m_C + j;
+                    }
+                }
+                scanned++;
+                cnt++;
+                if (++jp == n_cols) {
+                    jp = 0;
+                    if (++ip == n_rows) {
+                        ip = 0;
+                    }
+                }
+                if (cnt == block) {
+                    if (best_arc >= 0) {
+                        break;
+                    }
+                    cnt = 0;
+                }
+            }
+            if (best_arc < 0) {
+                return iter;
+            }
+            if (max_iter >= 0 && iter >= max_iter) {
+                return -1;
+            }
+            next = ip * n_cols + jp;
+            pivot(best_arc / m_C, m_R + best_arc % m_C);
+            iter++;
+        }
+    }
+
+    void set_eps(double eps) {
+        m_eps = eps;
+    }
+
+    intptr_t R() const { return m_R; }
+    intptr_t C() const { return m_C; }
+
+    std::vector<intptr_t> parent;
+    // flow on the arc between a node and its parent
+    std::vector<double> flow;
+    // u of the rows and v of the columns, c - u - v is 0 on tree arcs
+    std::vector<double> pot;
+    std::vector<intptr_t> depth;
+
+private:
+    void link(intptr_t x, intptr_t p, double f) {
+        parent[x] = p;
+        flow[x] = f;
+        prev_sibling[x] = -1;
+        next_sibling[x] = first_child[p];
+        if (first_child[p] >= 0) {
+            prev_sibling[first_child[p]] = x;
+        }
+        first_child[p] = x;
+    }
+
+    void unlink(intptr_t x) {
+        intptr_t p = parent[x];
+        if (prev_sibling[x] >= 0) {
+            next_sibling[prev_sibling[x]] = next_sibling[x];
+        } else {
+            first_child[p] = next_sibling[x];
+        }
+        if (next_sibling[x] >= 0) {
+            prev_sibling[next_sibling[x]] = prev_sibling[x];
+        }
+        parent[x] = -1;
+    }
+
+    // cost of the arc between x and its parent
+    double tree_arc_cost(intptr_t x) const {
+        intptr_t p = parent[x];
+        return x < m_R ? arc_cost(x, p - m_R) : arc_cost(p, x - m_R);
+    }
+
+    // set potentials and depths of the subtree of root from its parent
+    void update_subtree(intptr_t root) {
+        intptr_t top = 0;
+        m_stack[top++] = root;
+        while (top > 0) {
+            intptr_t x = m_stack[--top];
+            intptr_t p = parent[x];
+            if (p >= 0) {
+                pot[x] = tree_arc_cost(x) - pot[p];
+                depth[x] = depth[p] + 1;
+            }
+            for (intptr_t c = first_child[x]; c >= 0; c = next_sibling[c]) {
+                m_stack[top++] = c;
+            }
+        }
+    }
+
+    void compute_potentials() {
+        intptr_t root = m_rows[0];
+        pot[root] = 0;
+        depth[root] = 0;
+        update_subtree(root);
+    }
+
+    // bring the entering arc (i, j) into the tree
+    void pivot(intptr_t i, intptr_t j) {
+        // find the apex of the cycle
+        intptr_t a = i, b = j;
+        while (a != b) {
+            if (depth[a] >= depth[b]) {
+                a = parent[a];
+            } else {
+                b = parent[b];
+            }
+        }
+        intptr_t join = a;
+
+        // Flow goes i -> j, then from j up to the apex and down to i.
+        // Walking up from a row on the j side or from a column on the i
+        // side follows an arc backwards, those arcs lose flow.  Ties prefer
+        // the last blocking arc after the apex: the j side, near the apex.
+        double delta = INFINITY;
+        intptr_t out = -1;
+        bool out_on_j_side = false;
+        for (intptr_t x = i; x != join; x = parent[x]) {
+            if (x < m_R && flow[x] < delta) {
+                delta = flow[x];
+                out = x;
+            }
+        }
+        for (intptr_t x = j; x != join; x = parent[x]) {
+            if (x >= m_R && flow[x] <= delta) {
+                delta = flow[x];
+                out = x;
+                out_on_j_side = true;
+            }
+        }
+
+        // augment along the cycle
+        if (delta > 0) {
+            for (intptr_t x = i; x != join; x = parent[x]) {
+                flow[x] += x < m_R ? -delta : delta;
+            }
+            for (intptr_t x = j; x != join; x = parent[x]) {
+                flow[x] += x >= m_R ? -delta : delta;
+            }
+        }
+
+        // The subtree below the leaving arc contains w, one end of the
+        // entering arc.  Reverse the path from w to out and hang it below
+        // the other end o.
+        intptr_t w = out_on_j_side ? j : i;
+        intptr_t o = out_on_j_side ? i : j;
+        intptr_t x = w;
+        intptr_t new_parent = o;
+        double new_flow = delta;
+        while (true) {
+            intptr_t old_parent = parent[x];
+            double old_flow = flow[x];
+            bool done = (x == out);
+            unlink(x);
+            link(x, new_parent, new_flow);
+            if (done) {
+                break;
+            }
+            new_parent = x;
+            new_flow = old_flow;
+            x = old_parent;
+        }
+
+        // the moved subtree hangs below the entering arc now
+        update_subtree(w);
+    }
+
+    std::vector<intptr_t> first_child;
+    std::vector<intptr_t> next_sibling;
+    std::vector<intptr_t> prev_sibling;
+    std::vector<intptr_t> m_stack;
+    // the rows and columns of positive mass, in the tree
+    std::vector<intptr_t> m_rows;
+    std::vector<intptr_t> m_cols;
+};
+
+#endif
@@ -0,0 +1,76 @@
+/*
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+1. Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following
+   disclaimer in the documentation and/or other materials provided
+   with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived
+   from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+/*
+The thread pool of the engines that split a pass over the rows.  Not
+part of the public interface.
+*/
+
+#ifndef PARALLEL_FOR_H
+#define PARALLEL_FOR_H
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include <system_error>
+
+// Run fn(item, thread_id) for every item in [0, n) on up to n_threads
+// threads, the calling thread included.  thread_id < n_threads indexes
+// per thread scratch space.
+template <typename F> static void
+parallel_for(intptr_t n, intptr_t n_threads, F fn)
+{
+    if (n_threads > n) {
+        n_threads = n;
+    }
+    std::atomic<intptr_t> next(0);
+    auto worker = [&](intptr_t tid) {
+        for (intptr_t item = next++; item < n; item = next++) {
+            fn(item, tid);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (intptr_t tid = 1; tid < n_threads; tid++) {
+        try {
+            threads.emplace_back(worker, tid);
+        } catch (const std::system_error&) {
+            // run with the threads we got
+            break;
+        }
+    }
+    worker(0);
+    for (auto& t: threads) {
+        t.join();
+    }
+}
+
+#endif
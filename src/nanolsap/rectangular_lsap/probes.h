@@ -0,0 +1,111 @@
+/*
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+1. Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following
+   disclaimer in the documentation and/or other materials provided
+   with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived
+   from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+/*
+USDT probes of the nanolsap provider, for bpftrace, perf or systemtap on a
+running process:
+
+  solve__start(nr, nc, dtype, k, method)   a linear sum assignment begins
+  solve__end(ret, nr, nc)                   and returns ret
+  dispatch(engine, reason)                  the engine chosen, as in lsap_stats
+  validation__fail(ret, nr, nc)             any entry point rejected the input
+  augment(row, column, path_length)         one shortest augmenting path,
+                                            in the indices of the solved view
+
+e.g. bpftrace -e 'usdt:_lsap.abi3.so:nanolsap:augment { @len = hist(arg2); }'
+
+A probe is a single nop with a note in the ELF file when nothing is
+attached.  Arguments that cost work to compute are guarded by
+LSAP_PROBE_ENABLED, which reads the semaphore the tracer raises.  The
+probes compile to nothing without <sys/sdt.h> or with NANOLSAP_NO_USDT.
+*/
+
+#ifndef RECTANGULAR_LSAP_PROBES_H
+#define RECTANGULAR_LSAP_PROBES_H
+
+#include "rectangular_lsap.h"
+
+#if !defined(NANOLSAP_NO_USDT) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#define NANOLSAP_USDT 1
+#endif
+#endif
+
+#ifdef NANOLSAP_USDT
+
+#define _SDT_HAS_SEMAPHORES 1
+#include <sys/sdt.h>
+
+// defined in rectangular_lsap.cpp
+#define LSAP_PROBE_SEMAPHORE(name) nanolsap_##name##_semaphore
+extern unsigned short LSAP_PROBE_SEMAPHORE(solve__start);
+extern unsigned short LSAP_PROBE_SEMAPHORE(solve__end);
+extern unsigned short LSAP_PROBE_SEMAPHORE(dispatch);
+extern unsigned short LSAP_PROBE_SEMAPHORE(validation__fail);
+extern unsigned short LSAP_PROBE_SEMAPHORE(augment);
+
+#define LSAP_PROBE_ENABLED(name) __builtin_expect(LSAP_PROBE_SEMAPHORE(name) != 0, 0)
+#define LSAP_PROBE2(name, a1, a2) DTRACE_PROBE2(nanolsap, name, a1, a2)
+#define LSAP_PROBE3(name, a1, a2, a3) DTRACE_PROBE3(nanolsap, name, a1, a2, a3)
+#define LSAP_PROBE5(name, a1, a2, a3, a4, a5) \
+    DTRACE_PROBE5(nanolsap, name, a1, a2, a3, a4, a5)
+
+#else
+
+// the arguments are used but not evaluated, as unused parameters would
+// warn only without USDT
+#define LSAP_PROBE_ENABLED(name) false
+#define LSAP_PROBE2(name, a1, a2) \
+    do { (void)sizeof(a1); (void)sizeof(a2); } while (0)
+#define LSAP_PROBE3(name, a1, a2, a3) \
+    do { (void)sizeof(a1); (void)sizeof(a2); (void)sizeof(a3); } while (0)
+#define LSAP_PROBE5(name, a1, a2, a3, a4, a5) \
+    do { \
+        (void)sizeof(a1); (void)sizeof(a2); (void)sizeof(a3); (void)sizeof(a4); \
+        (void)sizeof(a5); \
+    } while (0)
+
+#endif
+
+// Fire validation__fail if ret rejects the input, every error code but an
+// infeasible matrix and an exhausted iteration limit, and return ret.  Each
+// entry point of the C ABI returns through it once.
+static inline int
+lsap_validated(int ret, intptr_t nr, intptr_t nc)
+{
+    if (ret != 0 && ret != RECTANGULAR_LSAP_INFEASIBLE &&
+        ret != RECTANGULAR_LSAP_ITERATION_LIMIT) {
+        LSAP_PROBE3(validation__fail, ret, nr, nc);
+    }
+    return ret;
+}
+
+#endif
@@ -41,330 +41,598 @@ Author: PM Larsen
 */
 
 #include <cmath>
+#include <atomic>
 #include <vector>
-#include <numeric>
+#include <limits>
 #include <algorithm>
 #include "rectangular_lsap.h"
+#include "rectangular_lsap_impl.h"
+#include "sparse_solver.h"
+
+// entries sampled by method='auto'
+#define AUTO_SAMPLES 4096
+// adjacent row pairs compared by method='auto'
+#define AUTO_ROW_PAIRS 32
+// densest view the sparse solver is used for, until tuned
+#define AUTO_SPARSE_DENSITY 0.2
+// entries per thread of the parallel passes, until tuned
+#define ENTRIES_PER_THREAD 16384
+
+// lsap_tuning, read by concurrent solves
+static std::atomic<double> tuned_sparse_density(AUTO_SPARSE_DENSITY);
+static std::atomic<intptr_t> tuned_entries_per_thread(ENTRIES_PER_THREAD);
+
+#ifdef NANOLSAP_USDT
+// raised by a tracer attached to the probe, see probes.h
+#define LSAP_DEFINE_SEMAPHORE(name) \
+    unsigned short LSAP_PROBE_SEMAPHORE(name) __attribute__((section(".probes")))
+LSAP_DEFINE_SEMAPHORE(solve__start);
+LSAP_DEFINE_SEMAPHORE(solve__end);
+LSAP_DEFINE_SEMAPHORE(dispatch);
+LSAP_DEFINE_SEMAPHORE(validation__fail);
+LSAP_DEFINE_SEMAPHORE(augment);
+#endif
 
-template <typename T> class matrix2d {
-public:
-    matrix2d(const T *d, intptr_t nr, intptr_t nc)
-            : m_d(d), m_nr(nr), m_nc(nc),
-            m_transpose(false), m_negative(false),
-            m_subrows(nullptr), m_subcols(nullptr)  {
+intptr_t
+tuned_threads(intptr_t n_threads, intptr_t entries)
+{
+    intptr_t useful = entries / tuned_entries_per_thread.load(std::memory_order_relaxed);
+    return std::max<intptr_t>(std::min(n_threads, useful), 1);
+}
+
+// Record the engine chosen, for stats and the dispatch probe.
+static void
+set_stats(struct lsap_stats* stats, const char* engine, const char* reason)
+{
+    LSAP_PROBE2(dispatch, engine, reason);
+    if (stats != nullptr) {
+        stats->engine = engine;
+        stats->reason = reason;
     }
-    double get(intptr_t i, intptr_t j) const {
-        double r;
-        if (this->m_transpose) {
-            std::swap(i, j);
-        }
-        if (this->m_subrows != nullptr) {
-            i = this->m_subrows[i];
+}
+
+static void
+clear_stats(struct lsap_stats* stats)
+{
+    if (stats != nullptr) {
+        *stats = lsap_stats();
+        stats->engine = "";
+        stats->reason = "";
+        stats->density = NAN;
+    }
+}
+
+// The fraction of finite entries of the view, estimated from a fixed
+// pseudo random sample.
+template <typename M> static double
+sample_density(intptr_t nr, intptr_t nc, const M& cost)
+{
+    intptr_t n = std::min<intptr_t>(AUTO_SAMPLES, nr * nc);
+    uint64_t state = 0x9e3779b97f4a7c15ull;
+    intptr_t finite = 0;
+    for (intptr_t s = 0; s < n; s++) {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        uint64_t r = state >> 16;
+        if (cost.get(r % nr, (r / nr) % nc) != INFINITY) {
+            finite++;
         }
-        if (this->m_subcols != nullptr) {
-            j = this->m_subcols[j];
+    }
+    return n > 0 ? double(finite) / n : 1.0;
+}
+
+// Whether adjacent rows tend to want the same column, as for costs between
+// sorted points, where index order makes every augmentation undo the
+// previous one.
+template <typename M> static bool
+adjacent_rows_compete(intptr_t nr, intptr_t nc, const M& cost)
+{
+    intptr_t pairs = std::min<intptr_t>(AUTO_ROW_PAIRS, nr / 2);
+    if (pairs == 0 || nc < 4) {
+        return false;
+    }
+    intptr_t close = 0;
+    for (intptr_t p = 0; p < pairs; p++) {
+        intptr_t i = p * (nr / pairs);
+        intptr_t arg[2] = {0, 0};
+        for (intptr_t d = 0; d < 2; d++) {
+            double best = INFINITY;
+            for (intptr_t j = 0; j < nc; j++) {
+                double c = cost.get(i + d, j);
+                if (c < best) {
+                    best = c;
+                    arg[d] = j;
+                }
+            }
         }
-        r = this->m_d[i * m_nc + j];
-        if (this->m_negative) {
-            r = -r;
+        if (std::abs(arg[0] - arg[1]) <= 1) {
+            close++;
         }
-        return r;
-    }
-    void transpose() {
-        this->m_transpose = !this->m_transpose;
     }
-    void negative() {
-        this->m_negative = !this->m_negative;
+    return close * 4 > pairs;
+}
+
+// Exact solve on the finite entries only, for views with few of them.
+template <typename M> static int
+solve_sparse(intptr_t nr, intptr_t nc, const M& costmat, exact_workspace& ws,
+             struct lsap_stats* stats)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    sparse_cost& cost = ws.sparse;
+    cost.nr = nr;
+    cost.nc = nc;
+    cost.indptr.assign(1, 0);
+    cost.indices.clear();
+    cost.data.clear();
+    for (intptr_t i = 0; i < nr; i++) {
+        for (intptr_t j = 0; j < nc; j++) {
+            double c = costmat.get(i, j);
+            if (c != INFINITY) {
+                cost.indices.push_back(j);
+                cost.data.push_back(c);
+            }
+        }
+        cost.indptr.push_back(cost.indices.size());
     }
-    void subscript(const intptr_t *subrows, const intptr_t *subcols) {
-        this->m_subrows = subrows;
-        this->m_subcols = subcols;
+    ws.u.assign(nr, 0);
+    ws.v.assign(nc, 0);
+    ws.row4col.assign(nc, -1);
+    sparse_solver solver(nc);
+    if (stats != nullptr) {
+        stats->setup_seconds = seconds_since(start);
     }
-private:
-    const T *m_d;
-    intptr_t m_nr;
-    intptr_t m_nc;
-    bool m_transpose;
-    bool m_negative;
-    const intptr_t *m_subrows;
-    const intptr_t *m_subcols;
-};
+    return solver.solve_from(cost, ws.u, ws.v, ws.col4row, ws.row4col);
+}
 
-template <typename T> std::vector<intptr_t> argsort_iter(const std::vector<T> &v)
+// Start a full assignment in the arrays of ws, returns the row order for
+// solve_from.
+template <typename M> static const intptr_t*
+prepare_full(intptr_t nr, intptr_t nc, const M& cost, intptr_t kind, exact_workspace& ws)
 {
-    std::vector<intptr_t> index(v.size());
-    std::iota(index.begin(), index.end(), 0);
-    std::sort(index.begin(), index.end(), [&v](intptr_t i, intptr_t j)
-              {return v[i] < v[j];});
-    return index;
+    ws.u.assign(nr, 0);
+    ws.v.assign(nc, 0);
+    ws.row4col.assign(nc, -1);
+    return row_order(nr, nc, cost, kind, ws.order) ? ws.order.data() : nullptr;
 }
 
-template <typename T> static intptr_t
-augmenting_path(intptr_t nc, const matrix2d<T>& cost, const std::vector<double>& u,
-                const std::vector<double>& v, std::vector<intptr_t>& path,
-                const std::vector<intptr_t>& row4col,
-                std::vector<double>& shortestPathCosts, intptr_t i,
-                std::vector<bool>& SR, std::vector<bool>& SC,
-                std::vector<intptr_t>& remaining, double* p_minVal)
+// solve_view for a full assignment in ws.
+template <typename M> static int
+solve_full(intptr_t nr, intptr_t nc, const M& cost, intptr_t kind, exact_workspace& ws)
 {
-    double minVal = 0;
-
-    // Crouse's pseudocode uses set complements to keep track of remaining
-    // nodes.  Here we use a vector, as it is more efficient in C++.
-    intptr_t num_remaining = nc;
-    for (intptr_t it = 0; it < nc; it++) {
-        // Filling this up in reverse order ensures that the solution of a
-        // constant cost matrix is the identity matrix (c.f. #11602).
-        remaining[it] = nc - it - 1;
-    }
-
-    std::fill(SR.begin(), SR.end(), false);
-    std::fill(SC.begin(), SC.end(), false);
-    std::fill(shortestPathCosts.begin(), shortestPathCosts.end(), INFINITY);
-
-    // find shortest augmenting path
-    intptr_t sink = -1;
-    while (sink == -1) {
-
-        intptr_t index = -1;
-        double lowest = INFINITY;
-        SR[i] = true;
-
-        for (intptr_t it = 0; it < num_remaining; it++) {
-            intptr_t j = remaining[it];
+    const intptr_t* order = prepare_full(nr, nc, cost, kind, ws);
+    no_counters counters;
+    return solve_from(nr, nc, cost, ws.u, ws.v, ws.col4row, ws.row4col, order,
+                      ws.scratch, counters);
+}
 
-            double r = minVal + cost.get(i, j) - u[i] - v[j];
-            if (r < shortestPathCosts[j]) {
-                path[j] = i;
-                shortestPathCosts[j] = r;
-            }
+// solve_full with the counters of stats collected.
+template <typename M> static int
+solve_counted(intptr_t nr, intptr_t nc, const M& cost, intptr_t kind,
+              exact_workspace& ws, struct lsap_stats* stats, struct lsap_trace* trace)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    const intptr_t* order = prepare_full(nr, nc, cost, kind, ws);
+    stats->setup_seconds = seconds_since(start);
+    stats->workspace_bytes = exact_workspace_bytes(nr, nc, -1, kind);
+
+    path_counters<true> counters;
+    if (trace != nullptr) {
+        trace->count = 0;
+    }
+    counters.trace = trace;
+    counters.origin = start;
+    int ret = solve_from(nr, nc, cost, ws.u, ws.v, ws.col4row, ws.row4col, order,
+                         ws.scratch, counters);
+    stats->augment_seconds = counters.augment_seconds;
+    stats->augmentations = counters.augmentations;
+    stats->columns_scanned = counters.columns_scanned;
+    stats->path_length_mean = counters.augmentations > 0 ?
+        double(counters.path_length_total) / counters.augmentations : 0;
+    stats->path_length_max = counters.path_length_max;
+    stats->dual_updates = counters.dual_updates;
+    stats->tie_breaks = counters.tie_breaks;
+    return ret;
+}
 
-            // When multiple nodes have the minimum cost, we select one which
-            // gives us a new sink node. This is particularly important for
-            // integer cost matrices with small co-efficients.
-            if (shortestPathCosts[j] < lowest ||
-                (shortestPathCosts[j] == lowest && row4col[j] == -1)) {
-                lowest = shortestPathCosts[j];
-                index = it;
-            }
-        }
+// What method='exact' or 'auto' runs on a view of nr <= nc.
+struct exact_plan {
+    const char* engine;
+    const char* reason;
+    bool sparse;
+    intptr_t row_order;
+    intptr_t workspace_bytes;
+    double density;
+};
 
-        minVal = lowest;
-        if (minVal == INFINITY) { // infeasible cost matrix
-            return -1;
+// Choose the engine and row order for the view and size its workspace.
+// Under auto the sparse solver gives way to the dense one when its arrays
+// do not fit options->memory_limit; RECTANGULAR_LSAP_MEMORY_LIMIT when
+// nothing fits.
+template <typename T, typename M> static int
+plan_exact(intptr_t nr, intptr_t nc, const M& cost, intptr_t k,
+           const struct lsap_options* options, exact_plan* plan)
+{
+    bool full = k < 0 || k >= nr;
+    plan->engine = full ? "exact" : "exact_k";
+    plan->reason = options->method == LSAP_METHOD_AUTO ? "k pairs or trivial input" : "requested";
+    plan->sparse = false;
+    plan->row_order = options->row_order;
+    plan->density = NAN;
+    if (options->method == LSAP_METHOD_AUTO && full) {
+        // the sparse solver pays a heap per scanned entry and the arrays of
+        // the finite entries, worth it only when most are infinite; integer
+        // dtypes have no infinite entries
+        double density = 1.0;
+        if (std::numeric_limits<T>::has_infinity) {
+            density = sample_density(nr, nc, cost);
+            plan->density = density;
         }
-
-        intptr_t j = remaining[index];
-        if (row4col[j] == -1) {
-            sink = j;
+        if (density <= tuned_sparse_density.load(std::memory_order_relaxed)) {
+            intptr_t nnz = std::ceil(density * nr * nc);
+            plan->workspace_bytes = sparse_workspace_bytes(nr, nc, nnz);
+            if (within_memory_limit(options, plan->workspace_bytes)) {
+                plan->engine = "exact_sparse";
+                plan->reason = "few finite entries";
+                plan->sparse = true;
+                return 0;
+            }
+            plan->reason = "sparse arrays over memory_limit";
+        } else if (adjacent_rows_compete(nr, nc, cost)) {
+            plan->reason = "adjacent rows compete, cheapest rows first";
+            plan->row_order = LSAP_ROW_ORDER_MIN_COST;
         } else {
-            i = row4col[j];
+            plan->reason = "dense unstructured costs";
         }
-
-        SC[j] = true;
-        remaining[index] = remaining[--num_remaining];
     }
-
-    *p_minVal = minVal;
-    return sink;
+    plan->workspace_bytes = exact_workspace_bytes(nr, nc, k, plan->row_order);
+    return within_memory_limit(options, plan->workspace_bytes) ? 0 : RECTANGULAR_LSAP_MEMORY_LIMIT;
 }
 
 template <typename T> static int
-solve(intptr_t nr, intptr_t nc, const T* cost, bool maximize,
+solve(intptr_t nr, intptr_t nc, intptr_t stride, const T* cost, bool maximize,
       const intptr_t *subrows, intptr_t n_subrows, const intptr_t *subcols, intptr_t n_subcols,
+      intptr_t k, const struct lsap_options* options, exact_workspace* ws,
       int64_t* a, int64_t* b)
 {
+    struct lsap_stats* stats = options->stats;
+    // the engine is that of plan_exact, the returns before it name one
+    const char* reason = options->method == LSAP_METHOD_AUTO ?
+        "k pairs or trivial input" : "requested";
+
     // handle trivial inputs
     if (nr == 0 || nc == 0) {
+        set_stats(stats, "exact", reason);
         return 0;
     }
 
-    // test for NaN and -inf entries
-    for (intptr_t i = 0; i < nr * nc; i++) {
-        if (cost[i] != cost[i] || ((cost[i] == -INFINITY) && !maximize) || ((cost[i] == INFINITY) && maximize)) {
-            return RECTANGULAR_LSAP_INVALID;
-        }
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    matrix2d<T> costmat{cost, nr, nc, stride};
+    bool transpose;
+    int ret = make_cost_view(&nr, &nc, cost, maximize, &subrows, n_subrows,
+                             &subcols, n_subcols, costmat, &transpose);
+    if (stats != nullptr) {
+        stats->validation_seconds = seconds_since(start);
+    }
+    if (ret != 0) {
+        set_stats(stats, "exact", reason);
+        return ret;
     }
 
-    // check subrows and subcols in bound.
-    if (n_subrows == 0) {
-        subrows = nullptr;
+    // k < 0 means a full assignment of min(nr, nc) pairs
+    if (k > nr) {
+        set_stats(stats, "exact_k", reason);
+        return RECTANGULAR_LSAP_K_INVALID;
     }
-    else {
-        // notice n_subrows larger than nr is legal, same for n_subcols and nc
-        if (n_subrows < 0) {
-            return RECTANGULAR_LSAP_SUBSCRIPT_INVALID;
-        }
-        for (intptr_t i = 0; i < n_subrows; i++) {
-            intptr_t v = subrows[i];
-            if (v < 0 || v >= nr) {
-                return RECTANGULAR_LSAP_SUBSCRIPT_INVALID;
-            }
-        }
+    bool full = k < 0 || k >= nr;
+    exact_plan plan;
+    ret = plan_exact<T>(nr, nc, costmat, k, options, &plan);
+    set_stats(stats, plan.engine, plan.reason);
+    if (stats != nullptr) {
+        stats->density = plan.density;
+        stats->workspace_bytes = plan.workspace_bytes;
     }
-    if (n_subcols == 0) {
-        subcols = nullptr;
+    if (ret != 0) {
+        return ret;
     }
-    else {
-        if (n_subcols < 0) {
-            return RECTANGULAR_LSAP_SUBSCRIPT_INVALID;
-        }
-        for (intptr_t j = 0; j < n_subcols; j++) {
-            intptr_t v = subcols[j];
-            if (v < 0 || v >= nc) {
-                return RECTANGULAR_LSAP_SUBSCRIPT_INVALID;
+    exact_workspace local;
+    exact_workspace& work = ws != nullptr ? *ws : local;
+    std::vector<intptr_t>& col4row = work.col4row;
+    col4row.assign(nr, -1);
+    if (plan.sparse) {
+        ret = solve_sparse(nr, nc, costmat, work, stats);
+    } else if (!full) {
+        ret = solve_k(nr, nc, costmat, k, col4row);
+    } else if (stats != nullptr) {
+        ret = solve_counted(nr, nc, costmat, plan.row_order, work, stats, options->trace);
+        struct lsap_trace* trace = options->trace;
+        if (trace != nullptr) {
+            // back to the indices of the cost matrix, like write_result
+            const intptr_t* index = transpose ? subcols : subrows;
+            intptr_t n = std::min(trace->count, trace->capacity);
+            for (intptr_t i = 0; i < n && index != nullptr; i++) {
+                trace->events[i].row = index[trace->events[i].row];
             }
         }
+    } else {
+        ret = solve_full(nr, nc, costmat, plan.row_order, work);
+    }
+    if (ret != 0) {
+        return ret;
     }
+    work.duals = full;
+    work.transpose = transpose;
 
-    matrix2d<T> costmat{cost, nr, nc};
+    return write_result(nr, col4row, transpose, subrows, subcols, a, b);
+}
 
-    bool subscript = (subrows != nullptr) || (subcols != nullptr);
-    if (subscript) {
-        costmat.subscript(subrows, subcols);
-        nr = n_subrows;
-        nc = n_subcols;
+template <typename T> static int
+estimate_solve(intptr_t nr, intptr_t nc, const T* cost, bool maximize,
+               const intptr_t *subrows, intptr_t n_subrows, const intptr_t *subcols, intptr_t n_subcols,
+               intptr_t k, intptr_t objective, const struct lsap_options* options,
+               struct lsap_estimate* estimate)
+{
+    int ret = check_subscript(nr, &subrows, n_subrows);
+    if (ret == 0) {
+        ret = check_subscript(nc, &subcols, n_subcols);
     }
-
-    // tall rectangular cost matrix must be transposed
-    bool transpose = nc < nr;
-    if (transpose) {
-        costmat.transpose();
-        std::swap(nr, nc);
+    if (ret != 0) {
+        return ret;
     }
-    if (maximize) {
-        costmat.negative();
+    matrix2d<T> costmat{cost, nr, nc};
+    bool transpose;
+    setup_cost_view(&nr, &nc, maximize, subrows, n_subrows, subcols, n_subcols,
+                    costmat, &transpose);
+    if (k > nr) {
+        return RECTANGULAR_LSAP_K_INVALID;
+    }
+    estimate->output_bytes = 2 * (k >= 0 ? k : nr) * sizeof(int64_t);
+    if (nr == 0 || nc == 0) {
+        return 0;
     }
 
-    // initialize variables
-    std::vector<double> u(nr, 0);
-    std::vector<double> v(nc, 0);
-    std::vector<double> shortestPathCosts(nc);
-    std::vector<intptr_t> path(nc, -1);
-    std::vector<intptr_t> col4row(nr, -1);
-    std::vector<intptr_t> row4col(nc, -1);
-    std::vector<bool> SR(nr);
-    std::vector<bool> SC(nc);
-    std::vector<intptr_t> remaining(nc);
-
-    // iteratively build the solution
-    for (intptr_t curRow = 0; curRow < nr; curRow++) {
-
-        double minVal;
-        intptr_t sink = augmenting_path(nc, costmat, u, v, path, row4col,
-                                        shortestPathCosts, curRow, SR, SC,
-                                        remaining, &minVal);
-        if (sink < 0) {
-            return RECTANGULAR_LSAP_INFEASIBLE;
-        }
+    if (objective != LSAP_OBJECTIVE_SUM) {
+        estimate->engine = "bottleneck";
+        estimate->workspace_bytes = bottleneck_workspace_bytes(
+            nr, nc, k, objective == LSAP_OBJECTIVE_BOTTLENECK_SUM);
+    } else if (options->method == LSAP_METHOD_SINKHORN) {
+        estimate->engine = "sinkhorn";
+        estimate->workspace_bytes = sinkhorn_workspace_bytes(nr, nc, options->repair);
+    } else if (options->method == LSAP_METHOD_GREEDY) {
+        estimate->engine = "greedy";
+        estimate->workspace_bytes = greedy_workspace_bytes(
+            nr, nc, tuned_threads(options->n_threads, nr * nc), false);
+    } else {
+        // the limit is what is estimated, not a constraint
+        struct lsap_options unlimited = *options;
+        unlimited.memory_limit = -1;
+        exact_plan plan;
+        plan_exact<T>(nr, nc, costmat, k, &unlimited, &plan);
+        estimate->engine = plan.engine;
+        estimate->workspace_bytes = plan.workspace_bytes;
+        estimate->density = plan.density;
+    }
+    return 0;
+}
 
-        // update dual variables
-        u[curRow] += minVal;
-        for (intptr_t i = 0; i < nr; i++) {
-            if (SR[i] && i != curRow) {
-                u[i] += minVal - shortestPathCosts[col4row[i]];
-            }
-        }
+#ifdef __cplusplus
+extern "C" {
+#endif
 
-        for (intptr_t j = 0; j < nc; j++) {
-            if (SC[j]) {
-                v[j] -= minVal - shortestPathCosts[j];
-            }
-        }
+int
+solve_rectangular_linear_sum_assignment(intptr_t nr, intptr_t nc,
+                                        double* input_cost, bool maximize,
+                                        int64_t* a, int64_t* b)
+{
+    struct lsap_options options;
+    lsap_options_init(&options);
+    return lsap_validated(solve(nr, nc, nc, input_cost, maximize, nullptr, 0, nullptr, 0, -1,
+                                &options, nullptr, a, b), nr, nc);
+}
 
-        // augment previous solution
-        intptr_t j = sink;
-        while (1) {
-            intptr_t i = path[j];
-            row4col[j] = i;
-            std::swap(col4row[i], j);
-            if (i == curRow) {
-                break;
-            }
-        }
+
+void lsap_tuning_defaults(struct lsap_tuning* tuning)
+{
+    tuning->sparse_density = AUTO_SPARSE_DENSITY;
+    tuning->entries_per_thread = ENTRIES_PER_THREAD;
+}
+
+void lsap_get_tuning(struct lsap_tuning* tuning)
+{
+    tuning->sparse_density = tuned_sparse_density.load();
+    tuning->entries_per_thread = tuned_entries_per_thread.load();
+}
+
+int lsap_set_tuning(const struct lsap_tuning* tuning)
+{
+    if (std::isnan(tuning->sparse_density) || tuning->entries_per_thread < 1) {
+        return RECTANGULAR_LSAP_INVALID;
     }
+    tuned_sparse_density.store(tuning->sparse_density);
+    tuned_entries_per_thread.store(tuning->entries_per_thread);
+    return 0;
+}
 
-    if (transpose) {
-        intptr_t i = 0;
-        for (auto v: argsort_iter(col4row)) {
-            a[i] = col4row[v];
-            b[i] = v;
-            i++;
-        }
+
+void lsap_options_init(struct lsap_options* options)
+{
+    options->method = LSAP_METHOD_EXACT;
+    options->n_threads = 1;
+    options->row_order = LSAP_ROW_ORDER_INDEX;
+    options->epsilon = 3e-3;
+    options->tolerance = 1e-2;
+    options->max_iter = 1000;
+    options->repair = false;
+    options->stats = nullptr;
+    options->trace = nullptr;
+    options->memory_limit = -1;
+}
+
+
+static int
+dispatch(intptr_t nr, intptr_t nc, intptr_t stride, void* input_cost, intptr_t dtype, bool maximize,
+         const intptr_t *subrows, intptr_t n_subrows, const intptr_t *subcols, intptr_t n_subcols,
+         intptr_t k, intptr_t objective, const struct lsap_options* options,
+         exact_workspace* ws, int64_t* a, int64_t* b)
+{
+    struct lsap_stats* stats = options->stats;
+    clear_stats(stats);
+    if (ws != nullptr) {
+        ws->duals = false;
     }
-    else {
-        for (intptr_t i = 0; i < nr; i++) {
-            a[i] = i;
-            b[i] = col4row[i];
+    bool requested = options->method != LSAP_METHOD_AUTO;
+    // only the exact engine takes row strides
+    bool contiguous = stride == nc;
+    switch (options->method) {
+    case LSAP_METHOD_EXACT:
+    case LSAP_METHOD_AUTO:
+        if (options->row_order < LSAP_ROW_ORDER_INDEX ||
+            options->row_order > LSAP_ROW_ORDER_MIN_COST) {
+            return RECTANGULAR_LSAP_METHOD_INVALID;
+        }
+        break;
+    case LSAP_METHOD_SINKHORN:
+        // approximations of the full sum assignment only
+        if (k >= 0 || objective != LSAP_OBJECTIVE_SUM) {
+            return RECTANGULAR_LSAP_METHOD_INVALID;
+        }
+        if (!contiguous) {
+            return RECTANGULAR_LSAP_STRIDE_INVALID;
+        }
+        set_stats(stats, "sinkhorn", "requested");
+        return lsap_sinkhorn_dtype(
+            nr, nc, input_cost, dtype, maximize, subrows, n_subrows, subcols, n_subcols,
+            options, a, b);
+    case LSAP_METHOD_GREEDY:
+        if (k >= 0 || objective != LSAP_OBJECTIVE_SUM) {
+            return RECTANGULAR_LSAP_METHOD_INVALID;
         }
+        if (!contiguous) {
+            return RECTANGULAR_LSAP_STRIDE_INVALID;
+        }
+        set_stats(stats, "greedy", "requested");
+        return lsap_greedy_dtype(
+            nr, nc, input_cost, dtype, maximize, subrows, n_subrows, subcols, n_subcols,
+            options, a, b, nullptr, nullptr);
+    default:
+        return RECTANGULAR_LSAP_METHOD_INVALID;
     }
 
-    if (subscript) {
-        for (intptr_t i = 0; i < nr; i++) {
-            if (subrows != nullptr) {
-                a[i] = subrows[a[i]];
-            }
-            if (subcols != nullptr) {
-                b[i] = subcols[b[i]];
-            }
+    switch (objective) {
+    case LSAP_OBJECTIVE_SUM:
+        break;
+    case LSAP_OBJECTIVE_BOTTLENECK:
+    case LSAP_OBJECTIVE_BOTTLENECK_SUM:
+        if (!contiguous) {
+            return RECTANGULAR_LSAP_STRIDE_INVALID;
         }
+        set_stats(stats, "bottleneck", requested ? "requested" : "only engine for the objective");
+        return lsap_bottleneck_dtype(
+            nr, nc, input_cost, dtype, maximize, subrows, n_subrows, subcols, n_subcols,
+            k, objective == LSAP_OBJECTIVE_BOTTLENECK_SUM, options, a, b);
+    default:
+        return RECTANGULAR_LSAP_OBJECTIVE_INVALID;
     }
 
-    return 0;
+    LSAP_DTYPE_SWITCH(dtype, T,
+        return solve(nr, nc, stride, (const T *)input_cost, maximize,
+                     subrows, n_subrows, subcols, n_subcols, k, options, ws, a, b));
 }
 
-#ifdef __cplusplus
-extern "C" {
-#endif
+static int
+estimate_dtype(
+    intptr_t nr, intptr_t nc, void* input_cost, intptr_t dtype, bool maximize,
+    const intptr_t *subrows, intptr_t n_subrows, const intptr_t *subcols, intptr_t n_subcols,
+    intptr_t k, intptr_t objective, const struct lsap_options* options,
+    struct lsap_estimate* estimate)
+{
+    struct lsap_options defaults;
+    if (options == nullptr) {
+        lsap_options_init(&defaults);
+        options = &defaults;
+    }
+    estimate->engine = "";
+    estimate->workspace_bytes = 0;
+    estimate->output_bytes = 0;
+    estimate->density = NAN;
+
+    // the checks of dispatch
+    switch (options->method) {
+    case LSAP_METHOD_EXACT:
+    case LSAP_METHOD_AUTO:
+        if (options->row_order < LSAP_ROW_ORDER_INDEX ||
+            options->row_order > LSAP_ROW_ORDER_MIN_COST) {
+            return RECTANGULAR_LSAP_METHOD_INVALID;
+        }
+        break;
+    case LSAP_METHOD_SINKHORN:
+    case LSAP_METHOD_GREEDY:
+        if (k >= 0 || objective != LSAP_OBJECTIVE_SUM) {
+            return RECTANGULAR_LSAP_METHOD_INVALID;
+        }
+        break;
+    default:
+        return RECTANGULAR_LSAP_METHOD_INVALID;
+    }
+    if (objective < LSAP_OBJECTIVE_SUM || objective > LSAP_OBJECTIVE_BOTTLENECK_SUM) {
+        return RECTANGULAR_LSAP_OBJECTIVE_INVALID;
+    }
 
-int
-solve_rectangular_linear_sum_assignment(intptr_t nr, intptr_t nc,
-                                        double* input_cost, bool maximize,
-                                        int64_t* a, int64_t* b)
+    LSAP_DTYPE_SWITCH(dtype, T,
+        return estimate_solve(nr, nc, (const T *)input_cost, maximize,
+                              subrows, n_subrows, subcols, n_subcols, k, objective,
+                              options, estimate));
+}
+
+int lsap_estimate_dtype(
+    intptr_t nr, intptr_t nc, void* input_cost, intptr_t dtype, bool maximize,
+    const intptr_t *subrows, intptr_t n_subrows, const intptr_t *subcols, intptr_t n_subcols,
+    intptr_t k, intptr_t objective, const struct lsap_options* options,
+    struct lsap_estimate* estimate)
 {
-    return solve(nr, nc, input_cost, maximize, nullptr, 0, nullptr, 0, a, b);
+    return lsap_validated(
+        estimate_dtype(nr, nc, input_cost, dtype, maximize, subrows, n_subrows,
+                       subcols, n_subcols, k, objective, options, estimate), nr, nc);
 }
 
+int lsap_solve_dtype(
+    intptr_t nr, intptr_t nc, void* input_cost, intptr_t dtype, bool maximize,
+    const intptr_t *subrows, intptr_t n_subrows, const intptr_t *subcols, intptr_t n_subcols,
+    intptr_t k, intptr_t objective, const struct lsap_options* options,
+    int64_t* a, int64_t* b)
+{
+    return lsap_solve_strided(nr, nc, nc, input_cost, dtype, maximize, subrows, n_subrows,
+                              subcols, n_subcols, k, objective, options, nullptr, a, b);
+}
 
 int solve_rectangular_linear_sum_assignment_dtype(
     intptr_t nr, intptr_t nc, void* input_cost, intptr_t dtype, bool maximize,
     const intptr_t *subrows, intptr_t n_subrows, const intptr_t *subcols, intptr_t n_subcols,
     int64_t* a, int64_t* b)
 {
-    switch (dtype) {
-    case LSAP_BOOL:
-        return solve(nr, nc, (bool *)input_cost, maximize, subrows, n_subrows, subcols, n_subcols, a, b);
-    case LSAP_BYTE:
-        return solve(nr, nc, (char *)input_cost, maximize, subrows, n_subrows, subcols, n_subcols, a, b);
-    case LSAP_UBYTE:
-        return solve(nr, nc, (unsigned char *)input_cost, maximize, subrows, n_subrows, subcols, n_subcols, a, b);
-    case LSAP_SHORT:
-        return solve(nr, nc, (short *)input_cost, maximize, subrows, n_subrows, subcols, n_subcols, a, b);
-    case LSAP_USHORT:
-        return solve(nr, nc, (unsigned short *)input_cost, maximize, subrows, n_subrows, subcols, n_subcols, a, b);
-    case LSAP_INT:
-        return solve(nr, nc, (int *)input_cost, maximize, subrows, n_subrows, subcols, n_subcols, a, b);
-    case LSAP_UINT:
-        return solve(nr, nc, (unsigned int *)input_cost, maximize, subrows, n_subrows, subcols, n_subcols, a, b);
-    case LSAP_LONG:
-        return solve(nr, nc, (long *)input_cost, maximize, subrows, n_subrows, subcols, n_subcols, a, b);
-    case LSAP_ULONG:
-        return solve(nr, nc, (unsigned long *)input_cost, maximize, subrows, n_subrows, subcols, n_subcols, a, b);
-    case LSAP_LONGLONG:
-        return solve(nr, nc, (long long *)input_cost, maximize, subrows, n_subrows, subcols, n_subcols, a, b);
-    case LSAP_ULONGLONG:
-        return solve(nr, nc, (unsigned long long *)input_cost, maximize, subrows, n_subrows, subcols, n_subcols, a, b);
-    case LSAP_FLOAT:
-        return solve(nr, nc, (float *)input_cost, maximize, subrows, n_subrows, subcols, n_subcols, a, b);
-    case LSAP_DOUBLE:
-        return solve(nr, nc, (double *)input_cost, maximize, subrows, n_subrows, subcols, n_subcols, a, b);
-    case LSAP_LONGDOUBLE:
-        return solve(nr, nc, (long double *)input_cost, maximize, subrows, n_subrows, subcols, n_subcols, a, b);
-    default:
-        return RECTANGULAR_LSAP_DTYPE_INVALID;
-    }
+    return lsap_solve_strided(nr, nc, nc, input_cost, dtype, maximize, subrows, n_subrows,
+                              subcols, n_subcols, -1, LSAP_OBJECTIVE_SUM, nullptr, nullptr,
+                              a, b);
 }
 
 #ifdef __cplusplus
 }
 #endif
+
+int lsap_solve_strided(
+    intptr_t nr, intptr_t nc, intptr_t stride, void* input_cost, intptr_t dtype, bool maximize,
+    const intptr_t *subrows, intptr_t n_subrows, const intptr_t *subcols, intptr_t n_subcols,
+    intptr_t k, intptr_t objective, const struct lsap_options* options,
+    exact_workspace* ws, int64_t* a, int64_t* b)
+{
+    struct lsap_options defaults;
+    if (options == nullptr) {
+        lsap_options_init(&defaults);
+        options = &defaults;
+    }
+
+    LSAP_PROBE5(solve__start, nr, nc, dtype, k, options->method);
+    int ret = dispatch(nr, nc, stride, input_cost, dtype, maximize, subrows, n_subrows,
+                       subcols, n_subcols, k, objective, options, ws, a, b);
+    lsap_validated(ret, nr, nc);
+    LSAP_PROBE3(solve__end, ret, nr, nc);
+    return ret;
+}
@@ -35,6 +35,27 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define RECTANGULAR_LSAP_INVALID -2
 #define RECTANGULAR_LSAP_SUBSCRIPT_INVALID -3
 #define RECTANGULAR_LSAP_DTYPE_INVALID -4
+#define RECTANGULAR_LSAP_K_INVALID -5
+#define RECTANGULAR_LSAP_OBJECTIVE_INVALID -6
+#define RECTANGULAR_LSAP_MASS_INVALID -7
+#define RECTANGULAR_LSAP_ITERATION_LIMIT -8
+#define RECTANGULAR_LSAP_METHOD_INVALID -9
+#define RECTANGULAR_LSAP_METRIC_INVALID -10
+#define RECTANGULAR_LSAP_MEMORY_LIMIT -11
+#define RECTANGULAR_LSAP_STRIDE_INVALID -12
+
+/* The functions of the C ABI, exported from the shared library built by
+   CMake, which defines LSAP_BUILD_SHARED; users of the DLL on Windows
+   define LSAP_SHARED. */
+#if defined(LSAP_BUILD_SHARED) && defined(_WIN32)
+#define LSAP_API __declspec(dllexport)
+#elif defined(LSAP_BUILD_SHARED)
+#define LSAP_API __attribute__((visibility("default")))
+#elif defined(LSAP_SHARED) && defined(_WIN32)
+#define LSAP_API __declspec(dllimport)
+#else
+#define LSAP_API
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -43,9 +64,9 @@ extern "C" {
 #include <stdint.h>
 #include <stdbool.h>
 
-int solve_rectangular_linear_sum_assignment(intptr_t nr, intptr_t nc,
-                                            double* input_cost, bool maximize,
-                                            int64_t* a, int64_t* b);
+LSAP_API int solve_rectangular_linear_sum_assignment(intptr_t nr, intptr_t nc,
+                                                     double* input_cost, bool maximize,
+                                                     int64_t* a, int64_t* b);
 
 enum LSAP_TYPES {
    LSAP_BOOL=0,
@@ -59,11 +80,245 @@ enum LSAP_TYPES {
    LSAP_INVALID = 0xFFFF,
 };
 
-int solve_rectangular_linear_sum_assignment_dtype(
+enum LSAP_OBJECTIVES {
+   LSAP_OBJECTIVE_SUM=0,
+   LSAP_OBJECTIVE_BOTTLENECK,
+   LSAP_OBJECTIVE_BOTTLENECK_SUM,
+};
+
+enum LSAP_METHODS {
+   LSAP_METHOD_EXACT=0,
+   LSAP_METHOD_SINKHORN,
+   LSAP_METHOD_GREEDY,
+   LSAP_METHOD_AUTO,
+};
+
+enum LSAP_ROW_ORDERS {
+   LSAP_ROW_ORDER_INDEX=0,
+   LSAP_ROW_ORDER_RANDOM,
+   LSAP_ROW_ORDER_REGRET,
+   LSAP_ROW_ORDER_MIN_COST,
+};
+
+enum LSAP_METRICS {
+   LSAP_METRIC_EUCLIDEAN=0,
+   LSAP_METRIC_SQEUCLIDEAN,
+};
+
+/* What a solve did, filled when lsap_options.stats is not NULL.  The
+   strings are static.  The timings and counters are collected by the
+   dense exact engine, the other engines leave them zero; without stats
+   the counting code is not instantiated at all. */
+struct lsap_stats {
+   const char* engine;   /* the solver that ran */
+   const char* reason;   /* why it was chosen */
+   double density;       /* sampled fraction of finite entries, NAN if not sampled */
+   double validation_seconds;   /* checking the entries and subscripts */
+   double setup_seconds;        /* workspace and row order */
+   double augment_seconds;      /* in augmenting_path */
+   intptr_t augmentations;
+   intptr_t columns_scanned;    /* reduced costs evaluated */
+   double path_length_mean;     /* rows per alternating path */
+   intptr_t path_length_max;
+   intptr_t dual_updates;       /* u and v entries changed */
+   intptr_t tie_breaks;         /* equal distances resolved towards a free column */
+   intptr_t workspace_bytes;    /* peak solver workspace, the cost matrix excluded */
+};
+
+/* One augmentation of the exact engine.  The times are in seconds from
+   the start of the solve. */
+struct lsap_trace_event {
+   intptr_t row;               /* the row assigned, a column if nr > nc */
+   intptr_t path_length;       /* rows of the alternating path */
+   intptr_t columns_scanned;
+   double start;
+   double duration;
+   double path_cost;           /* reduced cost of the shortest path */
+};
+
+/* A ring buffer owned by the caller, the event of augmentation i is in
+   events[i % capacity]; count is the number of augmentations, so the last
+   min(count, capacity) are kept.  Nothing is allocated while recording. */
+struct lsap_trace {
+   struct lsap_trace_event* events;
+   intptr_t capacity;
+   intptr_t count;
+};
+
+/* Solver selection and tuning, fill with lsap_options_init first. */
+struct lsap_options {
+   intptr_t method;    /* enum LSAP_METHODS */
+   intptr_t n_threads;
+   /* exact: order of the augmenting rows, enum LSAP_ROW_ORDERS */
+   intptr_t row_order;
+   /* sinkhorn: final regularization relative to the cost range */
+   double epsilon;
+   /* sinkhorn: end the last stage when the mean row marginal error is below */
+   double tolerance;
+   /* sinkhorn: limit of scaling iterations, greedy: of local search passes,
+      < 0 for none */
+   intptr_t max_iter;
+   /* sinkhorn: make the rounded assignment optimal with the exact solver */
+   bool repair;
+   /* filled with what the solve did when not NULL */
+   struct lsap_stats* stats;
+   /* exact: augmentations recorded along with stats when not NULL */
+   struct lsap_trace* trace;
+   /* bytes of workspace allowed, see lsap_estimate_dtype, < 0 for none.
+      auto falls back to an engine that fits, other methods fail with
+      RECTANGULAR_LSAP_MEMORY_LIMIT before allocating. */
+   intptr_t memory_limit;
+};
+
+LSAP_API void lsap_options_init(struct lsap_options* options);
+
+/* Machine dependent thresholds of the solvers, shared by the process.
+   nanolsap.autotune measures them, lsap_tuning_defaults gives the values
+   used until lsap_set_tuning is called. */
+struct lsap_tuning {
+   /* auto: densest view solved by the sparse exact engine */
+   double sparse_density;
+   /* sinkhorn and greedy: entries of the view per thread started, fewer
+      threads than n_threads run on smaller views */
+   intptr_t entries_per_thread;
+};
+
+LSAP_API void lsap_tuning_defaults(struct lsap_tuning* tuning);
+LSAP_API void lsap_get_tuning(struct lsap_tuning* tuning);
+/* Used by the solves that start afterwards.  Returns
+   RECTANGULAR_LSAP_INVALID if a value is out of range: sparse_density
+   must not be NaN, entries_per_thread must be positive. */
+LSAP_API int lsap_set_tuning(const struct lsap_tuning* tuning);
+
+/* What a solve would allocate, see lsap_estimate_dtype. */
+struct lsap_estimate {
+   const char* engine;          /* as lsap_stats.engine */
+   intptr_t workspace_bytes;    /* arrays of the engine */
+   intptr_t output_bytes;       /* a and b */
+   double density;              /* sampled by auto, NAN if not sampled */
+};
+
+/* The engine lsap_solve_dtype would run with
+   these arguments and the memory it would take besides the cost matrix,
+   without solving.  Only the subscripts are validated.  The workspace is
+   exact for the dense engines; for exact_sparse it follows from the
+   sampled density.  options->memory_limit is ignored. */
+LSAP_API int lsap_estimate_dtype(
+    intptr_t nr, intptr_t nc, void* input_cost, intptr_t dtype, bool maximize,
+    const intptr_t *subrows, intptr_t n_subrows, const intptr_t *subcols, intptr_t n_subcols,
+    intptr_t k, intptr_t objective, const struct lsap_options* options,
+    struct lsap_estimate* estimate);
+
+/* Result of lsap_verify_dtype, costs in the sign of the cost matrix. */
+struct lsap_certificate {
+   bool valid;              /* min(nr, nc) distinct pairs of finite entries */
+   bool proven_optimal;     /* valid and gap within tol of the cost */
+   double cost;             /* sum of the assigned entries */
+   double bound;            /* on the optimal cost, from below when minimizing */
+   double gap;              /* cost - bound when minimizing, NAN if not valid */
+   double max_violation;    /* of dual feasibility by u and v */
+   double max_slack;        /* of complementary slackness by u and v */
+};
+
+/* Check the assignment a[t], b[t] of n pairs, indices of the cost matrix
+   like the result of lsap_solve_dtype, and
+   bound its suboptimality.  u and v, of the length of the subscripts or
+   of the shape, are optional duals: u_i + v_j <= c_ij (>= when
+   maximizing).  Without them the bound is that of the row and, for square
+   views, column minima.  The rows are scanned on up to n_threads threads. */
+LSAP_API int lsap_verify_dtype(
+    intptr_t nr, intptr_t nc, void* input_cost, intptr_t dtype, bool maximize,
+    const intptr_t *subrows, intptr_t n_subrows, const intptr_t *subcols, intptr_t n_subcols,
+    const int64_t* a, const int64_t* b, intptr_t n, const double* u, const double* v,
+    double tol, intptr_t n_threads, struct lsap_certificate* certificate);
+
+/* Solve the cost matrix of dtype (enum LSAP_TYPES), subscripted by
+   subrows and subcols unless NULL, for k pairs or all of them when k < 0.
+   options may be NULL for the defaults of lsap_options_init. */
+LSAP_API int lsap_solve_dtype(
+    intptr_t nr, intptr_t nc, void* input_cost, intptr_t dtype, bool maximize,
+    const intptr_t *subrows, intptr_t n_subrows, const intptr_t *subcols, intptr_t n_subcols,
+    intptr_t k, intptr_t objective, const struct lsap_options* options,
+    int64_t* a, int64_t* b);
+
+/* lsap_solve_dtype of all pairs under the sum objective and the default
+   options, the signature of the first releases. */
+LSAP_API int solve_rectangular_linear_sum_assignment_dtype(
     intptr_t nr, intptr_t nc, void* input_cost, intptr_t dtype, bool maximize,
     const intptr_t *subrows, intptr_t n_subrows, const intptr_t *subcols, intptr_t n_subcols,
     int64_t* a, int64_t* b);
 
+/* Minimize the largest assigned entry instead of the sum.  With refine the
+   sum is minimized among the assignments with the smallest largest entry.
+   Only options->memory_limit is used, options may be NULL. */
+LSAP_API int bottleneck_rectangular_linear_sum_assignment_dtype(
+    intptr_t nr, intptr_t nc, void* input_cost, intptr_t dtype, bool maximize,
+    const intptr_t *subrows, intptr_t n_subrows, const intptr_t *subcols, intptr_t n_subcols,
+    intptr_t k, bool refine, const struct lsap_options* options, int64_t* a, int64_t* b);
+
+/* Approximate assignment by log-domain Sinkhorn scaling and rounding, exact
+   with options->repair. */
+LSAP_API int sinkhorn_rectangular_linear_sum_assignment_dtype(
+    intptr_t nr, intptr_t nc, void* input_cost, intptr_t dtype, bool maximize,
+    const intptr_t *subrows, intptr_t n_subrows, const intptr_t *subcols, intptr_t n_subcols,
+    const struct lsap_options* options, int64_t* a, int64_t* b);
+
+/* Greedy matching of the cheapest entries of every row improved by local
+   search.  When not NULL, *p_cost receives the cost of the assignment and
+   *p_bound a dual bound on the optimal cost, from below when minimizing
+   and from above when maximizing. */
+LSAP_API int greedy_rectangular_linear_sum_assignment_dtype(
+    intptr_t nr, intptr_t nc, void* input_cost, intptr_t dtype, bool maximize,
+    const intptr_t *subrows, intptr_t n_subrows, const intptr_t *subcols, intptr_t n_subcols,
+    const struct lsap_options* options, int64_t* a, int64_t* b,
+    double* p_cost, double* p_bound);
+
+/* Coarse-to-fine assignment of the nx points x to the ny points y, both
+   row major with dim coordinates, under the cost metric (enum
+   LSAP_METRICS).  At most max_clusters clusters per set form the coarsest
+   level, finer levels of clusters and then the points are solved from the
+   potentials of the coarser one on sparse candidates, n_candidates of
+   lowest reduced cost per row among them.  The assignment is optimal, the
+   pairs of negative reduced cost outside the candidates are added until
+   there are none. */
+LSAP_API int multiscale_rectangular_linear_sum_assignment(
+    intptr_t nx, intptr_t ny, intptr_t dim, const double* x, const double* y,
+    intptr_t metric, intptr_t n_candidates, intptr_t max_clusters, intptr_t n_threads,
+    int64_t* a, int64_t* b);
+
+/* The k best assignments in order of increasing cost (decreasing when
+   maximizing).  a and b receive k rows of min(nr, nc) indices each, costs
+   the k assignment costs.  Fewer than k assignments may exist, the number
+   written is stored in *p_found. */
+LSAP_API int k_best_rectangular_linear_sum_assignment_dtype(
+    intptr_t nr, intptr_t nc, void* input_cost, intptr_t dtype, bool maximize,
+    const intptr_t *subrows, intptr_t n_subrows, const intptr_t *subcols, intptr_t n_subcols,
+    intptr_t k, intptr_t n_threads, int64_t* a, int64_t* b, double* costs,
+    intptr_t* p_found);
+
+/* Axial 3-D assignment of the n1 x n2 x n3 cost tensor: min(n1, n2, n3)
+   triples, every index used at most once, by Lagrangian relaxation of the
+   largest axis.  a, b and c receive the triples sorted by a.  bounds
+   receives 2 * max_iter doubles, the best primal and dual bound after
+   every iteration, and *p_n_iter the number of iterations run. */
+LSAP_API int axial_assignment_dtype(
+    intptr_t n1, intptr_t n2, intptr_t n3, void* input_cost, intptr_t dtype, bool maximize,
+    intptr_t max_iter, intptr_t n_threads, int64_t* a, int64_t* b, int64_t* c,
+    double* bounds, intptr_t* p_n_iter);
+
+/* Optimal transport of the masses supply (one per row) to demand (one per
+   column), the earth mover's distance when the costs are distances.  When
+   the totals differ only the smaller one is moved.  The nonzero flows are
+   written to a, b and flow, at most min(nr, nc) + max(nr, nc) entries; their
+   number is stored in *p_n_flow and the total cost in *p_cost.  max_iter < 0
+   does not limit the number of simplex pivots. */
+LSAP_API int transport_dtype(
+    intptr_t nr, intptr_t nc, void* input_cost, intptr_t dtype, bool maximize,
+    const double* supply, const double* demand,
+    const intptr_t *subrows, intptr_t n_subrows, const intptr_t *subcols, intptr_t n_subcols,
+    intptr_t max_iter, int64_t* a, int64_t* b, double* flow, intptr_t* p_n_flow,
+    double* p_cost);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,868 @@
+/*
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+1. Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following
+   disclaimer in the documentation and/or other materials provided
+   with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived
+   from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+/*
+Internal helpers shared by the solvers in this directory: the zero-copy
+cost view, input validation, dtype dispatch and the shortest augmenting
+path step.  Not part of the public interface.  The sparse engine, the
+warm start and the thread pool of the engines are in sparse_solver.h,
+warm_start.h and parallel_for.h.
+*/
+
+#ifndef RECTANGULAR_LSAP_IMPL_H
+#define RECTANGULAR_LSAP_IMPL_H
+
+#include <cmath>
+#include <chrono>
+#include <vector>
+#include <random>
+#include <numeric>
+#include <algorithm>
+#include <functional>
+#include "rectangular_lsap.h"
+#include "probes.h"
+
+// Expand BODY once for every element type of enum LSAP_TYPES, with T
+// naming the C type.  BODY is expected to return.
+#define LSAP_DTYPE_SWITCH(dtype, T, ...) \
+    switch (dtype) { \
+    case LSAP_BOOL: { typedef bool T; __VA_ARGS__; } \
+    case LSAP_BYTE: { typedef signed char T; __VA_ARGS__; } \
+    case LSAP_UBYTE: { typedef unsigned char T; __VA_ARGS__; } \
+    case LSAP_SHORT: { typedef short T; __VA_ARGS__; } \
+    case LSAP_USHORT: { typedef unsigned short T; __VA_ARGS__; } \
+    case LSAP_INT: { typedef int T; __VA_ARGS__; } \
+    case LSAP_UINT: { typedef unsigned int T; __VA_ARGS__; } \
+    case LSAP_LONG: { typedef long T; __VA_ARGS__; } \
+    case LSAP_ULONG: { typedef unsigned long T; __VA_ARGS__; } \
+    case LSAP_LONGLONG: { typedef long long T; __VA_ARGS__; } \
+    case LSAP_ULONGLONG: { typedef unsigned long long T; __VA_ARGS__; } \
+    case LSAP_FLOAT: { typedef float T; __VA_ARGS__; } \
+    case LSAP_DOUBLE: { typedef double T; __VA_ARGS__; } \
+    case LSAP_LONGDOUBLE: { typedef long double T; __VA_ARGS__; } \
+    default: \
+        return RECTANGULAR_LSAP_DTYPE_INVALID; \
+    }
+
+// Entry (i, j) of the nr x nc cost matrix is d[i * stride + j], stride is
+// nc for C order.
+template <typename T> class matrix2d {
+public:
+    matrix2d(const T *d, intptr_t nr, intptr_t nc)
+            : matrix2d(d, nr, nc, nc) {
+    }
+    matrix2d(const T *d, intptr_t nr, intptr_t nc, intptr_t stride)
+            : m_d(d), m_nr(nr), m_nc(nc), m_stride(stride),
+            m_transpose(false), m_negative(false),
+            m_subrows(nullptr), m_subcols(nullptr)  {
+    }
+    double get(intptr_t i, intptr_t j) const {
+        double r;
+        if (this->m_transpose) {
+            std::swap(i, j);
+        }
+        if (this->m_subrows != nullptr) {
+            i = this->m_subrows[i];
+        }
+        if (this->m_subcols != nullptr) {
+            j = this->m_subcols[j];
+        }
+        r = this->m_d[i * m_stride + j];
+        if (this->m_negative) {
+            r = -r;
+        }
+        return r;
+    }
+    void transpose() {
+        this->m_transpose = !this->m_transpose;
+    }
+    void negative() {
+        this->m_negative = !this->m_negative;
+    }
+    void subscript(const intptr_t *subrows, const intptr_t *subcols) {
+        this->m_subrows = subrows;
+        this->m_subcols = subcols;
+    }
+    intptr_t stride() const {
+        return this->m_stride;
+    }
+private:
+    const T *m_d;
+    intptr_t m_nr;
+    intptr_t m_nc;
+    intptr_t m_stride;
+    bool m_transpose;
+    bool m_negative;
+    const intptr_t *m_subrows;
+    const intptr_t *m_subcols;
+};
+
+template <typename T> static std::vector<intptr_t> argsort_iter(const std::vector<T> &v)
+{
+    std::vector<intptr_t> index(v.size());
+    std::iota(index.begin(), index.end(), 0);
+    std::sort(index.begin(), index.end(), [&v](intptr_t i, intptr_t j)
+              {return v[i] < v[j];});
+    return index;
+}
+
+// Work counters of solve_from.  The solvers are instantiated with
+// path_counters<false> unless lsap_options.stats is set, every update is
+// guarded by enabled so that instantiation compiles them away.
+template <bool Enabled> struct path_counters {
+    static const bool enabled = Enabled;
+    intptr_t augmentations = 0;
+    intptr_t columns_scanned = 0;
+    intptr_t path_length_total = 0;
+    intptr_t path_length_max = 0;
+    intptr_t dual_updates = 0;
+    intptr_t tie_breaks = 0;
+    double augment_seconds = 0;
+    // every augmentation, timed from origin, when not nullptr
+    struct lsap_trace* trace = nullptr;
+    std::chrono::steady_clock::time_point origin;
+};
+
+typedef path_counters<false> no_counters;
+
+static inline double
+seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// M is any cost view providing double get(i, j), e.g. matrix2d.
+template <typename M, typename S> static intptr_t
+augmenting_path(intptr_t nc, const M& cost, const std::vector<double>& u,
+                const std::vector<double>& v, std::vector<intptr_t>& path,
+                const std::vector<intptr_t>& row4col,
+                std::vector<double>& shortestPathCosts, intptr_t i,
+                std::vector<bool>& SR, std::vector<bool>& SC,
+                std::vector<intptr_t>& remaining, double* p_minVal, S& counters)
+{
+    double minVal = 0;
+
+    // Crouse's pseudocode uses set complements to keep track of remaining
+    // nodes.  Here we use a vector, as it is more efficient in C++.
+    intptr_t num_remaining = nc;
+    for (intptr_t it = 0; it < nc; it++) {
+        // Filling this up in reverse order ensures that the solution of a
+        // constant cost matrix is the identity matrix (c.f. #11602).
+        remaining[it] = nc - it - 1;
+    }
+
+    std::fill(SR.begin(), SR.end(), false);
+    std::fill(SC.begin(), SC.end(), false);
+    std::fill(shortestPathCosts.begin(), shortestPathCosts.end(), INFINITY);
+
+    // find shortest augmenting path
+    intptr_t sink = -1;
+    while (sink == -1) {
+
+        intptr_t index = -1;
+        double lowest = INFINITY;
+        SR[i] = true;
+        if (S::enabled) {
+            counters.columns_scanned += num_remaining;
+        }
+
+        for (intptr_t it = 0; it < num_remaining; it++) {
+            intptr_t j = remaining[it];
+
+            double r = minVal + cost.get(i, j) - u[i] - v[j];
+            if (r < shortestPathCosts[j]) {
+                path[j] = i;
+                shortestPathCosts[j] = r;
+            }
+
+            // When multiple nodes have the minimum cost, we select one which
+            // gives us a new sink node. This is particularly important for
+            // integer cost matrices with small co-efficients.
+            if (shortestPathCosts[j] < lowest ||
+                (shortestPathCosts[j] == lowest && row4col[j] == -1)) {
+                if (S::enabled && shortestPathCosts[j] == lowest && lowest < INFINITY) {
+                    counters.tie_breaks++;
+                }
+                lowest = shortestPathCosts[j];
+                index = it;
+            }
+        }
+
+        minVal = lowest;
+        if (minVal == INFINITY) { // infeasible cost matrix
+            return -1;
+        }
+
+        intptr_t j = remaining[index];
+        if (row4col[j] == -1) {
+            sink = j;
+        } else {
+            i = row4col[j];
+        }
+
+        SC[j] = true;
+        remaining[index] = remaining[--num_remaining];
+    }
+
+    *p_minVal = minVal;
+    return sink;
+}
+
+template <typename M> static intptr_t
+augmenting_path(intptr_t nc, const M& cost, const std::vector<double>& u,
+                const std::vector<double>& v, std::vector<intptr_t>& path,
+                const std::vector<intptr_t>& row4col,
+                std::vector<double>& shortestPathCosts, intptr_t i,
+                std::vector<bool>& SR, std::vector<bool>& SC,
+                std::vector<intptr_t>& remaining, double* p_minVal)
+{
+    no_counters counters;
+    return augmenting_path(nc, cost, u, v, path, row4col, shortestPathCosts, i,
+                           SR, SC, remaining, p_minVal, counters);
+}
+
+// Write the assigned pairs into a and b, sorted by row index of the
+// original cost matrix.  Unassigned rows (col4row[i] == -1) are skipped.
+static inline int
+write_result(intptr_t nr, const std::vector<intptr_t>& col4row, bool transpose,
+             const intptr_t *subrows, const intptr_t *subcols,
+             int64_t* a, int64_t* b)
+{
+    intptr_t n = 0;
+    if (transpose) {
+        for (auto v: argsort_iter(col4row)) {
+            if (col4row[v] < 0) {
+                continue;
+            }
+            a[n] = col4row[v];
+            b[n] = v;
+            n++;
+        }
+    }
+    else {
+        for (intptr_t i = 0; i < nr; i++) {
+            if (col4row[i] < 0) {
+                continue;
+            }
+            a[n] = i;
+            b[n] = col4row[i];
+            n++;
+        }
+    }
+
+    for (intptr_t i = 0; i < n; i++) {
+        if (subrows != nullptr) {
+            a[i] = subrows[a[i]];
+        }
+        if (subcols != nullptr) {
+            b[i] = subcols[b[i]];
+        }
+    }
+
+    return 0;
+}
+
+// test for NaN and -inf entries (+inf when maximizing), rows are stride
+// entries apart
+template <typename T> static int
+check_cost(intptr_t nr, intptr_t nc, const T* cost, bool maximize, intptr_t stride)
+{
+    for (intptr_t r = 0; r < nr; r++) {
+        const T* row = cost + r * stride;
+        for (intptr_t i = 0; i < nc; i++) {
+            if (row[i] != row[i] || ((row[i] == -INFINITY) && !maximize) || ((row[i] == INFINITY) && maximize)) {
+                return RECTANGULAR_LSAP_INVALID;
+            }
+        }
+    }
+    return 0;
+}
+
+template <typename T> static int
+check_cost(intptr_t nr, intptr_t nc, const T* cost, bool maximize)
+{
+    return check_cost(nr, nc, cost, maximize, nc);
+}
+
+// check subscripts in bound, an empty subscript is replaced by nullptr.
+// notice n larger than dim is legal.
+static inline int
+check_subscript(intptr_t dim, const intptr_t **p_sub, intptr_t n)
+{
+    if (n == 0) {
+        *p_sub = nullptr;
+        return 0;
+    }
+    if (n < 0) {
+        return RECTANGULAR_LSAP_SUBSCRIPT_INVALID;
+    }
+    for (intptr_t i = 0; i < n; i++) {
+        intptr_t v = (*p_sub)[i];
+        if (v < 0 || v >= dim) {
+            return RECTANGULAR_LSAP_SUBSCRIPT_INVALID;
+        }
+    }
+    return 0;
+}
+
+// The view part of make_cost_view, for checked subscripts.
+template <typename T> static void
+setup_cost_view(intptr_t *p_nr, intptr_t *p_nc, bool maximize,
+                const intptr_t *subrows, intptr_t n_subrows,
+                const intptr_t *subcols, intptr_t n_subcols,
+                matrix2d<T>& costmat, bool *p_transpose)
+{
+    intptr_t nr = *p_nr;
+    intptr_t nc = *p_nc;
+    bool subscript = (subrows != nullptr) || (subcols != nullptr);
+    if (subscript) {
+        // a missing subscript keeps all rows or columns
+        costmat.subscript(subrows, subcols);
+        if (subrows != nullptr) {
+            nr = n_subrows;
+        }
+        if (subcols != nullptr) {
+            nc = n_subcols;
+        }
+    }
+
+    // tall rectangular cost matrix must be transposed
+    bool transpose = nc < nr;
+    if (transpose) {
+        costmat.transpose();
+        std::swap(nr, nc);
+    }
+    if (maximize) {
+        costmat.negative();
+    }
+
+    *p_nr = nr;
+    *p_nc = nc;
+    *p_transpose = transpose;
+}
+
+// Validate the input and set up the view the solvers work on: subscripted,
+// transposed so that nr <= nc, and negated when maximizing.  nr and nc are
+// updated to the shape of the view.
+template <typename T> static int
+make_cost_view(intptr_t *p_nr, intptr_t *p_nc, const T* cost, bool maximize,
+               const intptr_t **p_subrows, intptr_t n_subrows,
+               const intptr_t **p_subcols, intptr_t n_subcols,
+               matrix2d<T>& costmat, bool *p_transpose)
+{
+    intptr_t nr = *p_nr;
+    intptr_t nc = *p_nc;
+    int ret = check_cost(nr, nc, cost, maximize, costmat.stride());
+    if (ret == 0) {
+        ret = check_subscript(nr, p_subrows, n_subrows);
+    }
+    if (ret == 0) {
+        ret = check_subscript(nc, p_subcols, n_subcols);
+    }
+    if (ret != 0) {
+        return ret;
+    }
+
+    setup_cost_view(p_nr, p_nc, maximize, *p_subrows, n_subrows, *p_subcols, n_subcols,
+                    costmat, p_transpose);
+    return 0;
+}
+
+// Update the dual variables after the shortest path from curRow reached
+// sink at distance minVal, then flip the alternating path.
+static inline void
+augment(intptr_t nr, intptr_t nc, intptr_t curRow, intptr_t sink, double minVal,
+        std::vector<double>& u, std::vector<double>& v,
+        const std::vector<double>& shortestPathCosts, const std::vector<intptr_t>& path,
+        std::vector<intptr_t>& col4row, std::vector<intptr_t>& row4col,
+        const std::vector<bool>& SR, const std::vector<bool>& SC)
+{
+    u[curRow] += minVal;
+    for (intptr_t i = 0; i < nr; i++) {
+        if (SR[i] && i != curRow) {
+            u[i] += minVal - shortestPathCosts[col4row[i]];
+        }
+    }
+
+    for (intptr_t j = 0; j < nc; j++) {
+        if (SC[j]) {
+            v[j] -= minVal - shortestPathCosts[j];
+        }
+    }
+
+    intptr_t j = sink;
+    while (1) {
+        intptr_t i = path[j];
+        row4col[j] = i;
+        std::swap(col4row[i], j);
+        if (i == curRow) {
+            break;
+        }
+    }
+}
+
+// Successive shortest paths from a super-source connected to every free
+// row.  minFree[j] / argFree[j] cache the cheapest free row of each column,
+// so one augmentation only scans the rows that are already matched instead
+// of the whole matrix.  Free columns keep v[j] == 0 and free rows keep
+// u[i] == 0, so path lengths of different roots are directly comparable.
+template <typename M> static intptr_t
+augmenting_path_multisource(intptr_t nc, const M& cost, const std::vector<double>& u,
+                            const std::vector<double>& v, std::vector<intptr_t>& path,
+                            const std::vector<intptr_t>& row4col,
+                            const std::vector<double>& minFree, const std::vector<intptr_t>& argFree,
+                            std::vector<double>& shortestPathCosts,
+                            std::vector<bool>& SR, std::vector<bool>& SC,
+                            std::vector<intptr_t>& remaining, double* p_minVal)
+{
+    double minVal = 0;
+
+    intptr_t num_remaining = nc;
+    for (intptr_t it = 0; it < nc; it++) {
+        remaining[it] = nc - it - 1;
+        shortestPathCosts[it] = minFree[it] - v[it];
+        path[it] = argFree[it];
+    }
+
+    std::fill(SR.begin(), SR.end(), false);
+    std::fill(SC.begin(), SC.end(), false);
+
+    intptr_t sink = -1;
+    intptr_t i = -1;
+    while (sink == -1) {
+
+        intptr_t index = -1;
+        double lowest = INFINITY;
+
+        for (intptr_t it = 0; it < num_remaining; it++) {
+            intptr_t j = remaining[it];
+
+            if (i >= 0) {
+                double r = minVal + cost.get(i, j) - u[i] - v[j];
+                if (r < shortestPathCosts[j]) {
+                    path[j] = i;
+                    shortestPathCosts[j] = r;
+                }
+            }
+
+            if (shortestPathCosts[j] < lowest ||
+                (shortestPathCosts[j] == lowest && row4col[j] == -1)) {
+                lowest = shortestPathCosts[j];
+                index = it;
+            }
+        }
+
+        minVal = lowest;
+        if (minVal == INFINITY) { // fewer than k rows can be matched
+            return -1;
+        }
+
+        intptr_t j = remaining[index];
+        if (row4col[j] == -1) {
+            sink = j;
+        } else {
+            i = row4col[j];
+            SR[i] = true;
+        }
+
+        SC[j] = true;
+        remaining[index] = remaining[--num_remaining];
+    }
+
+    *p_minVal = minVal;
+    return sink;
+}
+
+template <typename M> static int
+solve_k(intptr_t nr, intptr_t nc, const M& cost, intptr_t k,
+        std::vector<intptr_t>& col4row)
+{
+    std::vector<double> u(nr, 0);
+    std::vector<double> v(nc, 0);
+    std::vector<double> shortestPathCosts(nc);
+    std::vector<intptr_t> path(nc, -1);
+    std::vector<intptr_t> row4col(nc, -1);
+    std::vector<bool> SR(nr);
+    std::vector<bool> SC(nc);
+    std::vector<intptr_t> remaining(nc);
+    std::vector<double> minFree(nc, INFINITY);
+    std::vector<intptr_t> argFree(nc, -1);
+
+    for (intptr_t i = 0; i < nr; i++) {
+        for (intptr_t j = 0; j < nc; j++) {
+            double c = cost.get(i, j);
+            if (c < minFree[j]) {
+                minFree[j] = c;
+                argFree[j] = i;
+            }
+        }
+    }
+
+    for (intptr_t curK = 0; curK < k; curK++) {
+
+        double minVal;
+        intptr_t sink = augmenting_path_multisource(nc, cost, u, v, path, row4col,
+                                                    minFree, argFree, shortestPathCosts,
+                                                    SR, SC, remaining, &minVal);
+        if (sink < 0) {
+            return RECTANGULAR_LSAP_INFEASIBLE;
+        }
+
+        // the root of the path is the first free row met walking back from the sink
+        intptr_t root = path[sink];
+        while (col4row[root] != -1) {
+            root = path[col4row[root]];
+        }
+
+        // update dual variables and augment previous solution
+        augment(nr, nc, root, sink, minVal, u, v, shortestPathCosts, path,
+                col4row, row4col, SR, SC);
+
+        // root is no longer free, refresh the columns it was cheapest for
+        for (intptr_t j = 0; j < nc; j++) {
+            if (argFree[j] != root) {
+                continue;
+            }
+            minFree[j] = INFINITY;
+            argFree[j] = -1;
+            for (intptr_t i = 0; i < nr; i++) {
+                if (col4row[i] != -1) {
+                    continue;
+                }
+                double c = cost.get(i, j);
+                if (c < minFree[j]) {
+                    minFree[j] = c;
+                    argFree[j] = i;
+                }
+            }
+        }
+    }
+
+    return 0;
+}
+
+// The arrays augmenting_path works in, sized by resize.
+struct search_scratch {
+    std::vector<double> shortestPathCosts;
+    std::vector<intptr_t> path;
+    std::vector<bool> SR;
+    std::vector<bool> SC;
+    std::vector<intptr_t> remaining;
+
+    void resize(intptr_t nr, intptr_t nc) {
+        shortestPathCosts.resize(nc);
+        path.assign(nc, -1);
+        SR.resize(nr);
+        SC.resize(nc);
+        remaining.resize(nc);
+    }
+};
+
+// Assign the free rows one shortest augmenting path at a time.  u and v
+// must be feasible (cost - u - v >= 0) and tight on the matched pairs, and
+// the free columns must share the largest v, see warm_start.  The rows are
+// taken in index order, or in the order of the permutation order if not
+// nullptr.
+template <typename M, typename S> static int
+solve_from(intptr_t nr, intptr_t nc, const M& cost,
+           std::vector<double>& u, std::vector<double>& v,
+           std::vector<intptr_t>& col4row, std::vector<intptr_t>& row4col,
+           const intptr_t* order, search_scratch& scratch, S& counters)
+{
+    scratch.resize(nr, nc);
+    std::vector<double>& shortestPathCosts = scratch.shortestPathCosts;
+    std::vector<intptr_t>& path = scratch.path;
+    std::vector<bool>& SR = scratch.SR;
+    std::vector<bool>& SC = scratch.SC;
+    std::vector<intptr_t>& remaining = scratch.remaining;
+
+    // iteratively build the solution
+    for (intptr_t t = 0; t < nr; t++) {
+        intptr_t curRow = order != nullptr ? order[t] : t;
+        if (col4row[curRow] != -1) {
+            continue;
+        }
+
+        std::chrono::steady_clock::time_point start;
+        intptr_t scanned = 0;
+        if (S::enabled) {
+            start = std::chrono::steady_clock::now();
+            scanned = counters.columns_scanned;
+        }
+        double minVal;
+        intptr_t sink = augmenting_path(nc, cost, u, v, path, row4col,
+                                        shortestPathCosts, curRow, SR, SC,
+                                        remaining, &minVal, counters);
+        double seconds = 0;
+        if (S::enabled) {
+            seconds = seconds_since(start);
+            counters.augment_seconds += seconds;
+        }
+        if (sink < 0) {
+            return RECTANGULAR_LSAP_INFEASIBLE;
+        }
+
+        intptr_t length = 0;
+        if (S::enabled || LSAP_PROBE_ENABLED(augment)) {
+            // rows of the alternating path
+            length = 1;
+            for (intptr_t i = path[sink]; i != curRow; i = path[col4row[i]]) {
+                length++;
+            }
+            LSAP_PROBE3(augment, curRow, sink, length);
+        }
+        if (S::enabled) {
+            // and the duals augment changes
+            counters.augmentations++;
+            counters.path_length_total += length;
+            counters.path_length_max = std::max(counters.path_length_max, length);
+            counters.dual_updates += std::count(SR.begin(), SR.end(), true) +
+                                     std::count(SC.begin(), SC.end(), true);
+            if (counters.trace != nullptr && counters.trace->capacity > 0) {
+                struct lsap_trace* trace = counters.trace;
+                struct lsap_trace_event& event = trace->events[trace->count % trace->capacity];
+                event.row = curRow;
+                event.path_length = length;
+                event.columns_scanned = counters.columns_scanned - scanned;
+                event.start = std::chrono::duration<double>(start - counters.origin).count();
+                event.duration = seconds;
+                event.path_cost = minVal;
+                trace->count++;
+            }
+        }
+
+        // update dual variables and augment previous solution
+        augment(nr, nc, curRow, sink, minVal, u, v, shortestPathCosts, path,
+                col4row, row4col, SR, SC);
+    }
+
+    return 0;
+}
+
+template <typename M, typename S> static int
+solve_from(intptr_t nr, intptr_t nc, const M& cost,
+           std::vector<double>& u, std::vector<double>& v,
+           std::vector<intptr_t>& col4row, std::vector<intptr_t>& row4col,
+           const intptr_t* order, S& counters)
+{
+    search_scratch scratch;
+    return solve_from(nr, nc, cost, u, v, col4row, row4col, order, scratch, counters);
+}
+
+template <typename M> static int
+solve_from(intptr_t nr, intptr_t nc, const M& cost,
+           std::vector<double>& u, std::vector<double>& v,
+           std::vector<intptr_t>& col4row, std::vector<intptr_t>& row4col,
+           const intptr_t* order = nullptr)
+{
+    no_counters counters;
+    return solve_from(nr, nc, cost, u, v, col4row, row4col, order, counters);
+}
+
+// The order of the rows for solve_from, enum LSAP_ROW_ORDERS, from one pass
+// over the view that keeps the cheapest and second cheapest entry of every
+// row.  Returns false for index order, which needs no permutation.
+template <typename M> static bool
+row_order(intptr_t nr, intptr_t nc, const M& cost, intptr_t kind,
+          std::vector<intptr_t>& order)
+{
+    if (kind == LSAP_ROW_ORDER_INDEX) {
+        return false;
+    }
+    order.resize(nr);
+    for (intptr_t i = 0; i < nr; i++) {
+        order[i] = i;
+    }
+    if (kind == LSAP_ROW_ORDER_RANDOM) {
+        // a fixed seed keeps the solver deterministic
+        std::mt19937 rng(0);
+        std::shuffle(order.begin(), order.end(), rng);
+        return true;
+    }
+
+    std::vector<double> key(nr);
+    for (intptr_t i = 0; i < nr; i++) {
+        double first = INFINITY, second = INFINITY;
+        for (intptr_t j = 0; j < nc; j++) {
+            double c = cost.get(i, j);
+            second = std::min(second, std::max(first, c));
+            first = std::min(first, c);
+        }
+        if (kind == LSAP_ROW_ORDER_REGRET) {
+            // the largest gap first, a single column is an infinite gap
+            key[i] = first == INFINITY ? 0 : -(second - first);
+        } else {
+            key[i] = first;
+        }
+    }
+    std::stable_sort(order.begin(), order.end(), [&](intptr_t s, intptr_t t) {
+        return key[s] < key[t];
+    });
+    return true;
+}
+
+// Solve on a prepared cost view with nr <= nc.  k < 0 assigns all rows,
+// otherwise only the cheapest k pairs.  Full assignments take the rows in
+// the order given by row_order, enum LSAP_ROW_ORDERS.
+template <typename M> static int
+solve_view(intptr_t nr, intptr_t nc, const M& cost, intptr_t k,
+           std::vector<intptr_t>& col4row, intptr_t kind = LSAP_ROW_ORDER_INDEX)
+{
+    if (k >= 0 && k < nr) {
+        return solve_k(nr, nc, cost, k, col4row);
+    }
+
+    // initialize variables
+    std::vector<double> u(nr, 0);
+    std::vector<double> v(nc, 0);
+    std::vector<intptr_t> row4col(nc, -1);
+    std::vector<intptr_t> order;
+    bool ordered = row_order(nr, nc, cost, kind, order);
+    return solve_from(nr, nc, cost, u, v, col4row, row4col,
+                      ordered ? order.data() : nullptr);
+}
+
+// Bytes of the arrays the engines allocate for a view of nr <= nc, at the
+// largest phase of a solve.  The cost matrix, the result and allocator
+// overhead are not counted, nor the temporary buffer std::stable_sort may
+// take for the row order.
+static inline intptr_t
+bit_vector_bytes(intptr_t n)
+{
+    return (n + 63) / 64 * 8;
+}
+
+// scratch of augmenting_path: shortestPathCosts, path, remaining, SR, SC
+static inline intptr_t
+search_workspace_bytes(intptr_t nr, intptr_t nc)
+{
+    return nc * (sizeof(double) + 2 * sizeof(intptr_t)) +
+           bit_vector_bytes(nr) + bit_vector_bytes(nc);
+}
+
+// solve_view: u, v, col4row and row4col with the row order, then the search
+static inline intptr_t
+exact_workspace_bytes(intptr_t nr, intptr_t nc, intptr_t k, intptr_t kind)
+{
+    intptr_t base = (nr + nc) * (sizeof(double) + sizeof(intptr_t));
+    if (k >= 0 && k < nr) {
+        // solve_k also keeps minFree and argFree
+        return base + search_workspace_bytes(nr, nc) + nc * (sizeof(double) + sizeof(intptr_t));
+    }
+    intptr_t keys = 0;
+    if (kind != LSAP_ROW_ORDER_INDEX) {
+        base += nr * sizeof(intptr_t);
+        if (kind != LSAP_ROW_ORDER_RANDOM) {
+            keys = nr * sizeof(double);
+        }
+    }
+    return base + std::max(keys, search_workspace_bytes(nr, nc));
+}
+
+// solve_sparse with nnz finite entries: the CSR arrays, u, v, col4row,
+// row4col and sparse_solver, whose heap and lists are at most nc long
+static inline intptr_t
+sparse_workspace_bytes(intptr_t nr, intptr_t nc, intptr_t nnz)
+{
+    return nnz * (sizeof(double) + sizeof(intptr_t)) + (nr + 1) * sizeof(intptr_t) +
+           (nr + nc) * (sizeof(double) + sizeof(intptr_t)) +
+           nc * (sizeof(double) + 5 * sizeof(intptr_t) + 1) + nr * sizeof(intptr_t);
+}
+
+// defined with the engines
+intptr_t sinkhorn_workspace_bytes(intptr_t nr, intptr_t nc, bool repair);
+intptr_t greedy_workspace_bytes(intptr_t nr, intptr_t nc, intptr_t n_threads, bool bound);
+intptr_t bottleneck_workspace_bytes(intptr_t nr, intptr_t nc, intptr_t k, bool refine);
+
+// The threads worth starting for a pass over entries entries, at most
+// n_threads, see lsap_tuning.
+intptr_t tuned_threads(intptr_t n_threads, intptr_t entries);
+
+// Whether bytes of workspace fit in options->memory_limit, always without
+// options.
+static inline bool
+within_memory_limit(const struct lsap_options* options, intptr_t bytes)
+{
+    return options == nullptr || options->memory_limit < 0 || bytes <= options->memory_limit;
+}
+
+// Cost matrix in compressed sparse row form, entries missing from a row
+// are forbidden.  The columns and costs of row i are at positions
+// [indptr[i], indptr[i + 1]) of indices and data.
+struct sparse_cost {
+    intptr_t nr;
+    intptr_t nc;
+    std::vector<intptr_t> indptr;
+    std::vector<intptr_t> indices;
+    std::vector<double> data;
+};
+
+// The arrays of an exact solve, kept by an lsap_solver handle so that its
+// solves reuse their capacity.  After a full assignment by the dense or
+// sparse engine u and v are the duals of the view, see lsap_solver_duals.
+struct exact_workspace {
+    std::vector<double> u;
+    std::vector<double> v;
+    std::vector<intptr_t> col4row;
+    std::vector<intptr_t> row4col;
+    std::vector<intptr_t> order;
+    search_scratch scratch;
+    sparse_cost sparse;
+    bool duals = false;
+    bool transpose = false;     // of the view
+};
+
+// lsap_solve_dtype on a cost matrix with rows
+// stride entries apart, the exact engine working in ws unless nullptr.  The
+// other engines need stride == nc, RECTANGULAR_LSAP_STRIDE_INVALID otherwise.
+int lsap_solve_strided(
+    intptr_t nr, intptr_t nc, intptr_t stride, void* input_cost, intptr_t dtype, bool maximize,
+    const intptr_t *subrows, intptr_t n_subrows, const intptr_t *subcols, intptr_t n_subcols,
+    intptr_t k, intptr_t objective, const struct lsap_options* options,
+    exact_workspace* ws, int64_t* a, int64_t* b);
+
+// The engines behind the _dtype entry points of the same name, for
+// dispatch, which fire no validation__fail probe of their own.
+int lsap_bottleneck_dtype(
+    intptr_t nr, intptr_t nc, void* input_cost, intptr_t dtype, bool maximize,
+    const intptr_t *subrows, intptr_t n_subrows, const intptr_t *subcols, intptr_t n_subcols,
+    intptr_t k, bool refine, const struct lsap_options* options, int64_t* a, int64_t* b);
+int lsap_sinkhorn_dtype(
+    intptr_t nr, intptr_t nc, void* input_cost, intptr_t dtype, bool maximize,
+    const intptr_t *subrows, intptr_t n_subrows, const intptr_t *subcols, intptr_t n_subcols,
+    const struct lsap_options* options, int64_t* a, int64_t* b);
+int lsap_greedy_dtype(
+    intptr_t nr, intptr_t nc, void* input_cost, intptr_t dtype, bool maximize,
+    const intptr_t *subrows, intptr_t n_subrows, const intptr_t *subcols, intptr_t n_subcols,
+    const struct lsap_options* options, int64_t* a, int64_t* b,
+    double* p_cost, double* p_bound);
+
+#endif
@@ -0,0 +1,493 @@
+/*
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+1. Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following
+   disclaimer in the documentation and/or other materials provided
+   with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived
+   from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+Approximate assignment by entropic regularization (Sinkhorn).  Rows carry
+mass 1, the columns with a finite entry share the nr rows and the others
+get none.  The iterations work on the kernel K = exp((f + g - C) / eps),
+kept as floats, and scaling vectors a and b: a row pass sets
+a = 1 / (K b), a column pass b = mass / (K^T a), two passes of
+multiply-adds over the kernel instead of the log-sum-exp of every entry.
+The scalings are absorbed into the dual potentials f and g only when one
+leaves [1e-50, 1e50], K becoming a K b, and a row or column whose sum
+underflowed gets the update of the log domain and its kernel entries
+anew.
+
+Epsilon starts at the final value times the power of two just above the
+cost range and is halved down to it.  A stage ends when the mean L1 error
+of the row marginals is below SINKHORN_STAGE_TOLERANCE, the last one at
+the requested tolerance.  Between stages the scalings are absorbed and the
+kernel squared, exp((f + g - C) / (eps / 2)) = (a K b)^2, so exp is only
+evaluated once per entry at the start.
+
+The plan is rounded to an assignment greedily, most confident rows first,
+and a row whose column is taken is left free.  With repair the assignment
+and the column potentials warm start the exact shortest augmenting path
+solver, which assigns the free rows and fixes the rows whose pairs are not
+tight.  Without it a free row takes its best free column, or a breadth
+first augmenting path over the finite entries when all of them are
+forbidden, so only a view without a complete assignment is infeasible.
+*/
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include "rectangular_lsap.h"
+#include "rectangular_lsap_impl.h"
+#include "warm_start.h"
+#include "parallel_for.h"
+
+// columns of one work item of the column pass
+#define SINKHORN_COL_BLOCK 256
+// rows of one work item of the row pass and the kernel updates
+#define SINKHORN_ROW_BLOCK 16
+// scalings outside [1 / SINKHORN_ABSORB, SINKHORN_ABSORB] are absorbed
+#define SINKHORN_ABSORB 1e50
+// mean row marginal error that ends a stage before the last
+#define SINKHORN_STAGE_TOLERANCE 1e-1
+
+// sum of k[j] * b[j], in four sums so that the additions overlap
+static inline double
+sinkhorn_dot(const float* k, const double* b, intptr_t n)
+{
+    double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    intptr_t j = 0;
+    for (; j + 4 <= n; j += 4) {
+        s0 += k[j] * b[j];
+        s1 += k[j + 1] * b[j + 1];
+        s2 += k[j + 2] * b[j + 2];
+        s3 += k[j + 3] * b[j + 3];
+    }
+    for (; j < n; j++) {
+        s0 += k[j] * b[j];
+    }
+    return (s0 + s1) + (s2 + s3);
+}
+
+template <typename M> class sinkhorn {
+    const M& m_cost;
+    intptr_t m_nr;
+    intptr_t m_nc;
+    intptr_t m_n_threads;
+
+public:
+    sinkhorn(const M& cost, intptr_t nr, intptr_t nc, intptr_t n_threads)
+            : m_cost(cost), m_nr(nr), m_nc(nc), m_n_threads(n_threads),
+            f(nr, 0), g(nc, 0), m_a(nr, 1), m_b(nc, 1), m_row_sum(nr),
+            m_col_sum(nc), m_col_mass(nc), m_kernel(nr * nc) {
+    }
+
+    // Start at eps with f = lo, the smallest finite cost, and g = 0, so no
+    // kernel entry exceeds one.  Columns without a finite entry get no
+    // mass, the others share the nr rows.
+    void start(double eps, double lo) {
+        m_eps = eps;
+        std::fill(f.begin(), f.end(), lo);
+        for_rows([&](intptr_t i) {
+            float* k = &m_kernel[i * m_nc];
+            for (intptr_t j = 0; j < m_nc; j++) {
+                k[j] = kernel_entry(i, j);
+            }
+        });
+        intptr_t n_live = 0;
+        for (intptr_t j = 0; j < m_nc; j++) {
+            bool live = false;
+            for (intptr_t i = 0; i < m_nr && !live; i++) {
+                live = m_cost.get(i, j) != INFINITY;
+            }
+            m_col_mass[j] = live;
+            n_live += live;
+        }
+        for (intptr_t j = 0; j < m_nc; j++) {
+            m_col_mass[j] *= (double)m_nr / std::max<intptr_t>(n_live, 1);
+            m_b[j] = m_col_mass[j] > 0;
+        }
+    }
+
+    // Scale the rows to mass 1, returns the L1 error of the row marginals
+    // before the update.
+    double row_pass() {
+        for_rows([&](intptr_t i) {
+            double s = sinkhorn_dot(&m_kernel[i * m_nc], m_b.data(), m_nc);
+            m_row_sum[i] = m_a[i] * s;
+            m_a[i] = 1 / s;
+        });
+        double err = 0;
+        for (intptr_t i = 0; i < m_nr; i++) {
+            err += std::fabs(m_row_sum[i] - 1);
+            m_absorb |= !in_range(m_a[i]);
+        }
+        return err;
+    }
+
+    // scale the columns to their mass
+    void col_pass() {
+        intptr_t n_items = (m_nc + SINKHORN_COL_BLOCK - 1) / SINKHORN_COL_BLOCK;
+        parallel_for(n_items, m_n_threads, [&](intptr_t item, intptr_t) {
+            intptr_t begin = item * SINKHORN_COL_BLOCK;
+            intptr_t end = std::min(m_nc, begin + SINKHORN_COL_BLOCK);
+            double* s = m_col_sum.data();
+            std::fill(s + begin, s + end, 0.0);
+            for (intptr_t i = 0; i < m_nr; i++) {
+                const float* k = &m_kernel[i * m_nc];
+                double a = m_a[i];
+                for (intptr_t j = begin; j < end; j++) {
+                    s[j] += a * k[j];
+                }
+            }
+            for (intptr_t j = begin; j < end; j++) {
+                m_b[j] = m_col_mass[j] > 0 ? m_col_mass[j] / s[j] : 0;
+            }
+        });
+        for (intptr_t j = 0; j < m_nc; j++) {
+            m_absorb |= m_col_mass[j] > 0 && !in_range(m_b[j]);
+        }
+    }
+
+    // Whether a scaling left the range since the last absorb.
+    bool overflow() const {
+        return m_absorb;
+    }
+
+    // Move the scalings into f, g and the kernel, so that a = b = 1.  A row
+    // or column whose sum underflowed gets the update of the log domain
+    // and its kernel entries anew.  With anneal epsilon is halved as well,
+    // which squares the kernel.
+    void absorb(bool anneal) {
+        for (intptr_t i = 0; i < m_nr; i++) {
+            if (in_range(m_a[i])) {
+                f[i] += m_eps * std::log(m_a[i]);
+            }
+        }
+        for (intptr_t j = 0; j < m_nc; j++) {
+            if (in_range(m_b[j])) {
+                g[j] += m_eps * std::log(m_b[j]);
+            }
+        }
+        for (intptr_t i = 0; i < m_nr; i++) {
+            if (!in_range(m_a[i])) {
+                f[i] = shifted_row(i);
+            }
+        }
+        for (intptr_t j = 0; j < m_nc; j++) {
+            if (m_col_mass[j] > 0 && !in_range(m_b[j])) {
+                g[j] = shifted_col(j) + m_eps * std::log(m_col_mass[j]);
+            }
+        }
+        if (anneal) {
+            m_eps /= 2;
+        }
+        for_rows([&](intptr_t i) {
+            float* k = &m_kernel[i * m_nc];
+            if (!in_range(m_a[i])) {
+                for (intptr_t j = 0; j < m_nc; j++) {
+                    k[j] = kernel_entry(i, j);
+                }
+                return;
+            }
+            for (intptr_t j = 0; j < m_nc; j++) {
+                if (!in_range(m_b[j])) {
+                    k[j] = kernel_entry(i, j);
+                    continue;
+                }
+                double p = m_a[i] * k[j] * m_b[j];
+                k[j] = anneal ? p * p : p;
+            }
+        });
+        std::fill(m_a.begin(), m_a.end(), 1.0);
+        for (intptr_t j = 0; j < m_nc; j++) {
+            m_b[j] = m_col_mass[j] > 0;
+        }
+        m_absorb = false;
+    }
+
+    // free the kernel before the rounding
+    void release() {
+        std::vector<float>().swap(m_kernel);
+    }
+
+    // Most probable column of every row, rows with the most confident
+    // choice first.  A row whose column is taken stays free (-1).
+    void round(std::vector<intptr_t>& col4row, std::vector<intptr_t>& row4col) const {
+        std::vector<intptr_t> best(m_nr, -1);
+        std::vector<double> score(m_nr, -INFINITY);
+        for_rows([&](intptr_t i) {
+            for (intptr_t j = 0; j < m_nc; j++) {
+                double s = g[j] - m_cost.get(i, j);
+                if (s > score[i]) {
+                    score[i] = s;
+                    best[i] = j;
+                }
+            }
+            score[i] += f[i];
+        });
+
+        std::vector<intptr_t> order(m_nr);
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&score](intptr_t a, intptr_t b)
+                  {return score[a] > score[b];});
+        for (intptr_t i: order) {
+            intptr_t j = best[i];
+            if (j >= 0 && row4col[j] == -1) {
+                col4row[i] = j;
+                row4col[j] = i;
+            }
+        }
+    }
+
+    // Give the free rows of round the best free finite column, or a breadth
+    // first augmenting path over the finite entries if there is none.
+    int complete(std::vector<intptr_t>& col4row, std::vector<intptr_t>& row4col) const {
+        for (intptr_t i = 0; i < m_nr; i++) {
+            if (col4row[i] >= 0) {
+                continue;
+            }
+            double top = -INFINITY;
+            intptr_t jbest = -1;
+            for (intptr_t j = 0; j < m_nc; j++) {
+                double s = g[j] - m_cost.get(i, j);
+                if (row4col[j] == -1 && s > top) {
+                    top = s;
+                    jbest = j;
+                }
+            }
+            if (jbest >= 0) {
+                col4row[i] = jbest;
+                row4col[jbest] = i;
+            } else if (!augment_bfs(m_nc, m_cost, i, col4row, row4col)) {
+                return RECTANGULAR_LSAP_INFEASIBLE;
+            }
+        }
+        return 0;
+    }
+
+    std::vector<double> f;
+    std::vector<double> g;
+
+private:
+    // Run fn(i) for every row, in blocks of rows over the threads.
+    template <typename F> void for_rows(F fn) const {
+        intptr_t n_items = (m_nr + SINKHORN_ROW_BLOCK - 1) / SINKHORN_ROW_BLOCK;
+        parallel_for(n_items, m_n_threads, [&](intptr_t item, intptr_t) {
+            intptr_t end = std::min(m_nr, (item + 1) * SINKHORN_ROW_BLOCK);
+            for (intptr_t i = item * SINKHORN_ROW_BLOCK; i < end; i++) {
+                fn(i);
+            }
+        });
+    }
+
+    static bool in_range(double x) {
+        return x >= 1 / SINKHORN_ABSORB && x <= SINKHORN_ABSORB;
+    }
+
+    float kernel_entry(intptr_t i, intptr_t j) const {
+        double c = m_cost.get(i, j);
+        return c == INFINITY ? 0.0f : (float)std::exp((f[i] + g[j] - c) / m_eps);
+    }
+
+    // f[i] that scales row i to mass 1 in the log domain
+    double shifted_row(intptr_t i) const {
+        double m = -INFINITY;
+        for (intptr_t j = 0; j < m_nc; j++) {
+            if (m_col_mass[j] > 0) {
+                m = std::max(m, g[j] - m_cost.get(i, j));
+            }
+        }
+        if (m == -INFINITY) {
+            return f[i];
+        }
+        double s = 0;
+        for (intptr_t j = 0; j < m_nc; j++) {
+            if (m_col_mass[j] > 0) {
+                s += std::exp((g[j] - m_cost.get(i, j) - m) / m_eps);
+            }
+        }
+        return -m - m_eps * std::log(s);
+    }
+
+    // g[j] that scales column j to mass 1 in the log domain
+    double shifted_col(intptr_t j) const {
+        double m = -INFINITY;
+        for (intptr_t i = 0; i < m_nr; i++) {
+            m = std::max(m, f[i] - m_cost.get(i, j));
+        }
+        double s = 0;
+        for (intptr_t i = 0; i < m_nr; i++) {
+            s += std::exp((f[i] - m_cost.get(i, j) - m) / m_eps);
+        }
+        return -m - m_eps * std::log(s);
+    }
+
+    double m_eps = 1;
+    bool m_absorb = false;
+    std::vector<double> m_a;
+    std::vector<double> m_b;
+    std::vector<double> m_row_sum;
+    std::vector<double> m_col_sum;
+    std::vector<double> m_col_mass;
+    // exp((f[i] + g[j] - C[i, j]) / eps), 0 for forbidden entries
+    std::vector<float> m_kernel;
+};
+
+template <typename T> static int
+solve_sinkhorn(intptr_t nr, intptr_t nc, const T* cost, bool maximize,
+               const intptr_t *subrows, intptr_t n_subrows, const intptr_t *subcols, intptr_t n_subcols,
+               const struct lsap_options* options, int64_t* a, int64_t* b)
+{
+    // handle trivial inputs
+    if (nr == 0 || nc == 0) {
+        return 0;
+    }
+
+    matrix2d<T> costmat{cost, nr, nc};
+    bool transpose;
+    int ret = make_cost_view(&nr, &nc, cost, maximize, &subrows, n_subrows,
+                             &subcols, n_subcols, costmat, &transpose);
+    if (ret != 0) {
+        return ret;
+    }
+    if (!within_memory_limit(options, sinkhorn_workspace_bytes(nr, nc, options->repair))) {
+        return RECTANGULAR_LSAP_MEMORY_LIMIT;
+    }
+
+    // epsilon is relative to the range of the finite costs
+    double lo = INFINITY, hi = -INFINITY;
+    for (intptr_t i = 0; i < nr; i++) {
+        bool finite = false;
+        for (intptr_t j = 0; j < nc; j++) {
+            double c = costmat.get(i, j);
+            if (c != INFINITY) {
+                lo = std::min(lo, c);
+                hi = std::max(hi, c);
+                finite = true;
+            }
+        }
+        if (!finite) {
+            return RECTANGULAR_LSAP_INFEASIBLE;
+        }
+    }
+    double range = hi > lo ? hi - lo : 1;
+    double eps_final = options->epsilon * range;
+    // eps_final times a power of two, at least the range
+    intptr_t n_stages = std::max(0, (int)std::ceil(std::log2(range / eps_final)));
+    double tolerance = options->tolerance * nr;
+    double stage_tolerance = std::max(tolerance, SINKHORN_STAGE_TOLERANCE * nr);
+    intptr_t max_iter = options->max_iter;
+    intptr_t n_threads = tuned_threads(options->n_threads, nr * nc);
+
+    // A stage before the last only has to bring the potentials near those
+    // of its epsilon, the last one runs to the requested tolerance.  The
+    // kernel is only absorbed between stages and on overflow.
+    sinkhorn<matrix2d<T> > sk(costmat, nr, nc, n_threads);
+    sk.start(std::ldexp(eps_final, n_stages), lo);
+    intptr_t iter = 0;
+    for (intptr_t stage = n_stages; ; stage--) {
+        while (max_iter < 0 || iter < max_iter) {
+            double err = sk.row_pass();
+            iter++;
+            if (err < (stage == 0 ? tolerance : stage_tolerance)) {
+                break;
+            }
+            sk.col_pass();
+            if (sk.overflow()) {
+                sk.absorb(false);
+            }
+        }
+        if (stage == 0 || (max_iter >= 0 && iter >= max_iter)) {
+            break;
+        }
+        sk.absorb(true);
+    }
+    sk.absorb(false);
+    sk.release();
+
+    std::vector<intptr_t> col4row(nr, -1);
+    std::vector<intptr_t> row4col(nc, -1);
+    sk.round(col4row, row4col);
+
+    if (options->repair) {
+        // the exact solver assigns the rows round left free, and only it
+        // can tell an infeasible view
+        std::vector<double>& u = sk.f;
+        std::vector<double>& v = sk.g;
+        ret = warm_start(nr, nc, costmat, u, v, col4row, row4col);
+        if (ret == 0) {
+            ret = solve_from(nr, nc, costmat, u, v, col4row, row4col);
+        }
+    } else {
+        ret = sk.complete(col4row, row4col);
+    }
+    if (ret != 0) {
+        return ret;
+    }
+
+    return write_result(nr, col4row, transpose, subrows, subcols, a, b);
+}
+
+// f, g, the scalings, their sums, the column masses, col4row and row4col,
+// then the larger of the kernel, round() and the completion, which is the
+// repair or a breadth first search
+intptr_t
+sinkhorn_workspace_bytes(intptr_t nr, intptr_t nc, bool repair)
+{
+    intptr_t base = (3 * nr + 4 * nc) * sizeof(double) + (nr + nc) * sizeof(intptr_t);
+    intptr_t kernel = nr * nc * sizeof(float);
+    intptr_t rounding = nr * (2 * sizeof(intptr_t) + sizeof(double));
+    intptr_t completing = repair ? search_workspace_bytes(nr, nc) : (nr + nc) * sizeof(intptr_t);
+    return base + std::max(kernel, std::max(rounding, completing));
+}
+
+int lsap_sinkhorn_dtype(
+    intptr_t nr, intptr_t nc, void* input_cost, intptr_t dtype, bool maximize,
+    const intptr_t *subrows, intptr_t n_subrows, const intptr_t *subcols, intptr_t n_subcols,
+    const struct lsap_options* options, int64_t* a, int64_t* b)
+{
+    LSAP_DTYPE_SWITCH(dtype, T,
+        return solve_sinkhorn(nr, nc, (const T *)input_cost, maximize,
+                              subrows, n_subrows, subcols, n_subcols,
+                              options, a, b));
+}
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int sinkhorn_rectangular_linear_sum_assignment_dtype(
+    intptr_t nr, intptr_t nc, void* input_cost, intptr_t dtype, bool maximize,
+    const intptr_t *subrows, intptr_t n_subrows, const intptr_t *subcols, intptr_t n_subcols,
+    const struct lsap_options* options, int64_t* a, int64_t* b)
+{
+    return lsap_validated(
+        lsap_sinkhorn_dtype(nr, nc, input_cost, dtype, maximize, subrows, n_subrows,
+                            subcols, n_subcols, options, a, b), nr, nc);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,278 @@
+/*
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+1. Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following
+   disclaimer in the documentation and/or other materials provided
+   with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived
+   from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+Solver handles of the C ABI, see lsap_solver.h.  A handle owns an
+exact_workspace that the exact engine solves in, and a buffer for the
+cost matrices no engine can read in place.  A column major matrix is the
+row major matrix of the transposed problem: its rows are the columns of
+the cost matrix, so the subscripts and the result swap places, and the
+pairs are sorted by row afterwards.
+*/
+
+#include <new>
+#include <vector>
+#include <cstring>
+#include <numeric>
+#include <algorithm>
+#include "rectangular_lsap.h"
+#include "rectangular_lsap_impl.h"
+#include "lsap_solver.h"
+
+struct lsap_solver {
+    intptr_t flags;
+    exact_workspace ws;
+    std::vector<char> copy;
+    std::vector<int64_t> pairs;
+    std::vector<intptr_t> index;
+    bool has_stats;
+    struct lsap_stats stats;
+    bool has_duals;
+    std::vector<double> u;
+    std::vector<double> v;
+};
+
+static int
+item_size(intptr_t dtype, intptr_t* size)
+{
+    LSAP_DTYPE_SWITCH(dtype, T, *size = sizeof(T); return 0);
+}
+
+// Sort the n pairs of the transposed problem by row, stable so that the
+// columns of a repeated row stay in order.
+static void
+sort_pairs(lsap_solver* solver, intptr_t n, int64_t* a, int64_t* b)
+{
+    std::vector<intptr_t>& index = solver->index;
+    std::vector<int64_t>& pairs = solver->pairs;
+    index.resize(n);
+    std::iota(index.begin(), index.end(), 0);
+    std::stable_sort(index.begin(), index.end(), [&](intptr_t s, intptr_t t) {
+        return a[s] < a[t];
+    });
+    pairs.assign(a, a + n);
+    pairs.insert(pairs.end(), b, b + n);
+    for (intptr_t t = 0; t < n; t++) {
+        a[t] = pairs[index[t]];
+        b[t] = pairs[n + index[t]];
+    }
+}
+
+template <typename V> static intptr_t
+capacity_bytes(const V& v)
+{
+    return v.capacity() * sizeof(typename V::value_type);
+}
+
+static intptr_t
+capacity_bytes(const std::vector<bool>& v)
+{
+    return bit_vector_bytes(v.capacity());
+}
+
+static int
+solve(lsap_solver* solver, const struct lsap_matrix* cost, bool maximize,
+      const intptr_t *subrows, intptr_t n_subrows, const intptr_t *subcols, intptr_t n_subcols,
+      intptr_t k, intptr_t objective, const struct lsap_options* options,
+      int64_t* a, int64_t* b)
+{
+    struct lsap_options opts;
+    if (options != nullptr) {
+        opts = *options;
+    } else {
+        lsap_options_init(&opts);
+    }
+    if (opts.stats == nullptr && (solver->flags & LSAP_SOLVER_STATS)) {
+        opts.stats = &solver->stats;
+    }
+    solver->has_stats = false;
+    solver->has_duals = false;
+
+    intptr_t nr = cost->nr;
+    intptr_t nc = cost->nc;
+    intptr_t item;
+    int ret = item_size(cost->dtype, &item);
+    if (ret != 0) {
+        return lsap_validated(ret, nr, nc);
+    }
+    intptr_t row_stride = cost->row_stride != LSAP_STRIDE_C_ORDER ? cost->row_stride : nc * item;
+    intptr_t col_stride = cost->col_stride != LSAP_STRIDE_C_ORDER ? cost->col_stride : item;
+    if (row_stride % item != 0 || col_stride % item != 0) {
+        return lsap_validated(RECTANGULAR_LSAP_STRIDE_INVALID, nr, nc);
+    }
+
+    // the exact engine takes any row stride, the others C order only
+    bool strided = (opts.method == LSAP_METHOD_EXACT || opts.method == LSAP_METHOD_AUTO) &&
+                   objective == LSAP_OBJECTIVE_SUM;
+    void* data = const_cast<void*>(cost->data);
+    bool transposed = false;
+    intptr_t stride;
+    // in place only when the rows (columns) do not overlap
+    if (col_stride == item && (strided ? row_stride >= nc * item : row_stride == nc * item)) {
+        stride = row_stride / item;
+    } else if (row_stride == item &&
+               (strided ? col_stride >= nr * item : col_stride == nr * item)) {
+        transposed = true;
+        stride = col_stride / item;
+    } else {
+        solver->copy.resize(nr * nc * item);
+        char* out = solver->copy.data();
+        const char* in = static_cast<const char*>(cost->data);
+        for (intptr_t i = 0; i < nr; i++) {
+            for (intptr_t j = 0; j < nc; j++) {
+                std::memcpy(out + (i * nc + j) * item, in + i * row_stride + j * col_stride, item);
+            }
+        }
+        data = out;
+        stride = nc;
+    }
+
+    if (transposed) {
+        ret = lsap_solve_strided(nc, nr, stride, data, cost->dtype, maximize,
+                                 subcols, n_subcols, subrows, n_subrows, k, objective,
+                                 &opts, &solver->ws, b, a);
+    } else {
+        ret = lsap_solve_strided(nr, nc, stride, data, cost->dtype, maximize,
+                                 subrows, n_subrows, subcols, n_subcols, k, objective,
+                                 &opts, &solver->ws, a, b);
+    }
+    if (opts.stats != nullptr) {
+        if (opts.stats != &solver->stats) {
+            solver->stats = *opts.stats;
+        }
+        solver->has_stats = true;
+    }
+    if (ret != 0) {
+        return ret;
+    }
+
+    if (transposed) {
+        intptr_t rows = n_subrows > 0 ? n_subrows : nr;
+        intptr_t cols = n_subcols > 0 ? n_subcols : nc;
+        intptr_t n = std::min(rows, cols);
+        sort_pairs(solver, k >= 0 ? std::min(k, n) : n, a, b);
+    }
+
+    // the view may be transposed against the problem and the problem
+    // against the cost matrix
+    exact_workspace& ws = solver->ws;
+    if (ws.duals) {
+        bool flip = ws.transpose != transposed;
+        const std::vector<double>& du = flip ? ws.v : ws.u;
+        const std::vector<double>& dv = flip ? ws.u : ws.v;
+        double sign = maximize ? -1 : 1;
+        solver->u.resize(du.size());
+        solver->v.resize(dv.size());
+        for (size_t i = 0; i < du.size(); i++) {
+            solver->u[i] = sign * du[i];
+        }
+        for (size_t j = 0; j < dv.size(); j++) {
+            solver->v[j] = sign * dv[j];
+        }
+        solver->has_duals = true;
+    }
+    return 0;
+}
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int lsap_abi_version(void)
+{
+    return LSAP_ABI_VERSION;
+}
+
+lsap_solver* lsap_solver_create(intptr_t flags)
+{
+    lsap_solver* solver = new (std::nothrow) lsap_solver();
+    if (solver != nullptr) {
+        solver->flags = flags;
+    }
+    return solver;
+}
+
+void lsap_solver_destroy(lsap_solver* solver)
+{
+    delete solver;
+}
+
+int lsap_solver_solve(
+    lsap_solver* solver, const struct lsap_matrix* cost, bool maximize,
+    const intptr_t *subrows, intptr_t n_subrows, const intptr_t *subcols, intptr_t n_subcols,
+    intptr_t k, intptr_t objective, const struct lsap_options* options,
+    int64_t* a, int64_t* b)
+{
+    // no exception may cross the C ABI
+    try {
+        return solve(solver, cost, maximize, subrows, n_subrows, subcols, n_subcols,
+                     k, objective, options, a, b);
+    } catch (const std::bad_alloc&) {
+        solver->has_duals = false;
+        return RECTANGULAR_LSAP_MEMORY_LIMIT;
+    }
+}
+
+int lsap_solver_stats(const lsap_solver* solver, struct lsap_stats* stats)
+{
+    if (!solver->has_stats) {
+        return RECTANGULAR_LSAP_INVALID;
+    }
+    *stats = solver->stats;
+    return 0;
+}
+
+int lsap_solver_duals(const lsap_solver* solver, double* u, double* v)
+{
+    if (!solver->has_duals) {
+        return RECTANGULAR_LSAP_INVALID;
+    }
+    std::copy(solver->u.begin(), solver->u.end(), u);
+    std::copy(solver->v.begin(), solver->v.end(), v);
+    return 0;
+}
+
+intptr_t lsap_solver_workspace_bytes(const lsap_solver* solver)
+{
+    const exact_workspace& ws = solver->ws;
+    const search_scratch& scratch = ws.scratch;
+    return capacity_bytes(ws.u) + capacity_bytes(ws.v) + capacity_bytes(ws.col4row) +
+           capacity_bytes(ws.row4col) + capacity_bytes(ws.order) +
+           capacity_bytes(scratch.shortestPathCosts) + capacity_bytes(scratch.path) +
+           capacity_bytes(scratch.SR) + capacity_bytes(scratch.SC) +
+           capacity_bytes(scratch.remaining) + capacity_bytes(ws.sparse.indptr) +
+           capacity_bytes(ws.sparse.indices) + capacity_bytes(ws.sparse.data) +
+           capacity_bytes(solver->copy) + capacity_bytes(solver->pairs) +
+           capacity_bytes(solver->index) + capacity_bytes(solver->u) +
+           capacity_bytes(solver->v);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,372 @@
+/*
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+1. Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following
+   disclaimer in the documentation and/or other materials provided
+   with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived
+   from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+/*
+The exact engine on a sparse_cost, with its row reduction and warm
+start.  Not part of the public interface.
+*/
+
+#ifndef SPARSE_SOLVER_H
+#define SPARSE_SOLVER_H
+
+#include <cmath>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+#include "rectangular_lsap_impl.h"
+
+// Shortest augmenting paths on a sparse_cost.  Dijkstra runs on an
+// indexed binary heap and only the reached columns are reset afterwards, so
+// one augmentation costs the arcs it scans instead of a pass over all
+// columns.  The dual update is that of augment() on the visited rows and
+// columns.
+class sparse_solver {
+public:
+    explicit sparse_solver(intptr_t nc)
+            : m_dist(nc, INFINITY), m_path(nc, -1), m_pos(nc, -1), m_done(nc, 0) {
+    }
+
+    // Same contract as solve_from on a dense view.
+    int solve_from(const sparse_cost& cost, std::vector<double>& u, std::vector<double>& v,
+                   std::vector<intptr_t>& col4row, std::vector<intptr_t>& row4col) {
+        for (intptr_t curRow = 0; curRow < cost.nr; curRow++) {
+            if (col4row[curRow] == -1 && !augment_row(cost, u, v, col4row, row4col, curRow)) {
+                return RECTANGULAR_LSAP_INFEASIBLE;
+            }
+        }
+        return 0;
+    }
+
+private:
+    // heap order, free columns win ties like in augmenting_path
+    bool before(intptr_t a, intptr_t b, const std::vector<intptr_t>& row4col) const {
+        return m_dist[a] < m_dist[b] ||
+            (m_dist[a] == m_dist[b] && row4col[a] == -1 && row4col[b] != -1);
+    }
+
+    void sift_up(intptr_t k, const std::vector<intptr_t>& row4col) {
+        intptr_t j = m_heap[k];
+        while (k > 0) {
+            intptr_t p = (k - 1) / 2;
+            if (!before(j, m_heap[p], row4col)) {
+                break;
+            }
+            m_heap[k] = m_heap[p];
+            m_pos[m_heap[k]] = k;
+            k = p;
+        }
+        m_heap[k] = j;
+        m_pos[j] = k;
+    }
+
+    intptr_t pop(const std::vector<intptr_t>& row4col) {
+        intptr_t top = m_heap[0];
+        m_pos[top] = -1;
+        intptr_t j = m_heap.back();
+        m_heap.pop_back();
+        intptr_t n = m_heap.size();
+        if (n > 0) {
+            intptr_t k = 0;
+            while (true) {
+                intptr_t c = 2 * k + 1;
+                if (c >= n) {
+                    break;
+                }
+                if (c + 1 < n && before(m_heap[c + 1], m_heap[c], row4col)) {
+                    c++;
+                }
+                if (!before(m_heap[c], j, row4col)) {
+                    break;
+                }
+                m_heap[k] = m_heap[c];
+                m_pos[m_heap[k]] = k;
+                k = c;
+            }
+            m_heap[k] = j;
+            m_pos[j] = k;
+        }
+        return top;
+    }
+
+    bool augment_row(const sparse_cost& cost, std::vector<double>& u, std::vector<double>& v,
+                     std::vector<intptr_t>& col4row, std::vector<intptr_t>& row4col,
+                     intptr_t curRow) {
+        m_heap.clear();
+        m_touched.clear();
+        m_rows.clear();
+        m_cols.clear();
+
+        intptr_t sink = -1;
+        double minVal = 0;
+        intptr_t i = curRow;
+        double base = 0;
+        while (true) {
+            for (intptr_t t = cost.indptr[i]; t < cost.indptr[i + 1]; t++) {
+                intptr_t j = cost.indices[t];
+                if (m_done[j]) {
+                    continue;
+                }
+                double r = base + cost.data[t] - u[i] - v[j];
+                if (r < m_dist[j]) {
+                    if (m_dist[j] == INFINITY) {
+                        m_touched.push_back(j);
+                    }
+                    m_dist[j] = r;
+                    m_path[j] = i;
+                    if (m_pos[j] < 0) {
+                        m_heap.push_back(j);
+                        m_pos[j] = m_heap.size() - 1;
+                    }
+                    sift_up(m_pos[j], row4col);
+                }
+            }
+
+            if (m_heap.empty()) {
+                break;
+            }
+            intptr_t j = pop(row4col);
+            m_done[j] = 1;
+            if (row4col[j] == -1) {
+                sink = j;
+                minVal = m_dist[j];
+                break;
+            }
+            m_cols.push_back(j);
+            i = row4col[j];
+            m_rows.push_back(i);
+            base = m_dist[j];
+        }
+
+        if (sink >= 0) {
+            u[curRow] += minVal;
+            for (intptr_t r: m_rows) {
+                u[r] += minVal - m_dist[col4row[r]];
+            }
+            for (intptr_t c: m_cols) {
+                v[c] -= minVal - m_dist[c];
+            }
+            intptr_t j = sink;
+            while (1) {
+                intptr_t r = m_path[j];
+                row4col[j] = r;
+                std::swap(col4row[r], j);
+                if (r == curRow) {
+                    break;
+                }
+            }
+        }
+
+        for (intptr_t j: m_touched) {
+            m_dist[j] = INFINITY;
+            m_path[j] = -1;
+            m_pos[j] = -1;
+            m_done[j] = 0;
+        }
+        return sink >= 0;
+    }
+
+    std::vector<double> m_dist;
+    std::vector<intptr_t> m_path;
+    std::vector<intptr_t> m_pos;
+    std::vector<char> m_done;
+    std::vector<intptr_t> m_heap;
+    std::vector<intptr_t> m_touched;
+    std::vector<intptr_t> m_rows;
+    std::vector<intptr_t> m_cols;
+};
+
+// Augmenting row reduction of Jonker and Volgenant on a sparse_cost, an
+// auction-like start for sparse_solver.  A free row takes its cheapest
+// reduced column and lowers its v until the second cheapest one is as
+// cheap, evicting the previous owner.  Only columns that get a row have
+// their v lowered, so free columns keep the largest v.  Rows are taken up
+// at most passes times, the rest is left to the shortest paths.
+static inline void
+sparse_row_reduction(const sparse_cost& cost, std::vector<double>& v,
+                     std::vector<intptr_t>& col4row, std::vector<intptr_t>& row4col,
+                     intptr_t passes)
+{
+    std::vector<intptr_t> queue;
+    for (intptr_t i = cost.nr - 1; i >= 0; i--) {
+        if (col4row[i] == -1) {
+            queue.push_back(i);
+        }
+    }
+    intptr_t budget = passes * (intptr_t)queue.size();
+    while (!queue.empty() && budget-- > 0) {
+        intptr_t i = queue.back();
+        queue.pop_back();
+        double u1 = INFINITY, u2 = INFINITY;
+        intptr_t j1 = -1, j2 = -1;
+        for (intptr_t t = cost.indptr[i]; t < cost.indptr[i + 1]; t++) {
+            intptr_t j = cost.indices[t];
+            double r = cost.data[t] - v[j];
+            if (r < u1) {
+                u2 = u1;
+                j2 = j1;
+                u1 = r;
+                j1 = j;
+            } else if (r < u2) {
+                u2 = r;
+                j2 = j;
+            }
+        }
+        if (j1 < 0) {
+            continue;
+        }
+        intptr_t i0 = row4col[j1];
+        if (u1 < u2) {
+            if (u2 < INFINITY) {
+                v[j1] -= u2 - u1;
+            }
+        } else if (i0 >= 0 && j2 >= 0) {
+            // a tie, take the other column rather than evict
+            j1 = j2;
+            i0 = row4col[j1];
+        }
+        if (i0 >= 0) {
+            col4row[i0] = -1;
+            queue.push_back(i0);
+        }
+        row4col[j1] = i;
+        col4row[i] = j1;
+    }
+}
+
+// warm_start for a sparse_cost.  Free rows of the candidate matching take
+// their cheapest reduced column if it is still free.
+static inline int
+sparse_warm_start(const sparse_cost& cost, std::vector<double>& u, std::vector<double>& v,
+                  std::vector<intptr_t>& col4row, std::vector<intptr_t>& row4col)
+{
+    intptr_t nr = cost.nr;
+    intptr_t nc = cost.nc;
+    std::fill(row4col.begin(), row4col.end(), -1);
+    for (intptr_t i = 0; i < nr; i++) {
+        intptr_t j = col4row[i];
+        if (j >= 0 && row4col[j] == -1) {
+            row4col[j] = i;
+        } else {
+            col4row[i] = -1;
+        }
+    }
+
+    double vmax = -INFINITY;
+    for (intptr_t j = 0; j < nc; j++) {
+        if (std::isfinite(v[j])) {
+            vmax = std::max(vmax, v[j]);
+        }
+    }
+    for (intptr_t j = 0; j < nc; j++) {
+        v[j] = std::isfinite(v[j]) ? v[j] - vmax : 0;
+    }
+
+    for (intptr_t i = 0; i < nr; i++) {
+        double lowest = INFINITY;
+        intptr_t best = -1;
+        for (intptr_t t = cost.indptr[i]; t < cost.indptr[i + 1]; t++) {
+            double r = cost.data[t] - v[cost.indices[t]];
+            if (r < lowest) {
+                lowest = r;
+                best = cost.indices[t];
+            }
+        }
+        if (best < 0) {
+            return RECTANGULAR_LSAP_INFEASIBLE;
+        }
+        u[i] = lowest;
+        intptr_t j = col4row[i];
+        if (j >= 0) {
+            // keep the pair only if it is tight
+            for (intptr_t t = cost.indptr[i]; t < cost.indptr[i + 1]; t++) {
+                if (cost.indices[t] == j && cost.data[t] - v[j] > lowest) {
+                    col4row[i] = -1;
+                    row4col[j] = -1;
+                }
+            }
+        }
+        if (col4row[i] == -1 && row4col[best] == -1) {
+            row4col[best] = i;
+            col4row[i] = best;
+        }
+    }
+
+    // every column ends up matched in a square problem, any v is fine
+    if (nr == nc) {
+        return 0;
+    }
+
+    // raise the free columns to v == 0, in column major order
+    std::vector<intptr_t> colptr(nc + 1, 0);
+    for (intptr_t t = 0; t < cost.indptr[nr]; t++) {
+        colptr[cost.indices[t] + 1]++;
+    }
+    std::partial_sum(colptr.begin(), colptr.end(), colptr.begin());
+    std::vector<intptr_t> arcs(cost.indptr[nr]);
+    std::vector<intptr_t> row_of(cost.indptr[nr]);
+    std::vector<intptr_t> fill(colptr.begin(), colptr.end() - 1);
+    for (intptr_t i = 0; i < nr; i++) {
+        for (intptr_t t = cost.indptr[i]; t < cost.indptr[i + 1]; t++) {
+            arcs[fill[cost.indices[t]]++] = t;
+            row_of[t] = i;
+        }
+    }
+
+    std::vector<intptr_t> freed;
+    for (intptr_t j = 0; j < nc; j++) {
+        if (row4col[j] == -1 && v[j] < 0) {
+            freed.push_back(j);
+        }
+    }
+    while (!freed.empty()) {
+        intptr_t j = freed.back();
+        freed.pop_back();
+        if (v[j] == 0) {
+            continue;
+        }
+        v[j] = 0;
+        for (intptr_t s = colptr[j]; s < colptr[j + 1]; s++) {
+            intptr_t t = arcs[s];
+            intptr_t i = row_of[t];
+            if (cost.data[t] < u[i]) {
+                u[i] = cost.data[t];
+                if (col4row[i] >= 0) {
+                    freed.push_back(col4row[i]);
+                    row4col[col4row[i]] = -1;
+                    col4row[i] = -1;
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+#endif
@@ -0,0 +1,194 @@
+/*
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+1. Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following
+   disclaimer in the documentation and/or other materials provided
+   with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived
+   from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+This code solves the transportation problem (earth mover's distance)
+with the primal network simplex method on the complete bipartite graph
+of the cost matrix:
+
+    RK Ahuja, TL Magnanti, JB Orlin. Network Flows, chapter 11.
+    Prentice Hall, 1993
+
+The basis is a spanning tree of rows and columns stored with parent,
+depth and sibling links.  The initial tree comes from the north-west
+corner rule, entering arcs are priced in blocks over the implicit dense
+arc set, and the leaving arc is chosen so the tree stays strongly
+feasible, which prevents cycling on degenerate pivots.  Costs are read
+through matrix2d, so any dtype and subscript works without a copy.
+
+When the masses differ, a dummy row or column of zero cost absorbs the
+excess and only the smaller total mass is transported.
+*/
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include "rectangular_lsap.h"
+#include "rectangular_lsap_impl.h"
+#include "network_simplex.h"
+
+template <typename T> static int
+transport(intptr_t nr, intptr_t nc, const T* cost, bool maximize,
+          const double* supply, const double* demand,
+          const intptr_t *subrows, intptr_t n_subrows, const intptr_t *subcols, intptr_t n_subcols,
+          intptr_t max_iter, int64_t* a, int64_t* b, double* flow, intptr_t* p_n_flow,
+          double* p_cost)
+{
+    *p_n_flow = 0;
+    *p_cost = 0;
+
+    // handle trivial inputs
+    if (nr == 0 || nc == 0) {
+        return 0;
+    }
+
+    matrix2d<T> costmat{cost, nr, nc};
+    bool transpose;
+    int ret = make_cost_view(&nr, &nc, cost, maximize, &subrows, n_subrows,
+                             &subcols, n_subcols, costmat, &transpose);
+    if (ret != 0) {
+        return ret;
+    }
+    // the view rows are the original columns when transposed
+    if (transpose) {
+        std::swap(supply, demand);
+    }
+
+    double total_supply = 0, total_demand = 0;
+    for (intptr_t i = 0; i < nr; i++) {
+        if (!(supply[i] >= 0 && supply[i] < INFINITY)) {
+            return RECTANGULAR_LSAP_MASS_INVALID;
+        }
+        total_supply += supply[i];
+    }
+    for (intptr_t j = 0; j < nc; j++) {
+        if (!(demand[j] >= 0 && demand[j] < INFINITY)) {
+            return RECTANGULAR_LSAP_MASS_INVALID;
+        }
+        total_demand += demand[j];
+    }
+    if (total_supply == 0 || total_demand == 0) {
+        return 0;
+    }
+
+    // a relative difference below rounding noise is not an excess
+    double excess = total_supply - total_demand;
+    double tol = 1e-12 * std::max(total_supply, total_demand);
+    bool dummy_row = excess < -tol;
+    bool dummy_col = excess > tol;
+
+    double max_cost = 0;
+    for (intptr_t i = 0; i < nr; i++) {
+        for (intptr_t j = 0; j < nc; j++) {
+            double c = costmat.get(i, j);
+            if (c != INFINITY) {
+                max_cost = std::max(max_cost, std::fabs(c));
+            }
+        }
+    }
+    double penalty = (max_cost + 1) * 2 * (nr + nc + 2);
+
+    network_simplex<matrix2d<T> > ns(costmat, nr, nc, dummy_row, dummy_col, penalty);
+    ns.set_eps(1e-12 * (max_cost + 1));
+    std::vector<double> s(supply, supply + nr);
+    std::vector<double> d(demand, demand + nc);
+    if (dummy_row) {
+        s.push_back(-excess);
+    }
+    if (dummy_col) {
+        d.push_back(excess);
+    }
+    ns.init(s, d);
+    if (ns.run(max_iter) < 0) {
+        return RECTANGULAR_LSAP_ITERATION_LIMIT;
+    }
+
+    // collect the positive flows of real arcs, sorted like the assignment
+    std::vector<std::pair<std::pair<intptr_t, intptr_t>, double> > arcs;
+    double total = 0;
+    for (intptr_t x = 0; x < ns.R() + ns.C(); x++) {
+        intptr_t p = ns.parent[x];
+        if (p < 0 || !(ns.flow[x] > 0)) {
+            continue;
+        }
+        intptr_t i = x < ns.R() ? x : p;
+        intptr_t j = (x < ns.R() ? p : x) - ns.R();
+        if (i >= nr || j >= nc) {
+            continue;
+        }
+        double c = costmat.get(i, j);
+        if (c == INFINITY) {
+            return RECTANGULAR_LSAP_INFEASIBLE;
+        }
+        total += c * ns.flow[x];
+        if (transpose) {
+            std::swap(i, j);
+        }
+        if (subrows != nullptr) {
+            i = subrows[i];
+        }
+        if (subcols != nullptr) {
+            j = subcols[j];
+        }
+        arcs.push_back(std::make_pair(std::make_pair(i, j), ns.flow[x]));
+    }
+    std::sort(arcs.begin(), arcs.end());
+
+    for (size_t t = 0; t < arcs.size(); t++) {
+        a[t] = arcs[t].first.first;
+        b[t] = arcs[t].first.second;
+        flow[t] = arcs[t].second;
+    }
+    *p_n_flow = arcs.size();
+    *p_cost = maximize ? -total : total;
+    return 0;
+}
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int transport_dtype(
+    intptr_t nr, intptr_t nc, void* input_cost, intptr_t dtype, bool maximize,
+    const double* supply, const double* demand,
+    const intptr_t *subrows, intptr_t n_subrows, const intptr_t *subcols, intptr_t n_subcols,
+    intptr_t max_iter, int64_t* a, int64_t* b, double* flow, intptr_t* p_n_flow,
+    double* p_cost)
+{
+    return lsap_validated([&]() -> int {
+        LSAP_DTYPE_SWITCH(dtype, T,
+            return transport(nr, nc, (const T *)input_cost, maximize, supply, demand,
+                             subrows, n_subrows, subcols, n_subcols,
+                             max_iter, a, b, flow, p_n_flow, p_cost));
+    }(), nr, nc);
+}
+
+#ifdef __cplusplus
+}
+#endif
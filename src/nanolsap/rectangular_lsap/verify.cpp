@@ -0,0 +1,263 @@
+/*
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+1. Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following
+   disclaimer in the documentation and/or other materials provided
+   with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived
+   from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+Certificate check of an assignment on the view the solvers use, without
+copying the cost matrix.  On a view with nr <= nc, any u, v with
+u_i + v_j <= c_ij, and v <= 0 when nr < nc, bound the optimum from below by
+sum(u) + sum(v).  The given duals are checked for this and for
+complementary slackness, and then repaired into a feasible pair: v is
+clamped to v <= 0 when nr < nc and u_i becomes the row minimum of
+c_ij - v_j.  Their objective is a valid bound whatever the input, so the
+gap to the cost of the assignment bounds its suboptimality.  Without duals
+v = 0, and for square views v_j is then the column minimum of
+c_ij - u_i, the bound of the greedy engine.  In a rectangular view that
+column step gives nothing, as v <= 0 and c_ij - u_i >= 0.  Such a bound
+rarely closes the gap, an optimal assignment is usually only proven
+optimal with its duals.
+
+The rows are scanned in blocks on up to n_threads threads, each row in one
+pass for the row minima and the largest violation.
+*/
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include "rectangular_lsap.h"
+#include "rectangular_lsap_impl.h"
+#include "parallel_for.h"
+
+// rows of one work item of the parallel passes
+#define VERIFY_ROW_BLOCK 64
+
+// Positions of the original indices in a subscript, which may repeat
+// them; take() hands out every position once.
+class subscript_positions {
+public:
+    subscript_positions(intptr_t dim, const intptr_t* sub, intptr_t n)
+            : m_sub(sub), m_dim(dim), m_first(sub != nullptr ? dim : 0, -1),
+            m_next(sub != nullptr ? n : 0, -1), m_taken(sub != nullptr ? 0 : dim, false) {
+        for (intptr_t p = n - 1; sub != nullptr && p >= 0; p--) {
+            m_next[p] = m_first[sub[p]];
+            m_first[sub[p]] = p;
+        }
+    }
+
+    // An unused position of index in the view, -1 if there is none.
+    intptr_t take(int64_t index) {
+        if (index < 0 || index >= m_dim) {
+            return -1;
+        }
+        if (m_sub == nullptr) {
+            if (m_taken[index]) {
+                return -1;
+            }
+            m_taken[index] = true;
+            return index;
+        }
+        intptr_t p = m_first[index];
+        if (p >= 0) {
+            m_first[index] = m_next[p];
+        }
+        return p;
+    }
+
+private:
+    const intptr_t* m_sub;
+    intptr_t m_dim;
+    std::vector<intptr_t> m_first;
+    std::vector<intptr_t> m_next;
+    std::vector<bool> m_taken;
+};
+
+template <typename T> static int
+verify(intptr_t nr, intptr_t nc, const T* cost, bool maximize,
+       const intptr_t *subrows, intptr_t n_subrows, const intptr_t *subcols, intptr_t n_subcols,
+       const int64_t* a, const int64_t* b, intptr_t n, const double* u, const double* v,
+       double tol, intptr_t n_threads, struct lsap_certificate* certificate)
+{
+    intptr_t input_nr = nr;
+    intptr_t input_nc = nc;
+    matrix2d<T> costmat{cost, nr, nc};
+    bool transpose;
+    int ret = make_cost_view(&nr, &nc, cost, maximize, &subrows, n_subrows,
+                             &subcols, n_subcols, costmat, &transpose);
+    if (ret != 0) {
+        return ret;
+    }
+
+    // the pairs as col4row of the view
+    subscript_positions rows(input_nr, subrows, n_subrows);
+    subscript_positions cols(input_nc, subcols, n_subcols);
+    std::vector<intptr_t> col4row(nr, -1);
+    std::vector<bool> assigned(nc, false);
+    bool valid = n == nr;
+    double total = 0;
+    for (intptr_t t = 0; t < n && valid; t++) {
+        intptr_t i = rows.take(a[t]);
+        intptr_t j = cols.take(b[t]);
+        if (transpose) {
+            std::swap(i, j);
+        }
+        if (i < 0 || j < 0) {
+            valid = false;
+            break;
+        }
+        col4row[i] = j;
+        assigned[j] = true;
+        total += costmat.get(i, j);
+    }
+    valid = valid && total < INFINITY;
+
+    // the duals of the view, negated with it
+    bool duals = u != nullptr && v != nullptr;
+    std::vector<double> ud(nr, 0);
+    std::vector<double> vd(nc, 0);
+    if (duals) {
+        const double* du = transpose ? v : u;
+        const double* dv = transpose ? u : v;
+        double sign = maximize ? -1 : 1;
+        for (intptr_t i = 0; i < nr; i++) {
+            ud[i] = sign * du[i];
+        }
+        for (intptr_t j = 0; j < nc; j++) {
+            vd[j] = sign * dv[j];
+        }
+    }
+    std::vector<double> vf(vd);
+    if (nr < nc) {
+        for (intptr_t j = 0; j < nc; j++) {
+            vf[j] = std::min(vf[j], 0.0);
+        }
+    }
+
+    // row minima of c - vf, and of c - u - v for the violation
+    std::vector<double> uf(nr);
+    std::vector<double> violation(nr, 0);
+    intptr_t n_items = (nr + VERIFY_ROW_BLOCK - 1) / VERIFY_ROW_BLOCK;
+    n_threads = std::min(tuned_threads(n_threads, nr * nc), std::max<intptr_t>(n_items, 1));
+    parallel_for(n_items, n_threads, [&](intptr_t item, intptr_t) {
+        intptr_t end = std::min(nr, (item + 1) * VERIFY_ROW_BLOCK);
+        for (intptr_t i = item * VERIFY_ROW_BLOCK; i < end; i++) {
+            double lowest = INFINITY;
+            double reduced = INFINITY;
+            for (intptr_t j = 0; j < nc; j++) {
+                double c = costmat.get(i, j);
+                lowest = std::min(lowest, c - vf[j]);
+                reduced = std::min(reduced, c - vd[j]);
+            }
+            uf[i] = lowest;
+            violation[i] = duals ? std::max(ud[i] - reduced, 0.0) : 0.0;
+        }
+    });
+
+    // without duals a square view also gets the column minima
+    if (!duals && nr == nc) {
+        std::vector<std::vector<double> > vt(n_threads, std::vector<double>(nc, INFINITY));
+        parallel_for(n_items, n_threads, [&](intptr_t item, intptr_t tid) {
+            std::vector<double>& m = vt[tid];
+            intptr_t end = std::min(nr, (item + 1) * VERIFY_ROW_BLOCK);
+            for (intptr_t i = item * VERIFY_ROW_BLOCK; i < end; i++) {
+                for (intptr_t j = 0; j < nc; j++) {
+                    m[j] = std::min(m[j], costmat.get(i, j) - uf[i]);
+                }
+            }
+        });
+        for (intptr_t j = 0; j < nc; j++) {
+            double m = vt[0][j];
+            for (intptr_t t = 1; t < n_threads; t++) {
+                m = std::min(m, vt[t][j]);
+            }
+            vf[j] = m;
+        }
+    }
+
+    double bound = 0;
+    double max_violation = 0;
+    for (intptr_t i = 0; i < nr; i++) {
+        bound += uf[i];
+        max_violation = std::max(max_violation, violation[i]);
+    }
+    for (intptr_t j = 0; j < nc; j++) {
+        bound += vf[j];
+    }
+
+    // complementary slackness of the given duals
+    double max_slack = 0;
+    if (duals) {
+        for (intptr_t j = 0; j < nc && nr < nc; j++) {
+            max_violation = std::max(max_violation, vd[j]);
+            if (!assigned[j]) {
+                max_slack = std::max(max_slack, std::abs(vd[j]));
+            }
+        }
+        for (intptr_t i = 0; i < nr && valid; i++) {
+            intptr_t j = col4row[i];
+            max_slack = std::max(max_slack, std::abs(costmat.get(i, j) - ud[i] - vd[j]));
+        }
+    }
+
+    double gap = total - bound;
+    certificate->valid = valid;
+    certificate->cost = maximize ? -total : total;
+    certificate->bound = maximize ? -bound : bound;
+    certificate->gap = valid ? gap : NAN;
+    certificate->max_violation = max_violation;
+    certificate->max_slack = max_slack;
+    certificate->proven_optimal = valid && gap <= tol * std::max(1.0, std::abs(total));
+    return 0;
+}
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int lsap_verify_dtype(
+    intptr_t nr, intptr_t nc, void* input_cost, intptr_t dtype, bool maximize,
+    const intptr_t *subrows, intptr_t n_subrows, const intptr_t *subcols, intptr_t n_subcols,
+    const int64_t* a, const int64_t* b, intptr_t n, const double* u, const double* v,
+    double tol, intptr_t n_threads, struct lsap_certificate* certificate)
+{
+    *certificate = lsap_certificate();
+    if (nr == 0 || nc == 0) {
+        certificate->valid = n == 0;
+        certificate->proven_optimal = n == 0;
+        return 0;
+    }
+    return lsap_validated([&]() -> int {
+        LSAP_DTYPE_SWITCH(dtype, T,
+            return verify(nr, nc, (const T *)input_cost, maximize,
+                          subrows, n_subrows, subcols, n_subcols,
+                          a, b, n, u, v, tol, n_threads, certificate));
+    }(), nr, nc);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,155 @@
+/*
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+1. Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following
+   disclaimer in the documentation and/or other materials provided
+   with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived
+   from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+/*
+Starting the exact engine from approximate prices and a candidate
+matching, for the engines that produce one.  Not part of the public
+interface.
+*/
+
+#ifndef WARM_START_H
+#define WARM_START_H
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include "rectangular_lsap_impl.h"
+
+// Turn approximate column prices v and a candidate matching col4row (-1 for
+// free rows) into a valid start for solve_from.  The prices are shifted to
+// v <= 0, u is the cheapest reduced entry of every row and only the tight
+// pairs of the matching are kept.  In a rectangular view a free column must
+// have v == 0, raising it can break the tightness of other pairs, which
+// are freed in turn.
+template <typename M> static int
+warm_start(intptr_t nr, intptr_t nc, const M& cost,
+           std::vector<double>& u, std::vector<double>& v,
+           std::vector<intptr_t>& col4row, std::vector<intptr_t>& row4col)
+{
+    std::fill(row4col.begin(), row4col.end(), -1);
+    for (intptr_t i = 0; i < nr; i++) {
+        intptr_t j = col4row[i];
+        if (j >= 0 && row4col[j] == -1) {
+            row4col[j] = i;
+        } else {
+            col4row[i] = -1;
+        }
+    }
+
+    double vmax = -INFINITY;
+    for (intptr_t j = 0; j < nc; j++) {
+        if (std::isfinite(v[j])) {
+            vmax = std::max(vmax, v[j]);
+        }
+    }
+    for (intptr_t j = 0; j < nc; j++) {
+        v[j] = std::isfinite(v[j]) && (row4col[j] != -1 || nr == nc) ? v[j] - vmax : 0;
+    }
+
+    for (intptr_t i = 0; i < nr; i++) {
+        double lowest = INFINITY;
+        for (intptr_t j = 0; j < nc; j++) {
+            lowest = std::min(lowest, cost.get(i, j) - v[j]);
+        }
+        if (lowest == INFINITY) {
+            return RECTANGULAR_LSAP_INFEASIBLE;
+        }
+        u[i] = lowest;
+    }
+
+    std::vector<intptr_t> freed;
+    for (intptr_t i = 0; i < nr; i++) {
+        intptr_t j = col4row[i];
+        if (j >= 0 && cost.get(i, j) - v[j] > u[i]) {
+            col4row[i] = -1;
+            row4col[j] = -1;
+            freed.push_back(j);
+        }
+    }
+    // every column ends up matched in a square view, any v is fine
+    if (nr == nc) {
+        return 0;
+    }
+    while (!freed.empty()) {
+        intptr_t j = freed.back();
+        freed.pop_back();
+        if (v[j] == 0) {
+            continue;
+        }
+        v[j] = 0;
+        for (intptr_t i = 0; i < nr; i++) {
+            double c = cost.get(i, j);
+            if (c < u[i]) {
+                u[i] = c;
+                if (col4row[i] >= 0) {
+                    freed.push_back(col4row[i]);
+                    row4col[col4row[i]] = -1;
+                    col4row[i] = -1;
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+// Breadth first search for an augmenting path from the free row curRow
+// over the finite entries, the path is flipped when found.
+template <typename M> static bool
+augment_bfs(intptr_t nc, const M& cost, intptr_t curRow,
+            std::vector<intptr_t>& col4row, std::vector<intptr_t>& row4col)
+{
+    std::vector<intptr_t> path(nc, -1);
+    std::vector<intptr_t> queue(1, curRow);
+    for (size_t q = 0; q < queue.size(); q++) {
+        intptr_t i = queue[q];
+        for (intptr_t j = 0; j < nc; j++) {
+            if (path[j] >= 0 || cost.get(i, j) == INFINITY) {
+                continue;
+            }
+            path[j] = i;
+            if (row4col[j] >= 0) {
+                queue.push_back(row4col[j]);
+                continue;
+            }
+            while (1) {
+                intptr_t r = path[j];
+                row4col[j] = r;
+                std::swap(col4row[r], j);
+                if (r == curRow) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+#endif
@@ -0,0 +1,120 @@
+"""Replay of the calls saved by nanolsap.capture, with optional changes to
+their arguments, reporting the time of every call against the captured
+time:
+
+    python -m nanolsap.replay DIRECTORY [--set method=auto] [--repeat 3]
+
+Calls captured with the full matrix are replayed as they were. Calls with
+a sample are replayed on the sample, without subrows and subcols, and
+calls without a matrix on a uniform random matrix of the captured shape
+and dtype; their times are not comparable to the captured ones, which is
+shown in the 'input' column.
+"""
+
+import argparse
+import ast
+import glob
+import json
+import os
+import sys
+import time
+
+import numpy as np
+
+from ._lsap import linear_sum_assignment
+
+
+def load(filename):
+    """The captured call in filename as (meta, arrays)."""
+    with np.load(filename) as data:
+        meta = json.loads(str(data["meta"]))
+        arrays = {name: data[name] for name in data.files if name != "meta"}
+    return meta, arrays
+
+
+def _input(meta, arrays, seed):
+    """The cost matrix, subscripts and a description of the input to
+    replay with."""
+    kind = meta["matrix"]
+    if kind == "full":
+        return arrays["cost_matrix"], arrays.get("subrows"), arrays.get("subcols"), "full"
+    if kind == "sample" and "cost_matrix" in arrays:
+        return arrays["cost_matrix"], None, None, "sample"
+    rng = np.random.default_rng(seed)
+    dtype = np.dtype(meta["dtype"])
+    cost = rng.random(meta["shape"]) * (1 if dtype == np.bool_ else 100)
+    return cost.astype(dtype), arrays.get("subrows"), arrays.get("subcols"), "synthetic"
+
+
+def replay(directory, repeat=1, seed=0, **overrides):
+    """Rerun the calls captured in directory with the keyword arguments in
+    overrides replaced, and return one dict per call with the captured and
+    the best replayed seconds."""
+    rows = []
+    for filename in sorted(glob.glob(os.path.join(directory, "*.npz"))):
+        meta, arrays = load(filename)
+        cost, subrows, subcols, kind = _input(meta, arrays, seed)
+        kwargs = dict(meta["kwargs"])
+        kwargs.update(overrides)
+        kwargs["subrows"] = subrows
+        kwargs["subcols"] = subcols
+        if kind == "sample" and kwargs.get("k") is not None:
+            kwargs["k"] = min(kwargs["k"], *cost.shape)
+        seconds = []
+        for _ in range(repeat):
+            start = time.perf_counter()
+            result = linear_sum_assignment(cost, **kwargs)
+            seconds.append(time.perf_counter() - start)
+        row = {
+            "file": os.path.basename(filename),
+            "shape": tuple(meta["shape"]),
+            "dtype": meta["dtype"],
+            "input": kind,
+            "captured_seconds": meta["seconds"],
+            "seconds": min(seconds),
+        }
+        if kind == "full" and meta["cost"] is not None:
+            row["cost_change"] = float(cost[result[0], result[1]].sum()) - meta["cost"]
+        rows.append(row)
+    return rows
+
+
+def _parse_override(text):
+    name, _, value = text.partition("=")
+    try:
+        value = ast.literal_eval(value)
+    except (ValueError, SyntaxError):
+        pass  # a plain string such as method=auto
+    return name, value
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(prog="python -m nanolsap.replay",
+                                     description=__doc__.split("\n\n")[0])
+    parser.add_argument("directory")
+    parser.add_argument("--set", action="append", default=[], metavar="NAME=VALUE",
+                        help="replace an argument of every call")
+    parser.add_argument("--repeat", type=int, default=1)
+    parser.add_argument("--json", metavar="FILE", help="also write the rows as JSON")
+    args = parser.parse_args(argv)
+
+    rows = replay(args.directory, repeat=args.repeat,
+                  **dict(_parse_override(text) for text in args.set))
+    print("%-28s %-14s %-6s %-9s %12s %12s %8s" % (
+        "call", "shape", "dtype", "input", "captured s", "replay s", "ratio"))
+    for row in rows:
+        print("%-28s %-14s %-6s %-9s %12.6f %12.6f %8.3f" % (
+            row["file"], "x".join(map(str, row["shape"])), row["dtype"], row["input"],
+            row["captured_seconds"], row["seconds"],
+            row["seconds"] / max(row["captured_seconds"], 1e-9)))
+    captured = sum(row["captured_seconds"] for row in rows)
+    replayed = sum(row["seconds"] for row in rows)
+    print("%d calls, captured %.6f s, replayed %.6f s" % (len(rows), captured, replayed))
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump(rows, f, indent=1)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,33 @@
+import json
+
+
+def trace_to_chrome(trace, path=None):
+    """Convert the stats['trace'] array of linear_sum_assignment to the
+    Chrome trace event format, readable by chrome://tracing and Perfetto.
+
+    Every augmentation becomes a complete event named after its row, and
+    the path length and columns scanned become counter tracks. Returns the
+    trace as a dict, and also writes it as JSON to path if not None.
+    """
+    events = []
+    for row, length, scanned, start, duration, cost in trace.tolist():
+        ts = start * 1e6
+        events.append({
+            "name": "row %d" % row, "cat": "augment", "ph": "X",
+            "ts": ts, "dur": duration * 1e6, "pid": 0, "tid": 0,
+            "args": {"row": row, "path_length": length,
+                     "columns_scanned": scanned, "path_cost": cost},
+        })
+        events.append({
+            "name": "path_length", "ph": "C", "ts": ts, "pid": 0,
+            "args": {"path_length": length},
+        })
+        events.append({
+            "name": "columns_scanned", "ph": "C", "ts": ts, "pid": 0,
+            "args": {"columns_scanned": scanned},
+        })
+    result = {"traceEvents": events, "displayTimeUnit": "ms"}
+    if path is not None:
+        with open(path, "w") as f:
+            json.dump(result, f)
+    return result
@@ -0,0 +1,144 @@
+"""Per machine calibration of the thresholds of the solvers.
+
+autotune() times the engines on the current machine, applies the
+thresholds found with set_tuning and stores them in a JSON cache keyed by
+the CPU model, which nanolsap loads when imported:
+
+    python -c "import nanolsap; print(nanolsap.autotune())"
+
+The cache is NANOLSAP_TUNING_CACHE if set, $XDG_CACHE_HOME/nanolsap/
+tuning.json or ~/.cache/nanolsap/tuning.json otherwise. Setting
+NANOLSAP_TUNING_CACHE to an empty string keeps the built-in thresholds.
+"""
+
+import json
+import os
+import platform
+import time
+
+import numpy as np
+
+from ._lsap import get_tuning, linear_sum_assignment, set_tuning
+
+DENSITIES = (0.01, 0.02, 0.05, 0.1, 0.2, 0.3, 0.5)
+THREAD_SIZES = (64, 128, 256, 512, 1024, 2048)
+# entries_per_thread that never starts a thread
+NO_THREADS = 2 ** 62
+
+
+def cpu_model():
+    """The CPU model name, the key of the cache."""
+    try:
+        with open("/proc/cpuinfo") as f:
+            for line in f:
+                if line.startswith("model name"):
+                    return line.partition(":")[2].strip()
+    except OSError:
+        pass
+    return platform.processor() or platform.machine()
+
+
+def cache_path():
+    """The cache file, None if disabled."""
+    path = os.environ.get("NANOLSAP_TUNING_CACHE")
+    if path is not None:
+        return path or None
+    base = os.environ.get("XDG_CACHE_HOME") or os.path.join(os.path.expanduser("~"), ".cache")
+    return os.path.join(base, "nanolsap", "tuning.json")
+
+
+def _read(path):
+    try:
+        with open(path) as f:
+            return json.load(f)
+    except (OSError, ValueError):
+        return {}
+
+
+def load(path=None):
+    """Apply the cached thresholds of this CPU model and return them, or
+    None if there are none."""
+    path = path or cache_path()
+    if path is None:
+        return None
+    entry = _read(path).get(cpu_model())
+    if not isinstance(entry, dict):
+        return None
+    set_tuning(sparse_density=entry["sparse_density"],
+               entries_per_thread=entry["entries_per_thread"], defaults=True)
+    return get_tuning()
+
+
+def _best_time(cost, repeat, **options):
+    best = float("inf")
+    for _ in range(repeat):
+        start = time.perf_counter()
+        linear_sum_assignment(cost, **options)
+        best = min(best, time.perf_counter() - start)
+    return best
+
+
+def _sparse_density(size, repeat, rng):
+    # densest instance on which the sparse engine still wins, forced by a
+    # threshold above or below every sampled density
+    threshold = 0.0
+    for density in DENSITIES:
+        cost = rng.random((size, size))
+        cost[rng.random((size, size)) > density] = np.inf
+        cost[np.arange(size), rng.permutation(size)] = rng.random(size)
+        set_tuning(sparse_density=1.0)
+        sparse = _best_time(cost, repeat, method="auto")
+        set_tuning(sparse_density=-1.0)
+        dense = _best_time(cost, repeat, method="auto")
+        if sparse >= dense:
+            break
+        threshold = density
+    return threshold
+
+
+def _entries_per_thread(size, repeat, rng):
+    # entries at which two threads first beat one on the greedy passes
+    if (os.cpu_count() or 1) < 2:
+        return NO_THREADS
+    set_tuning(entries_per_thread=1)
+    for n in THREAD_SIZES:
+        if n > size:
+            break
+        cost = rng.random((n, n))
+        one = _best_time(cost, repeat, method="greedy", n_threads=1)
+        two = _best_time(cost, repeat, method="greedy", n_threads=2)
+        if two < 0.9 * one:
+            return max(n * n // 2, 1)
+    return NO_THREADS
+
+
+def autotune(path=None, size=1000, repeat=3, seed=0):
+    """Measure the thresholds of set_tuning on this machine on instances of
+    up to size rows, apply them and store them in the cache at path
+    (cache_path() if None, not stored if that is disabled). Returns them
+    as a dict."""
+    rng = np.random.default_rng(seed)
+    previous = get_tuning()
+    try:
+        tuning = {
+            "sparse_density": _sparse_density(size, repeat, rng),
+            "entries_per_thread": _entries_per_thread(size, repeat, rng),
+        }
+    finally:
+        set_tuning(**previous)
+    set_tuning(defaults=True, **tuning)
+
+    path = path or cache_path()
+    if path is not None:
+        cache = _read(path)
+        cache[cpu_model()] = dict(tuning, cpu_count=os.cpu_count(), size=size,
+                                  time=time.strftime("%Y-%m-%dT%H:%M:%S"))
+        directory = os.path.dirname(path)
+        if directory:
+            os.makedirs(directory, exist_ok=True)
+        # replace atomically, processes may load it concurrently
+        tmp = "%s.%d" % (path, os.getpid())
+        with open(tmp, "w") as f:
+            json.dump(cache, f, indent=1, sort_keys=True)
+        os.replace(tmp, path)
+    return tuning
@@ -0,0 +1,149 @@
+// Tests of the header-only interface of nanolsap.hpp, run by ctest without
+// linking the library.
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#include <algorithm>
+#include "nanolsap.hpp"
+
+static int failures = 0;
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            failures++; \
+        } \
+    } while (0)
+
+static_assert(nanolsap::detail::has_row<nanolsap::dense_accessor<double> >::value,
+              "dense_accessor rows are scanned directly");
+
+// a get-only accessor over a column major array
+struct column_major {
+    const std::vector<float>& data;
+    intptr_t nr;
+    float get(intptr_t i, intptr_t j) const {
+        return data[j * nr + i];
+    }
+};
+
+// The smallest cost over all assignments of min(nr, nc) pairs.
+static double
+brute_force(const std::vector<double>& cost, intptr_t nr, intptr_t nc, bool maximize)
+{
+    bool tall = nc < nr;
+    intptr_t n = tall ? nc : nr;
+    intptr_t m = tall ? nr : nc;
+    std::vector<intptr_t> perm(m);
+    for (intptr_t t = 0; t < m; t++) {
+        perm[t] = t;
+    }
+    double best = maximize ? -INFINITY : INFINITY;
+    do {
+        double total = 0;
+        for (intptr_t t = 0; t < n; t++) {
+            total += tall ? cost[perm[t] * nc + t] : cost[t * nc + perm[t]];
+        }
+        best = maximize ? std::max(best, total) : std::min(best, total);
+    } while (std::next_permutation(perm.begin(), perm.end()));
+    return best;
+}
+
+// The pairs are sorted, distinct and optimal, proven by the duals.
+static void
+check(const std::vector<double>& cost, intptr_t nr, intptr_t nc, bool maximize,
+      const std::vector<int64_t>& a, const std::vector<int64_t>& b,
+      const std::vector<double>& u, const std::vector<double>& v)
+{
+    double sign = maximize ? -1 : 1;
+    double total = 0;
+    double bound = 0;
+    for (size_t t = 0; t < a.size(); t++) {
+        CHECK(t == 0 || a[t - 1] < a[t]);
+        CHECK(std::count(b.begin(), b.end(), b[t]) == 1);
+        total += cost[a[t] * nc + b[t]];
+        CHECK(std::abs(cost[a[t] * nc + b[t]] - u[a[t]] - v[b[t]]) < 1e-9);
+    }
+    for (intptr_t i = 0; i < nr; i++) {
+        bound += u[i];
+        for (intptr_t j = 0; j < nc; j++) {
+            CHECK(sign * (cost[i * nc + j] - u[i] - v[j]) >= -1e-9);
+        }
+    }
+    for (intptr_t j = 0; j < nc; j++) {
+        bound += v[j];
+    }
+    CHECK(std::abs(total - bound) < 1e-6);
+}
+
+int
+main()
+{
+    unsigned long state = 7;
+    for (intptr_t nr = 1; nr <= 40; nr += 13) {
+        for (intptr_t nc = 1; nc <= 40; nc += 7) {
+            std::vector<double> cost(nr * nc);
+            for (double& c: cost) {
+                state = state * 6364136223846793005UL + 1442695040888963407UL;
+                c = double((state >> 33) % 100);
+            }
+            intptr_t n = std::min(nr, nc);
+            for (int maximize = 0; maximize < 2; maximize++) {
+                // row spans
+                std::vector<int64_t> a(n), b(n);
+                std::vector<double> u(nr), v(nc);
+                nanolsap::dense_accessor<double> dense(cost.data(), nc);
+                CHECK(nanolsap::solve(dense, nr, nc, a.data(), b.data(), maximize,
+                                      u.data(), v.data()) == 0);
+                check(cost, nr, nc, maximize, a, b, u, v);
+
+                // a lambda
+                std::vector<int64_t> a2(n), b2(n);
+                auto lambda = nanolsap::make_accessor([&](intptr_t i, intptr_t j) {
+                    return cost[i * nc + j];
+                });
+                CHECK(nanolsap::solve(lambda, nr, nc, a2.data(), b2.data(), maximize,
+                                      u.data(), v.data()) == 0);
+                check(cost, nr, nc, maximize, a2, b2, u, v);
+
+                // get() only, of another type
+                std::vector<float> single(nr * nc);
+                for (intptr_t i = 0; i < nr; i++) {
+                    for (intptr_t j = 0; j < nc; j++) {
+                        single[j * nr + i] = float(cost[i * nc + j]);
+                    }
+                }
+                column_major fortran = {single, nr};
+                CHECK(nanolsap::solve(fortran, nr, nc, a2.data(), b2.data(), maximize,
+                                      u.data(), v.data()) == 0);
+                check(cost, nr, nc, maximize, a2, b2, u, v);
+
+                if (std::max(nr, nc) <= 8) {
+                    double total = 0;
+                    for (intptr_t t = 0; t < n; t++) {
+                        total += cost[a[t] * nc + b[t]];
+                    }
+                    CHECK(total == brute_force(cost, nr, nc, maximize));
+                }
+            }
+        }
+    }
+
+    // invalid entries and infeasible problems
+    int64_t a[2], b[2];
+    double nan_cost[4] = {1, NAN, 2, 3};
+    CHECK(nanolsap::solve(nanolsap::dense_accessor<double>(nan_cost, 2), 2, 2, a, b) ==
+          RECTANGULAR_LSAP_INVALID);
+    double inf_cost[4] = {INFINITY, INFINITY, 1, 2};
+    CHECK(nanolsap::solve(nanolsap::dense_accessor<double>(inf_cost, 2), 2, 2, a, b) ==
+          RECTANGULAR_LSAP_INFEASIBLE);
+    CHECK(nanolsap::solve(nanolsap::dense_accessor<double>(inf_cost, 2), 2, 2, a, b, true) ==
+          RECTANGULAR_LSAP_INVALID);
+
+    if (failures > 0) {
+        std::fprintf(stderr, "%d checks failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,248 @@
+/* Tests of the C ABI of lsap_solver.h, run by ctest. */
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "lsap_solver.h"
+
+static int failures = 0;
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            failures++; \
+        } \
+    } while (0)
+
+#define NR 30
+#define NC 40
+
+static double cost[NR][NC];
+
+static void
+fill(void)
+{
+    unsigned long state = 12345;
+    for (int i = 0; i < NR; i++) {
+        for (int j = 0; j < NC; j++) {
+            state = state * 6364136223846793005UL + 1442695040888963407UL;
+            cost[i][j] = (double)((state >> 33) % 1000);
+        }
+    }
+}
+
+static struct lsap_matrix
+matrix(const void* data, intptr_t dtype, intptr_t nr, intptr_t nc,
+       intptr_t row_stride, intptr_t col_stride)
+{
+    struct lsap_matrix m;
+    m.data = data;
+    m.dtype = dtype;
+    m.nr = nr;
+    m.nc = nc;
+    m.row_stride = row_stride;
+    m.col_stride = col_stride;
+    return m;
+}
+
+static double
+assigned_cost(const int64_t* a, const int64_t* b, intptr_t n)
+{
+    double total = 0;
+    for (intptr_t t = 0; t < n; t++) {
+        total += cost[a[t]][b[t]];
+    }
+    return total;
+}
+
+static int
+sorted(const int64_t* a, intptr_t n)
+{
+    for (intptr_t t = 1; t < n; t++) {
+        if (a[t - 1] > a[t]) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* the duals of the last solve are feasible and tight on the assignment */
+static void
+check_duals(lsap_solver* solver, bool maximize, const int64_t* a, const int64_t* b, intptr_t n)
+{
+    double u[NR], v[NC];
+    CHECK(lsap_solver_duals(solver, u, v) == 0);
+    double sign = maximize ? -1 : 1;
+    double bound = 0;
+    for (int i = 0; i < NR; i++) {
+        bound += u[i];
+        for (int j = 0; j < NC; j++) {
+            CHECK(sign * (cost[i][j] - u[i] - v[j]) >= -1e-9);
+        }
+    }
+    for (int j = 0; j < NC; j++) {
+        bound += v[j];
+    }
+    for (intptr_t t = 0; t < n; t++) {
+        CHECK(fabs(cost[a[t]][b[t]] - u[a[t]] - v[b[t]]) < 1e-9);
+    }
+    CHECK(fabs(bound - assigned_cost(a, b, n)) < 1e-6);
+}
+
+int
+main(void)
+{
+    int64_t a[NR], b[NR];
+    double optimum;
+    fill();
+    CHECK(lsap_abi_version() == LSAP_ABI_VERSION);
+
+    /* the plain entry point as reference */
+    CHECK(solve_rectangular_linear_sum_assignment(NR, NC, &cost[0][0], false, a, b) == 0);
+    optimum = assigned_cost(a, b, NR);
+    /* the _dtype signature of the first releases, without k and options */
+    CHECK(solve_rectangular_linear_sum_assignment_dtype(NR, NC, &cost[0][0], LSAP_DOUBLE, false,
+                                                        NULL, 0, NULL, 0, a, b) == 0);
+    CHECK(assigned_cost(a, b, NR) == optimum);
+
+    lsap_solver* solver = lsap_solver_create(LSAP_SOLVER_STATS);
+    CHECK(solver != NULL);
+
+    /* C order */
+    struct lsap_matrix m = matrix(cost, LSAP_DOUBLE, NR, NC, LSAP_STRIDE_C_ORDER, LSAP_STRIDE_C_ORDER);
+    CHECK(lsap_solver_solve(solver, &m, false, NULL, 0, NULL, 0, -1, LSAP_OBJECTIVE_SUM,
+                            NULL, a, b) == 0);
+    CHECK(assigned_cost(a, b, NR) == optimum);
+    check_duals(solver, false, a, b, NR);
+    struct lsap_stats stats;
+    CHECK(lsap_solver_stats(solver, &stats) == 0);
+    CHECK(strcmp(stats.engine, "exact") == 0);
+    CHECK(stats.augmentations == NR);
+
+    /* the arrays are reused by a solve of the same size */
+    intptr_t bytes = lsap_solver_workspace_bytes(solver);
+    CHECK(bytes > 0);
+    CHECK(lsap_solver_solve(solver, &m, false, NULL, 0, NULL, 0, -1, LSAP_OBJECTIVE_SUM,
+                            NULL, a, b) == 0);
+    CHECK(lsap_solver_workspace_bytes(solver) == bytes);
+
+    /* column major: the transposed problem, pairs still sorted by row */
+    static double fortran[NC][NR];
+    for (int i = 0; i < NR; i++) {
+        for (int j = 0; j < NC; j++) {
+            fortran[j][i] = cost[i][j];
+        }
+    }
+    m = matrix(fortran, LSAP_DOUBLE, NR, NC, sizeof(double), NR * sizeof(double));
+    CHECK(lsap_solver_solve(solver, &m, false, NULL, 0, NULL, 0, -1, LSAP_OBJECTIVE_SUM,
+                            NULL, a, b) == 0);
+    CHECK(sorted(a, NR));
+    CHECK(assigned_cost(a, b, NR) == optimum);
+    check_duals(solver, false, a, b, NR);
+
+    /* padded rows: the columns 0, 2, 4, ... of cost read in place */
+    m = matrix(cost, LSAP_DOUBLE, NR, NC / 2, NC * sizeof(double), 2 * sizeof(double));
+    int64_t a2[NR], b2[NR];
+    CHECK(lsap_solver_solve(solver, &m, true, NULL, 0, NULL, 0, -1, LSAP_OBJECTIVE_SUM,
+                            NULL, a, b) == 0);
+    intptr_t subcols[NC / 2];
+    for (int j = 0; j < NC / 2; j++) {
+        subcols[j] = 2 * j;
+    }
+    CHECK(lsap_solve_dtype(
+        NR, NC, &cost[0][0], LSAP_DOUBLE, true, NULL, 0, subcols, NC / 2, -1,
+        LSAP_OBJECTIVE_SUM, NULL, a2, b2) == 0);
+    double expected = assigned_cost(a2, b2, NC / 2);
+    for (int t = 0; t < NC / 2; t++) {
+        b[t] *= 2;
+    }
+    CHECK(assigned_cost(a, b, NC / 2) == expected);
+
+    /* maximize with subscripts, the duals follow the subscripted rows */
+    m = matrix(cost, LSAP_DOUBLE, NR, NC, LSAP_STRIDE_C_ORDER, LSAP_STRIDE_C_ORDER);
+    intptr_t subrows[NR];
+    for (int i = 0; i < NR; i++) {
+        subrows[i] = NR - 1 - i;
+    }
+    CHECK(lsap_solver_solve(solver, &m, true, subrows, NR, NULL, 0, -1, LSAP_OBJECTIVE_SUM,
+                            NULL, a, b) == 0);
+    CHECK(lsap_solve_dtype(
+        NR, NC, &cost[0][0], LSAP_DOUBLE, true, NULL, 0, NULL, 0, -1,
+        LSAP_OBJECTIVE_SUM, NULL, a2, b2) == 0);
+    CHECK(assigned_cost(a, b, NR) == assigned_cost(a2, b2, NR));
+    {
+        /* subrows reverses the rows, so do the duals */
+        double u[NR], v[NC];
+        CHECK(lsap_solver_duals(solver, u, v) == 0);
+        for (int j = 0; j < NC; j++) {
+            CHECK(cost[0][j] - u[NR - 1] - v[j] <= 1e-9);
+        }
+    }
+
+    /* other engines on a copy, without duals */
+    struct lsap_options options;
+    lsap_options_init(&options);
+    options.method = LSAP_METHOD_GREEDY;
+    m = matrix(cost, LSAP_DOUBLE, NR, NC / 2, NC * sizeof(double), 2 * sizeof(double));
+    CHECK(lsap_solver_solve(solver, &m, false, NULL, 0, NULL, 0, -1, LSAP_OBJECTIVE_SUM,
+                            &options, a, b) == 0);
+    CHECK(sorted(a, NC / 2));
+    CHECK(lsap_solver_stats(solver, &stats) == 0);
+    CHECK(strcmp(stats.engine, "greedy") == 0);
+    CHECK(lsap_solver_duals(solver, NULL, NULL) == RECTANGULAR_LSAP_INVALID);
+
+    /* float32 */
+    static float single[NR][NC];
+    for (int i = 0; i < NR; i++) {
+        for (int j = 0; j < NC; j++) {
+            single[i][j] = (float)cost[i][j];
+        }
+    }
+    m = matrix(single, LSAP_FLOAT, NR, NC, LSAP_STRIDE_C_ORDER, LSAP_STRIDE_C_ORDER);
+    CHECK(lsap_solver_solve(solver, &m, false, NULL, 0, NULL, 0, -1, LSAP_OBJECTIVE_SUM,
+                            NULL, a, b) == 0);
+    CHECK(assigned_cost(a, b, NR) == optimum);
+
+    /* zero strides are real: a row broadcast to 3 rows, then a single
+       row with a zero row stride, read with NaN guards after the row */
+    {
+        double row[3 + 6] = { 4, 1, 7, NAN, NAN, NAN, NAN, NAN, NAN };
+        int64_t a3[3], b3[3];
+        m = matrix(row, LSAP_DOUBLE, 3, 3, 0, sizeof(double));
+        CHECK(lsap_solver_solve(solver, &m, false, NULL, 0, NULL, 0, -1, LSAP_OBJECTIVE_SUM,
+                                NULL, a3, b3) == 0);
+        CHECK(row[b3[0]] + row[b3[1]] + row[b3[2]] == 12);
+        m = matrix(row, LSAP_DOUBLE, 1, 3, 0, sizeof(double));
+        CHECK(lsap_solver_solve(solver, &m, false, NULL, 0, NULL, 0, -1, LSAP_OBJECTIVE_SUM,
+                                NULL, a3, b3) == 0);
+        CHECK(a3[0] == 0 && b3[0] == 1);
+        /* and a column broadcast along the rows */
+        m = matrix(row, LSAP_DOUBLE, 3, 2, sizeof(double), 0);
+        CHECK(lsap_solver_solve(solver, &m, false, NULL, 0, NULL, 0, -1, LSAP_OBJECTIVE_SUM,
+                                NULL, a3, b3) == 0);
+        CHECK(row[a3[0]] + row[a3[1]] == 5);
+    }
+
+    /* errors */
+    m = matrix(cost, LSAP_DOUBLE, NR, NC, LSAP_STRIDE_C_ORDER, 3);
+    CHECK(lsap_solver_solve(solver, &m, false, NULL, 0, NULL, 0, -1, LSAP_OBJECTIVE_SUM,
+                            NULL, a, b) == RECTANGULAR_LSAP_STRIDE_INVALID);
+    m = matrix(cost, LSAP_INVALID, NR, NC, LSAP_STRIDE_C_ORDER, LSAP_STRIDE_C_ORDER);
+    CHECK(lsap_solver_solve(solver, &m, false, NULL, 0, NULL, 0, -1, LSAP_OBJECTIVE_SUM,
+                            NULL, a, b) == RECTANGULAR_LSAP_DTYPE_INVALID);
+    lsap_solver_destroy(solver);
+
+    /* without LSAP_SOLVER_STATS nothing is counted */
+    solver = lsap_solver_create(0);
+    m = matrix(cost, LSAP_DOUBLE, NR, NC, LSAP_STRIDE_C_ORDER, LSAP_STRIDE_C_ORDER);
+    CHECK(lsap_solver_solve(solver, &m, false, NULL, 0, NULL, 0, -1, LSAP_OBJECTIVE_SUM,
+                            NULL, a, b) == 0);
+    CHECK(lsap_solver_stats(solver, &stats) == RECTANGULAR_LSAP_INVALID);
+    lsap_solver_destroy(solver);
+
+    if (failures > 0) {
+        fprintf(stderr, "%d checks failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
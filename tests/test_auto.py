@@ -0,0 +1,84 @@
+import numpy as np
+import pytest
+from scipy.optimize import linear_sum_assignment as scipy_solve
+from nanolsap import linear_sum_assignment as solve
+
+
+def optimal_cost(cost, maximize=False):
+    r, c = scipy_solve(cost, maximize=maximize)
+    return cost[r, c].sum()
+
+
+@pytest.mark.parametrize("shape", [(1, 1), (30, 30), (20, 35), (35, 20)])
+@pytest.mark.parametrize("dtype", [np.float64, np.float32, np.int16, np.bool_])
+def test_dense(shape, dtype):
+    rng = np.random.default_rng(0)
+    cost = rng.integers(0, 3 if dtype == np.bool_ else 100, shape).astype(dtype)
+    row_ind, col_ind, stats = solve(cost, method="auto", return_stats=True)
+    assert cost[row_ind, col_ind].sum() == optimal_cost(cost)
+    assert stats["engine"] == "exact"
+    if np.issubdtype(dtype, np.floating):
+        assert stats["density"] == 1
+    else:
+        assert np.isnan(stats["density"])
+
+
+@pytest.mark.parametrize("shape", [(60, 60), (40, 90), (90, 40)])
+@pytest.mark.parametrize("maximize", [False, True])
+def test_sparse(shape, maximize):
+    rng = np.random.default_rng(1)
+    cost = rng.random(shape)
+    cost[rng.random(shape) > 0.05] = -np.inf if maximize else np.inf
+    # keep a feasible assignment
+    n = min(shape)
+    cost[np.arange(n), np.arange(n)] = 1.0
+    row_ind, col_ind, stats = solve(cost, maximize=maximize, method="auto",
+                                    return_stats=True)
+    assert stats["engine"] == "exact_sparse"
+    assert stats["density"] <= 0.2
+    assert len(set(col_ind.tolist())) == len(col_ind) == n
+    assert np.isclose(cost[row_ind, col_ind].sum(), optimal_cost(cost, maximize))
+
+
+def test_sparse_infeasible():
+    cost = np.full((20, 20), np.inf)
+    cost[:, 0] = 1
+    with pytest.raises(ValueError, match="cost matrix is infeasible"):
+        solve(cost, method="auto")
+
+
+def test_structured():
+    rng = np.random.default_rng(2)
+    x = np.sort(rng.random(200))
+    y = np.sort(rng.random(200))
+    cost = np.abs(x[:, None] - y[None, :])
+    row_ind, col_ind, stats = solve(cost, method="auto", return_stats=True)
+    assert "adjacent rows" in stats["reason"]
+    assert np.isclose(cost[row_ind, col_ind].sum(), optimal_cost(cost))
+
+
+def test_other_engines():
+    cost = np.random.default_rng(3).random((10, 12))
+    *_, stats = solve(cost, method="auto", k=3, return_stats=True)
+    assert stats["engine"] == "exact_k"
+    *_, stats = solve(cost, method="auto", objective="bottleneck", return_stats=True)
+    assert stats["engine"] == "bottleneck"
+    assert stats["reason"] == "only engine for the objective"
+    *_, stats = solve(cost, return_stats=True)
+    assert (stats["engine"], stats["reason"]) == ("exact", "requested")
+    assert np.isnan(stats["density"])
+    *_, stats = solve(cost, method="sinkhorn", return_stats=True)
+    assert stats["engine"] == "sinkhorn"
+    row_ind, col_ind, total, bound, stats = solve(cost, method="greedy", return_bound=True,
+                                                  return_stats=True)
+    assert stats["engine"] == "greedy"
+
+
+def test_subscript():
+    rng = np.random.default_rng(4)
+    cost = rng.random((15, 12))
+    subrows = np.array([3, 5, 7, 9, 11, 13])
+    subcols = np.array([0, 2, 4, 6, 8, 10, 1])
+    row_ind, col_ind = solve(cost, subrows=subrows, subcols=subcols, method="auto")
+    assert np.isclose(cost[row_ind, col_ind].sum(),
+                      optimal_cost(cost[np.ix_(subrows, subcols)]))
@@ -0,0 +1,109 @@
+import itertools
+
+import numpy as np
+import pytest
+from scipy.optimize import linear_sum_assignment as scipy_solve
+from nanolsap import axial_assignment
+
+
+def brute_force(cost):
+    n = min(cost.shape)
+    best = np.inf
+    for j in itertools.permutations(range(cost.shape[1]), n):
+        for k in itertools.permutations(range(cost.shape[2]), n):
+            for i in itertools.combinations(range(cost.shape[0]), n):
+                best = min(best, cost[i, j, k].sum())
+    return best
+
+
+def check_assignment(cost, i_ind, j_ind, k_ind):
+    assert len(i_ind) == min(cost.shape)
+    for ind in (i_ind, j_ind, k_ind):
+        assert len(set(ind.tolist())) == len(ind)
+    assert (np.diff(i_ind) > 0).all()
+
+
+@pytest.mark.parametrize("shape", [(1, 1, 1), (3, 3, 3), (4, 4, 4), (3, 4, 5), (5, 3, 4)])
+@pytest.mark.parametrize("seed", range(3))
+def test_bounds(shape, seed):
+    rng = np.random.default_rng(seed)
+    cost = rng.integers(0, 20, shape).astype(np.float64)
+    i_ind, j_ind, k_ind, bounds = axial_assignment(cost, max_iter=200)
+    check_assignment(cost, i_ind, j_ind, k_ind)
+    optimal = brute_force(cost)
+    total = cost[i_ind, j_ind, k_ind].sum()
+    assert bounds.shape[1] == 2 and 1 <= len(bounds) <= 200
+    assert bounds[-1, 0] == total
+    assert bounds[-1, 1] <= optimal + 1e-9 <= total + 1e-9
+    # best bounds only improve
+    assert (np.diff(bounds[:, 0]) <= 0).all()
+    assert (np.diff(bounds[:, 1]) >= -1e-9).all()
+    # small instances are solved to near optimality
+    assert total <= optimal + 0.2 * abs(optimal) + 2
+
+
+def test_separable():
+    # with costs a[i, j] + b[k] any k order is optimal for the best (i, j)
+    rng = np.random.default_rng(3)
+    a = rng.random((30, 30))
+    b = rng.random(30)
+    cost = a[:, :, None] + 0.01 * b[None, None, :]
+    i_ind, j_ind, k_ind, bounds = axial_assignment(cost)
+    check_assignment(cost, i_ind, j_ind, k_ind)
+    r, c = scipy_solve(a)
+    optimal = a[r, c].sum() + 0.01 * b.sum()
+    assert np.isclose(bounds[-1, 0], optimal)
+    assert bounds[-1, 1] <= optimal + 1e-9
+    # the multipliers close most of the gap of lambda = 0
+    assert optimal - bounds[-1, 1] < 0.2 * (optimal - bounds[0, 1])
+
+
+@pytest.mark.parametrize("dtype", [np.float32, np.int32, np.uint8])
+def test_maximize(dtype):
+    rng = np.random.default_rng(4)
+    cost = rng.integers(0, 50, (4, 3, 4)).astype(dtype)
+    i_ind, j_ind, k_ind, bounds = axial_assignment(cost, maximize=True)
+    check_assignment(cost, i_ind, j_ind, k_ind)
+    total = cost[i_ind, j_ind, k_ind].astype(np.float64).sum()
+    assert bounds[-1, 0] == total
+    assert bounds[-1, 1] >= -brute_force(-cost.astype(np.float64)) >= total
+
+
+def test_threads():
+    rng = np.random.default_rng(5)
+    cost = rng.random((20, 25, 30))
+    single = axial_assignment(cost, max_iter=20, n_threads=1)
+    multi = axial_assignment(cost, max_iter=20, n_threads=4)
+    for s, m in zip(single, multi):
+        assert np.array_equal(s, m)
+
+
+def test_forbidden():
+    cost = np.full((3, 3, 3), np.inf)
+    for t, (j, k) in enumerate([(1, 2), (2, 0), (0, 1)]):
+        cost[t, j, k] = t
+    cost[0, 0, 0] = -5
+    i_ind, j_ind, k_ind, bounds = axial_assignment(cost)
+    assert j_ind.tolist() == [1, 2, 0] and k_ind.tolist() == [2, 0, 1]
+    assert bounds[-1, 0] == 3
+
+
+def test_infeasible():
+    cost = np.full((2, 2, 2), np.inf)
+    cost[0, 0, 0] = cost[1, 0, 1] = 1
+    with pytest.raises(ValueError, match="cost matrix is infeasible"):
+        axial_assignment(cost)
+
+
+def test_empty():
+    i_ind, j_ind, k_ind, bounds = axial_assignment(np.zeros((0, 3, 2)))
+    assert len(i_ind) == 0 and bounds.shape == (0, 2)
+
+
+def test_invalid_arguments():
+    with pytest.raises(ValueError, match="expected a 3-D array"):
+        axial_assignment(np.ones((3, 3)))
+    with pytest.raises(ValueError, match="max_iter must be positive"):
+        axial_assignment(np.ones((3, 3, 3)), max_iter=0)
+    with pytest.raises(ValueError, match="invalid numeric entries"):
+        axial_assignment(np.full((2, 2, 2), np.nan))
@@ -0,0 +1,105 @@
+import itertools
+
+import numpy as np
+import pytest
+from nanolsap import linear_sum_assignment as solve
+
+
+def brute_force(dense, maximize=False):
+    # (bottleneck, smallest sum among bottleneck optimal assignments)
+    dense = np.asarray(dense, dtype=np.float64)
+    if maximize:
+        dense = -dense
+    if dense.shape[0] > dense.shape[1]:
+        dense = dense.T
+    nr, nc = dense.shape
+    best = None
+    for cols in itertools.permutations(range(nc), nr):
+        values = dense[np.arange(nr), list(cols)]
+        key = (values.max(), values.sum())
+        if np.isfinite(key[0]) and (best is None or key < best):
+            best = key
+    if maximize and best is not None:
+        best = (-best[0], -best[1])
+    return best
+
+
+def test_simple():
+    dense = [[1, 10], [2, 3]]
+    row_ind, col_ind = solve(dense)
+    assert col_ind.tolist() == [0, 1]
+    row_ind, col_ind = solve(dense, objective="bottleneck")
+    assert col_ind.tolist() == [0, 1]
+    dense = [[1, 4], [3, 5]]
+    # sum: 1 + 5 = 6 < 4 + 3 = 7, bottleneck: max(4, 3) = 4 < 5
+    row_ind, col_ind = solve(dense, objective="bottleneck")
+    assert col_ind.tolist() == [1, 0]
+
+
+def test_objective_invalid():
+    with pytest.raises(ValueError, match="objective must be"):
+        solve(np.ones((2, 2)), objective="max")
+
+
+def test_infeasible():
+    dense = np.full((2, 2), np.inf)
+    dense[0, 0] = dense[1, 0] = 1
+    with pytest.raises(ValueError, match="cost matrix is infeasible"):
+        solve(dense, objective="bottleneck")
+
+
+@pytest.mark.parametrize('objective', ['bottleneck', 'bottleneck_sum'])
+def test_random(objective):
+    np.random.seed(1234)
+    for i in range(80):
+        row_size = np.random.randint(1, 7)
+        col_size = np.random.randint(1, 7)
+        if i % 2:
+            dense = np.random.randint(0, 5, (row_size, col_size)).astype(np.int32)
+        else:
+            dense = np.random.random((row_size, col_size)).astype(np.float32)
+        maximize = i % 3 == 0
+        expected = brute_force(dense, maximize)
+        row_ind, col_ind = solve(dense, maximize, objective=objective)
+        assert len(row_ind) == min(row_size, col_size)
+        assert len(set(col_ind.tolist())) == len(col_ind)
+        assert row_ind.tolist() == sorted(row_ind.tolist())
+        values = dense.astype(np.float64)[row_ind, col_ind]
+        if maximize:
+            assert values.min() == expected[0]
+        else:
+            assert values.max() == expected[0]
+        if objective == 'bottleneck_sum':
+            assert np.isclose(values.sum(), expected[1])
+
+
+def test_large_matches_threshold():
+    # many distinct values exercise the sampled thresholds
+    np.random.seed(42)
+    dense = np.random.random((300, 400))
+    row_ind, col_ind = solve(dense, objective="bottleneck")
+    bottleneck = dense[row_ind, col_ind].max()
+    # no assignment exists strictly below the bottleneck
+    masked = np.where(dense < bottleneck, 0.0, 1.0)
+    r, c = solve(masked)
+    assert masked[r, c].sum() > 0
+
+
+def test_k_and_subscript():
+    np.random.seed(7)
+    dense = np.random.random((8, 9))
+    subrows = [0, 2, 4, 6]
+    subcols = [1, 3, 5, 7, 8]
+    row_ind, col_ind = solve(dense, False, subrows, subcols, k=2, objective="bottleneck_sum")
+    sub = dense[np.ix_(subrows, subcols)]
+    best = None
+    for rows in itertools.combinations(range(4), 2):
+        for cols in itertools.permutations(range(5), 2):
+            values = sub[list(rows), list(cols)]
+            key = (values.max(), values.sum())
+            if best is None or key < best:
+                best = key
+    values = dense[row_ind, col_ind]
+    assert len(values) == 2
+    assert values.max() == best[0]
+    assert np.isclose(values.sum(), best[1])
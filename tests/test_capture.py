@@ -0,0 +1,54 @@
+import os
+import subprocess
+import sys
+
+import numpy as np
+import pytest
+from nanolsap import linear_sum_assignment as solve
+from nanolsap.capture import capturing, sample_indices
+from nanolsap.replay import load, replay
+
+
+@pytest.mark.parametrize("matrix", ["full", "sample", "none"])
+def test_capture_replay(tmp_path, matrix):
+    wrapped = capturing(solve, str(tmp_path), matrix=matrix)
+    rng = np.random.default_rng(0)
+    cost = rng.random((300, 280)).astype(np.float32)
+    r0, c0 = solve(cost, maximize=True)
+    r1, c1 = wrapped(cost, True)
+    assert np.array_equal(r0, r1) and np.array_equal(c0, c1)
+    wrapped(cost, subrows=np.arange(0, 300, 2), subcols=np.arange(100), row_order="regret")
+    files = sorted(os.listdir(str(tmp_path)))
+    assert len(files) == 2
+
+    meta, arrays = load(str(tmp_path / files[0]))
+    assert meta["shape"] == [300, 280] and meta["dtype"] == "<f4"
+    assert meta["kwargs"] == {"maximize": True}
+    assert np.isclose(meta["cost"], cost[r0, c0].sum())
+    if matrix == "sample":
+        assert arrays["cost_matrix"].shape == (256, 256)
+        assert np.array_equal(arrays["cost_matrix"],
+                              cost[np.ix_(sample_indices(300), sample_indices(280))])
+    assert ("cost_matrix" in arrays) == (matrix != "none")
+
+    rows = replay(str(tmp_path), method="auto")
+    assert len(rows) == 2
+    assert all(row["input"] == {"none": "synthetic"}.get(matrix, matrix) for row in rows)
+    if matrix == "full":
+        assert all(abs(row["cost_change"]) < 1e-3 for row in rows)
+
+
+def test_rate(tmp_path):
+    wrapped = capturing(solve, str(tmp_path), rate=0)
+    wrapped(np.eye(3))
+    assert os.listdir(str(tmp_path)) == []
+
+
+def test_environ(tmp_path):
+    code = ("import numpy as np, nanolsap; nanolsap.linear_sum_assignment(np.eye(4)); "
+            "from nanolsap.replay import main; main([%r, '--set', 'row_order=regret'])"
+            % str(tmp_path))
+    env = dict(os.environ, NANOLSAP_CAPTURE=str(tmp_path), NANOLSAP_CAPTURE_MATRIX="full")
+    out = subprocess.run([sys.executable, "-c", code], env=env, check=True,
+                         stdout=subprocess.PIPE, universal_newlines=True).stdout
+    assert "1 calls" in out
@@ -0,0 +1,107 @@
+import array
+
+import numpy as np
+import pytest
+from nanolsap import estimate_memory, linear_sum_assignment as solve, verify_assignment
+from scipy.optimize import linear_sum_assignment as scipy_solve
+
+
+class DLPackOnly:
+    """Exports its array only through __dlpack__, like a torch CPU tensor."""
+
+    def __init__(self, array):
+        self.array = array
+
+    def __dlpack__(self, *args, **kwargs):
+        return self.array.__dlpack__(*args, **kwargs)
+
+    def __dlpack_device__(self):
+        return self.array.__dlpack_device__()
+
+
+class BadDLPack:
+    """A __dlpack__ that fails, as for a tensor on a GPU, over a list."""
+
+    def __init__(self, rows):
+        self.rows = rows
+
+    def __dlpack__(self, *args, **kwargs):
+        raise BufferError("not on the CPU")
+
+    def __len__(self):
+        return len(self.rows)
+
+    def __getitem__(self, i):
+        return self.rows[i]
+
+
+def exporters(cost):
+    yield DLPackOnly(cost)
+    yield memoryview(cost)
+    readonly = cost.copy()
+    readonly.flags.writeable = False
+    yield readonly
+    yield memoryview(readonly)
+
+
+@pytest.mark.parametrize("dtype", [np.float64, np.float32, np.int64, np.int32, np.uint8, np.bool_])
+@pytest.mark.parametrize("shape", [(20, 20), (10, 30), (30, 10)])
+def test_no_copy(dtype, shape):
+    cost = (np.random.default_rng(0).random(shape) * 100).astype(dtype)
+    expected = scipy_solve(cost)
+    total = estimate_memory(cost)["total_bytes"]
+    for obj in exporters(cost):
+        assert estimate_memory(obj)["copy_bytes"] == 0
+        r, c = solve(obj, memory_limit=total)
+        np.testing.assert_array_equal(r, expected[0])
+        np.testing.assert_array_equal(c, expected[1])
+
+
+def test_strided_views_are_copied():
+    cost = np.random.default_rng(1).random((20, 30))
+    for view in (cost.T, cost[:, ::2]):
+        obj = DLPackOnly(view)
+        memory = estimate_memory(obj)
+        assert memory["copy_bytes"] == view.size * 8
+        with pytest.raises(MemoryError):
+            solve(obj, memory_limit=memory["total_bytes"] - memory["copy_bytes"])
+        r, c = solve(obj)
+        assert view[r, c].sum() == pytest.approx(view[scipy_solve(view)].sum())
+
+
+def test_buffer_of_a_flat_array():
+    # a 1-D buffer is not a matrix, as for numpy arrays
+    with pytest.raises(ValueError):
+        solve(array.array("d", [1.0, 2.0, 3.0, 4.0]))
+    with pytest.raises(ValueError):
+        solve(memoryview(np.arange(4.0)))
+
+
+def test_failed_dlpack_falls_back_to_sequence():
+    rows = [[4.0, 1.0, 3.0], [2.0, 0.0, 5.0], [3.0, 2.0, 2.0]]
+    r, c = solve(BadDLPack(rows))
+    np.testing.assert_array_equal(c, [1, 0, 2])
+    assert estimate_memory(BadDLPack(rows))["copy_bytes"] == 9 * 8
+
+
+def test_verify_on_exports():
+    cost = np.random.default_rng(2).random((15, 25)).astype(np.float32)
+    r, c = solve(cost)
+    for obj in exporters(cost):
+        assert verify_assignment(obj, r, c)["valid"]
+
+
+class CountingDLPack(DLPackOnly):
+    calls = 0
+
+    def __dlpack__(self, *args, **kwargs):
+        CountingDLPack.calls += 1
+        return super().__dlpack__(*args, **kwargs)
+
+
+def test_exported_once():
+    cost = np.random.default_rng(3).random((10, 12))
+    for call in (lambda obj: solve(obj, memory_limit=10 ** 6), estimate_memory):
+        CountingDLPack.calls = 0
+        call(CountingDLPack(cost))
+        assert CountingDLPack.calls == 1
@@ -0,0 +1,103 @@
+import math
+
+import numpy as np
+import pytest
+from nanolsap import estimate, estimate_memory, linear_sum_assignment as solve
+
+
+@pytest.mark.parametrize("kwargs", [{}, {"k": 5}, {"method": "auto"}, {"row_order": "regret"},
+                                    {"method": "sinkhorn", "repair": True},
+                                    {"method": "greedy"}, {"objective": "bottleneck_sum"},
+                                    {"trace": 10, "return_stats": True}])
+@pytest.mark.parametrize("shape", [(30, 30), (20, 50), (50, 20)])
+def test_total_is_the_limit(shape, kwargs):
+    cost = np.random.default_rng(0).random(shape)
+    memory = estimate_memory(cost, **{k: v for k, v in kwargs.items() if k != "return_stats"})
+    assert memory["copy_bytes"] == 0
+    assert memory["workspace_bytes"] > 0
+    assert memory["output_bytes"] == 16 * kwargs.get("k", min(shape))
+    total = memory["total_bytes"]
+    r, c = solve(cost, memory_limit=total, **kwargs)[:2]
+    assert np.array_equal((r, c), solve(cost, **kwargs)[:2])
+    with pytest.raises(MemoryError):
+        solve(cost, memory_limit=total - 1, **kwargs)
+
+
+def test_engine_and_stats():
+    cost = np.random.default_rng(1).random((40, 40))
+    memory = estimate_memory(cost)
+    stats = solve(cost, return_stats=True)[2]
+    assert memory["engine"] == stats["engine"] == "exact"
+    assert memory["workspace_bytes"] == stats["workspace_bytes"]
+    assert math.isnan(memory["density"])
+
+
+def test_copy_bytes():
+    cost = np.random.default_rng(2).random((30, 40))
+    assert estimate_memory(cost)["copy_bytes"] == 0
+    assert estimate_memory(cost.T)["copy_bytes"] == cost.nbytes
+    assert estimate_memory(cost.astype(np.float16))["copy_bytes"] == cost.nbytes
+    assert estimate_memory(cost.tolist())["copy_bytes"] == cost.nbytes
+    with pytest.raises(MemoryError):
+        solve(cost.T, memory_limit=cost.nbytes - 1)
+    solve(cost.T, memory_limit=estimate_memory(cost.T)["total_bytes"])
+
+
+def test_auto_sparse_fallback():
+    rng = np.random.default_rng(3)
+    n = 200
+    cost = np.full((n, n), np.inf)
+    cost[np.arange(n), rng.permutation(n)] = rng.random(n)
+    for _ in range(3):
+        cost[np.arange(n), rng.permutation(n)] = rng.random(n)
+    memory = estimate_memory(cost, method="auto")
+    assert memory["engine"] == "exact_sparse"
+    assert memory["density"] < 0.2
+    dense = estimate_memory(cost)["workspace_bytes"]
+    assert memory["workspace_bytes"] > dense
+    expected = solve(cost)
+    # sparse arrays do not fit, dense ones do
+    limit = memory["total_bytes"] - memory["workspace_bytes"] + dense
+    r, c, stats = solve(cost, method="auto", memory_limit=limit, return_stats=True)
+    assert stats["engine"] == "exact"
+    assert stats["reason"] == "sparse arrays over memory_limit"
+    assert np.isclose(cost[r, c].sum(), cost[expected].sum())
+
+
+def test_subscripts():
+    cost = np.random.default_rng(4).random((60, 60))
+    memory = estimate_memory(cost, subrows=np.arange(10), subcols=np.arange(30))
+    assert memory["output_bytes"] == 16 * 10
+    assert memory["workspace_bytes"] < estimate_memory(cost)["workspace_bytes"]
+    with pytest.raises(ValueError):
+        estimate_memory(cost, subrows=[60])
+    with pytest.raises(ValueError):
+        estimate_memory(cost, k=61)
+
+
+def test_errors():
+    cost = np.zeros((3, 3))
+    with pytest.raises(ValueError):
+        solve(cost, memory_limit=-1)
+    with pytest.raises(ValueError):
+        estimate_memory(cost, method="sinkhorn", k=1)
+    assert estimate_memory(np.zeros((0, 5)))["total_bytes"] == 0
+
+
+@pytest.mark.parametrize("shape", [(50, 80), (600, 400)])
+def test_estimate(shape):
+    cost = np.random.default_rng(5).random(shape)
+    result = estimate(cost, probe_size=128, method="auto")
+    assert result["engine"] == "exact"
+    assert result["seconds"] > 0
+    if max(shape) <= 128:
+        assert math.isnan(result["exponent"])
+    else:
+        assert 1 <= result["exponent"] <= 3
+
+
+def test_estimate_infeasible_probe():
+    n = 300
+    cost = np.full((n, n), np.inf)
+    cost[np.arange(n), np.random.default_rng(6).permutation(n)] = 1
+    assert math.isnan(estimate(cost, probe_size=64)["seconds"])
@@ -0,0 +1,108 @@
+import numpy as np
+import pytest
+from scipy.optimize import linear_sum_assignment as scipy_solve
+from nanolsap import linear_sum_assignment as solve
+
+
+def check_assignment(cost, row_ind, col_ind):
+    assert len(row_ind) == min(cost.shape)
+    assert len(set(row_ind.tolist())) == len(row_ind)
+    assert len(set(col_ind.tolist())) == len(col_ind)
+
+
+@pytest.mark.parametrize("shape", [(1, 1), (5, 5), (30, 30), (20, 35), (35, 20)])
+@pytest.mark.parametrize("seed", range(3))
+def test_bound(shape, seed):
+    rng = np.random.default_rng(seed)
+    cost = rng.random(shape)
+    row_ind, col_ind, total, bound = solve(cost, method="greedy", return_bound=True)
+    check_assignment(cost, row_ind, col_ind)
+    assert np.isclose(total, cost[row_ind, col_ind].sum())
+    r, c = scipy_solve(cost)
+    optimal = cost[r, c].sum()
+    assert bound <= optimal + 1e-9
+    assert total >= optimal - 1e-9
+    # local search keeps uniform random costs close to optimal
+    assert total <= 1.5 * optimal + 0.5
+
+
+@pytest.mark.parametrize("dtype", [np.float32, np.int32, np.uint8])
+def test_maximize(dtype):
+    rng = np.random.default_rng(3)
+    cost = rng.integers(0, 100, (25, 40)).astype(dtype)
+    row_ind, col_ind, total, bound = solve(cost, maximize=True, method="greedy",
+                                           return_bound=True)
+    check_assignment(cost, row_ind, col_ind)
+    assert total == cost[row_ind, col_ind].astype(np.float64).sum()
+    r, c = scipy_solve(cost, maximize=True)
+    assert bound >= cost[r, c].astype(np.float64).sum() >= total
+
+
+def test_swaps():
+    # the greedy pick of 0 forces 100, a 2-opt swap fixes it
+    cost = np.array([[0.0, 1], [1, 100]])
+    row_ind, col_ind = solve(cost, method="greedy")
+    assert col_ind.tolist() == [1, 0]
+    # the greedy matching costs 100, two swaps reach the optimum
+    cost = np.array([[0.0, 1, 50], [50, 0, 1], [1, 50, 100]])
+    row_ind, col_ind = solve(cost, method="greedy")
+    assert cost[row_ind, col_ind].sum() == 3
+    # no passes keep the greedy matching
+    row_ind, col_ind = solve(cost, method="greedy", max_iter=0)
+    assert cost[row_ind, col_ind].sum() == 100
+
+
+def test_threads():
+    rng = np.random.default_rng(5)
+    cost = rng.random((300, 300))
+    single = solve(cost, method="greedy", return_bound=True, n_threads=1)
+    multi = solve(cost, method="greedy", return_bound=True, n_threads=4)
+    check_assignment(cost, *multi[:2])
+    assert (single[1] == multi[1]).all()
+    assert np.isclose(single[3], multi[3])
+
+
+def test_subscript():
+    rng = np.random.default_rng(6)
+    cost = rng.random((15, 12))
+    subrows = np.array([3, 5, 7, 9, 11, 13])
+    subcols = np.array([0, 2, 4, 6, 8, 10, 1])
+    row_ind, col_ind, total, bound = solve(cost, subrows=subrows, subcols=subcols,
+                                           method="greedy", return_bound=True)
+    assert set(row_ind.tolist()) == set(subrows.tolist())
+    assert set(col_ind.tolist()) <= set(subcols.tolist())
+    assert np.isclose(total, cost[row_ind, col_ind].sum())
+    r, c = scipy_solve(cost[np.ix_(subrows, subcols)])
+    assert bound <= cost[np.ix_(subrows, subcols)][r, c].sum() + 1e-9
+
+
+def test_forbidden():
+    # every row prefers column 0, the rest need an augmenting path
+    cost = np.full((4, 4), np.inf)
+    cost[:, 0] = 0
+    cost[0, 1] = cost[1, 2] = cost[2, 3] = 5
+    row_ind, col_ind = solve(cost, method="greedy")
+    assert np.isfinite(cost[row_ind, col_ind]).all()
+    assert cost[row_ind, col_ind].sum() == 15
+
+
+def test_infeasible():
+    cost = np.array([[np.inf, np.inf], [1, 2]])
+    with pytest.raises(ValueError, match="cost matrix is infeasible"):
+        solve(cost, method="greedy")
+
+
+def test_empty():
+    row_ind, col_ind, total, bound = solve(np.zeros((0, 3)), method="greedy",
+                                           return_bound=True)
+    assert len(row_ind) == 0 and total == 0 and bound == 0
+
+
+def test_invalid_arguments():
+    cost = np.ones((3, 3))
+    with pytest.raises(ValueError, match="return_bound requires"):
+        solve(cost, return_bound=True)
+    with pytest.raises(ValueError):
+        solve(cost, method="greedy", k=2)
+    with pytest.raises(ValueError):
+        solve(cost, method="greedy", objective="bottleneck", return_bound=True)
@@ -0,0 +1,88 @@
+import numpy as np
+import pytest
+from nanolsap import linear_sum_assignment as solve
+from scipy.optimize import linear_sum_assignment as scipy_linear_sum_assignment
+
+
+def scipy_k_cost(dense, k):
+    # Pad with zero cost dummy rows and cols so that exactly k real pairs
+    # remain, dummy to dummy pairs are forbidden.
+    nr, nc = dense.shape
+    n = nr + nc - k
+    big = np.zeros((n, n))
+    big[:nr, :nc] = dense
+    big[nr:, nc:] = np.inf
+    row_ind, col_ind = scipy_linear_sum_assignment(big)
+    mask = (row_ind < nr) & (col_ind < nc)
+    return big[row_ind[mask], col_ind[mask]].sum()
+
+
+def test_simple():
+    dense = [[1, 9, 9], [9, 2, 9], [9, 9, 0]]
+    row_ind, col_ind = solve(dense, k=1)
+    assert row_ind.tolist() == [2]
+    assert col_ind.tolist() == [2]
+    row_ind, col_ind = solve(dense, k=2)
+    assert row_ind.tolist() == [0, 2]
+    assert col_ind.tolist() == [0, 2]
+
+
+def test_k_full_is_plain_solve():
+    dense = np.random.RandomState(0).random((7, 9))
+    row_ind, col_ind = solve(dense, k=7)
+    row_ind2, col_ind2 = solve(dense)
+    assert row_ind.tolist() == row_ind2.tolist()
+    assert col_ind.tolist() == col_ind2.tolist()
+
+
+def test_k_zero():
+    row_ind, col_ind = solve(np.ones((3, 4)), k=0)
+    assert len(row_ind) == 0
+    assert len(col_ind) == 0
+
+
+def test_k_invalid():
+    with pytest.raises(ValueError, match="k must not exceed"):
+        solve(np.ones((3, 4)), k=4)
+    with pytest.raises(ValueError, match="k must be non-negative"):
+        solve(np.ones((3, 4)), k=-1)
+
+
+def test_k_infeasible():
+    dense = np.full((3, 3), np.inf)
+    dense[0, 0] = 1
+    solve(dense, k=1)
+    with pytest.raises(ValueError, match="cost matrix is infeasible"):
+        solve(dense, k=2)
+
+
+def test_k_random():
+    np.random.seed(1234)
+    for i in range(100):
+        row_size = np.random.randint(1, 40)
+        col_size = np.random.randint(1, 40)
+        k = np.random.randint(0, min(row_size, col_size) + 1)
+        if i % 2:
+            dense = np.random.randint(0, 5, (row_size, col_size)).astype(np.int16)
+        else:
+            dense = np.random.random((row_size, col_size)).astype(np.float32)
+        maximize = i % 3 == 0
+        row_ind, col_ind = solve(dense, maximize, k=k)
+        assert len(row_ind) == k
+        assert len(set(row_ind.tolist())) == k
+        assert len(set(col_ind.tolist())) == k
+        assert row_ind.tolist() == sorted(row_ind.tolist())
+        sign = -1 if maximize else 1
+        lsa_cost = dense.astype(np.float64)[row_ind, col_ind].sum()
+        expected = sign * scipy_k_cost(sign * dense.astype(np.float64), k)
+        assert np.isclose(lsa_cost, expected)
+
+
+def test_k_subrow_subcol():
+    np.random.seed(4321)
+    dense = np.random.random((30, 20))
+    subrows = np.random.choice(30, 15)
+    subcols = np.random.choice(20, 25)
+    row_ind, col_ind = solve(dense, False, subrows, subcols, k=6)
+    subdense = dense[np.ix_(subrows, subcols)]
+    assert np.isclose(dense[row_ind, col_ind].sum(), scipy_k_cost(subdense, 6))
@@ -0,0 +1,89 @@
+import itertools
+
+import numpy as np
+import pytest
+from nanolsap import k_best_assignments, linear_sum_assignment
+
+
+def brute_force_costs(dense):
+    dense = np.asarray(dense, dtype=np.float64)
+    if dense.shape[0] > dense.shape[1]:
+        dense = dense.T
+    nr, nc = dense.shape
+    costs = []
+    for cols in itertools.permutations(range(nc), nr):
+        c = dense[np.arange(nr), list(cols)].sum()
+        if np.isfinite(c):
+            costs.append(c)
+    return sorted(costs)
+
+
+def test_simple():
+    dense = [[1, 2], [3, 5]]
+    row_ind, col_ind, costs = k_best_assignments(dense, 3)
+    assert row_ind.tolist() == [[0, 1], [0, 1]]
+    assert col_ind.tolist() == [[1, 0], [0, 1]]
+    assert costs.tolist() == [5, 6]
+
+
+def test_first_is_linear_sum_assignment():
+    dense = np.random.RandomState(0).random((8, 11))
+    row_ind, col_ind, costs = k_best_assignments(dense, 1)
+    row_ind2, col_ind2 = linear_sum_assignment(dense)
+    assert row_ind[0].tolist() == row_ind2.tolist()
+    assert col_ind[0].tolist() == col_ind2.tolist()
+    assert np.isclose(costs[0], dense[row_ind2, col_ind2].sum())
+
+
+def test_k_zero():
+    row_ind, col_ind, costs = k_best_assignments(np.ones((3, 3)), 0)
+    assert row_ind.shape == (0, 3)
+    assert len(costs) == 0
+
+
+def test_infeasible():
+    with pytest.raises(ValueError, match="cost matrix is infeasible"):
+        k_best_assignments(np.full((2, 2), np.inf), 2)
+
+
+@pytest.mark.parametrize('n_threads', [1, 4])
+def test_random(n_threads):
+    np.random.seed(1234)
+    for i in range(60):
+        row_size = np.random.randint(1, 6)
+        col_size = np.random.randint(1, 6)
+        if i % 2:
+            dense = np.random.randint(0, 4, (row_size, col_size)).astype(np.uint8)
+        else:
+            dense = np.random.random((row_size, col_size))
+        if i % 5 == 0:
+            dense = dense.astype(np.float64)
+            dense[np.random.random(dense.shape) < 0.3] = np.inf
+        maximize = i % 3 == 0 and i % 5 != 0
+        k = np.random.randint(1, 30)
+        sign = -1 if maximize else 1
+        expected = brute_force_costs(sign * dense.astype(np.float64))[:k]
+        if not expected:
+            continue
+        row_ind, col_ind, costs = k_best_assignments(dense, k, maximize, n_threads=n_threads)
+        assert len(costs) == len(expected)
+        assert np.allclose(sign * costs, expected)
+        pairs = set()
+        for t in range(len(costs)):
+            assert np.isclose(dense.astype(np.float64)[row_ind[t], col_ind[t]].sum(), costs[t])
+            assert len(set(col_ind[t].tolist())) == col_ind.shape[1]
+            assert len(set(row_ind[t].tolist())) == row_ind.shape[1]
+            pairs.add(tuple(zip(row_ind[t].tolist(), col_ind[t].tolist())))
+        assert len(pairs) == len(costs)
+
+
+def test_subrow_subcol():
+    np.random.seed(4321)
+    dense = np.random.random((10, 10))
+    subrows = [1, 3, 5, 7]
+    subcols = [0, 2, 4, 6, 8]
+    row_ind, col_ind, costs = k_best_assignments(dense, 10, False, subrows, subcols)
+    expected = brute_force_costs(dense[np.ix_(subrows, subcols)])[:10]
+    assert np.allclose(costs, expected)
+    assert set(row_ind.ravel().tolist()) <= set(subrows)
+    assert set(col_ind.ravel().tolist()) <= set(subcols)
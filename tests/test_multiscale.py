@@ -0,0 +1,96 @@
+import numpy as np
+import pytest
+from scipy.optimize import linear_sum_assignment as scipy_solve
+from scipy.spatial.distance import cdist
+from nanolsap import multiscale_assignment
+
+
+def optimal_cost(x, y, metric):
+    cost = cdist(x, y, metric)
+    r, c = scipy_solve(cost)
+    return cost, cost[r, c].sum()
+
+
+@pytest.mark.parametrize("metric", ["euclidean", "sqeuclidean"])
+@pytest.mark.parametrize("shape", [(1, 1), (10, 10), (60, 60), (40, 70), (70, 40)])
+def test_exact_single_cluster(metric, shape):
+    # one cluster and every candidate is the plain dense problem
+    rng = np.random.default_rng(0)
+    x = rng.random((shape[0], 2))
+    y = rng.random((shape[1], 2))
+    row_ind, col_ind = multiscale_assignment(x, y, metric=metric, n_candidates=max(shape),
+                                             max_clusters=1)
+    cost, expected = optimal_cost(x, y, metric)
+    assert len(row_ind) == min(shape)
+    assert np.isclose(cost[row_ind, col_ind].sum(), expected)
+
+
+@pytest.mark.parametrize("metric", ["euclidean", "sqeuclidean"])
+@pytest.mark.parametrize("seed", range(3))
+def test_multiscale(metric, seed):
+    # four clusters, refined twice before the points
+    rng = np.random.default_rng(seed)
+    x = rng.random((400, 3))
+    y = x + 0.05 * rng.standard_normal((400, 3))
+    row_ind, col_ind = multiscale_assignment(x, y, metric=metric, max_clusters=4)
+    assert np.array_equal(row_ind, np.arange(400))
+    assert len(set(col_ind.tolist())) == 400
+    cost, expected = optimal_cost(x, y, metric)
+    assert np.isclose(cost[row_ind, col_ind].sum(), expected)
+
+
+@pytest.mark.parametrize("metric", ["euclidean", "sqeuclidean"])
+@pytest.mark.parametrize("shape", [(300, 200), (200, 300), (150, 600)])
+def test_rectangular(metric, shape):
+    rng = np.random.default_rng(3)
+    x = rng.random((shape[0], 2))
+    y = rng.random((shape[1], 2))
+    row_ind, col_ind = multiscale_assignment(x, y, metric=metric, max_clusters=8, n_threads=2)
+    n = min(shape)
+    assert len(row_ind) == n
+    assert len(set(row_ind.tolist())) == n
+    assert len(set(col_ind.tolist())) == n
+    cost, expected = optimal_cost(x, y, metric)
+    assert np.isclose(cost[row_ind, col_ind].sum(), expected)
+
+
+@pytest.mark.parametrize("n_threads", [1, 3])
+def test_few_candidates(n_threads):
+    # a single candidate per row is far from the optimum, the pairs of
+    # negative reduced cost are added until there are none
+    rng = np.random.default_rng(4)
+    x = rng.random((500, 2))
+    y = rng.random((500, 2))
+    row_ind, col_ind = multiscale_assignment(x, y, n_candidates=1, max_clusters=4,
+                                             n_threads=n_threads)
+    cost, expected = optimal_cost(x, y, "euclidean")
+    assert np.isclose(cost[row_ind, col_ind].sum(), expected)
+
+
+def test_ties():
+    # grid points with repeats, every level has many equal costs
+    rng = np.random.default_rng(5)
+    x = rng.integers(0, 6, (300, 2)).astype(float)
+    y = rng.integers(0, 6, (300, 2)).astype(float)
+    for metric in ["euclidean", "sqeuclidean"]:
+        row_ind, col_ind = multiscale_assignment(x, y, metric=metric, max_clusters=2)
+        cost, expected = optimal_cost(x, y, metric)
+        assert np.isclose(cost[row_ind, col_ind].sum(), expected)
+
+
+def test_empty():
+    row_ind, col_ind = multiscale_assignment(np.zeros((0, 2)), np.zeros((3, 2)))
+    assert len(row_ind) == 0
+
+
+def test_invalid():
+    with pytest.raises(ValueError, match="metric must be"):
+        multiscale_assignment(np.zeros((2, 2)), np.zeros((2, 2)), metric="cosine")
+    with pytest.raises(ValueError, match="same number of coordinates"):
+        multiscale_assignment(np.zeros((2, 2)), np.zeros((2, 3)))
+    with pytest.raises(ValueError, match="invalid numeric entries"):
+        multiscale_assignment(np.array([[0.0, np.nan]]), np.zeros((2, 2)))
+    with pytest.raises(ValueError, match="n_candidates must be positive"):
+        multiscale_assignment(np.zeros((2, 2)), np.zeros((2, 2)), n_candidates=0)
+    with pytest.raises(ValueError, match="matrix of points"):
+        multiscale_assignment(np.zeros(2), np.zeros((2, 2)))
@@ -0,0 +1,90 @@
+import numpy as np
+import pytest
+from nanolsap import _lsap, linear_sum_assignment as solve
+
+numba = pytest.importorskip("numba")
+numba_support = pytest.importorskip("nanolsap.numba_support")
+
+
+def test_capi_table():
+    capi = _lsap.__pyx_capi__
+    for name in ["lsap_solve_dtype", "solve_rectangular_linear_sum_assignment_dtype",
+                 "lsap_solver_create",
+                 "lsap_solver_solve", "lsap_solver_duals", "lsap_solver_destroy"]:
+        assert type(capi[name]).__name__ == "PyCapsule"
+
+
+@pytest.mark.parametrize("shape", [(20, 20), (15, 30), (30, 15), (0, 5)])
+@pytest.mark.parametrize("dtype", [np.float64, np.float32, np.int32, np.uint8])
+@pytest.mark.parametrize("maximize", [False, True])
+def test_linear_sum_assignment(shape, dtype, maximize):
+    cost = (np.random.default_rng(0).random(shape) * 100).astype(dtype)
+    r, c = numba_support.linear_sum_assignment(cost, maximize)
+    r0, c0 = solve(cost, maximize=maximize)
+    np.testing.assert_array_equal(r, r0)
+    assert cost[r, c].sum() == cost[r0, c0].sum()
+
+
+def test_from_jitted_code():
+    @numba.njit
+    def total_cost(costs):
+        total = 0.0
+        for cost in costs:
+            row_ind, col_ind = numba_support.linear_sum_assignment(cost)
+            for t in range(len(row_ind)):
+                total += cost[row_ind[t], col_ind[t]]
+        return total
+
+    costs = np.random.default_rng(1).random((5, 10, 12))
+    expected = sum(cost[solve(cost)].sum() for cost in costs)
+    assert np.isclose(total_cost(costs), expected)
+
+
+def test_errors():
+    cost = np.ones((3, 3))
+    cost[1, 1] = np.nan
+    with pytest.raises(ValueError, match="invalid numeric entries"):
+        numba_support.linear_sum_assignment(cost)
+    with pytest.raises(ValueError, match="infeasible"):
+        numba_support.linear_sum_assignment(np.full((2, 2), np.inf))
+
+
+@pytest.mark.parametrize("layout", ["C", "F", "sliced", "broadcast_rows", "broadcast_cols"])
+def test_solver_reuse(layout):
+    @numba.njit
+    def solve_all(costs, maximize):
+        solver = numba_support.create_solver()
+        n = min(costs.shape[1], costs.shape[2])
+        row_ind = np.empty((len(costs), n), np.int64)
+        col_ind = np.empty((len(costs), n), np.int64)
+        u = np.empty(costs.shape[1])
+        v = np.empty(costs.shape[2])
+        for t in range(len(costs)):
+            numba_support.solve_into(solver, costs[t], row_ind[t], col_ind[t], maximize)
+        numba_support.solver_duals(solver, u, v)
+        numba_support.destroy_solver(solver)
+        return row_ind, col_ind, u, v
+
+    base = np.random.default_rng(2).random((4, 12, 30))
+    if layout == "C":
+        costs = base
+    elif layout == "F":
+        costs = np.asfortranarray(base.transpose(0, 2, 1)).transpose(0, 2, 1)
+    elif layout == "sliced":
+        costs = base[:, :, ::2]
+    elif layout == "broadcast_rows":
+        # zero strides, read from the handle's copy and not past the buffer
+        costs = np.broadcast_to(base[:, :1, :], base.shape)
+    else:
+        costs = np.broadcast_to(base[:, :, :1], base.shape)
+    for maximize in [False, True]:
+        r, c, u, v = solve_all(costs, maximize)
+        for t in range(len(costs)):
+            r0, c0 = solve(costs[t], maximize=maximize)
+            np.testing.assert_array_equal(r[t], r0)
+            assert np.isclose(costs[t][r[t], c[t]].sum(), costs[t][r0, c0].sum())
+        # the duals of the last solve
+        last = costs[-1]
+        reduced = last - u[:, None] - v[None, :]
+        assert (reduced <= 1e-9).all() if maximize else (reduced >= -1e-9).all()
+        assert np.allclose(reduced[r[-1], c[-1]], 0)
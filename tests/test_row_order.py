@@ -0,0 +1,45 @@
+import numpy as np
+import pytest
+from scipy.optimize import linear_sum_assignment as scipy_solve
+from nanolsap import linear_sum_assignment as solve
+
+ORDERS = ["index", "random", "regret", "min_cost"]
+
+
+@pytest.mark.parametrize("row_order", ORDERS)
+@pytest.mark.parametrize("shape", [(1, 1), (6, 6), (40, 40), (20, 35), (35, 20)])
+@pytest.mark.parametrize("seed", range(3))
+def test_same_cost(row_order, shape, seed):
+    rng = np.random.default_rng(seed)
+    cost = rng.integers(0, 10, shape).astype(np.float64)
+    row_ind, col_ind = solve(cost, row_order=row_order)
+    assert len(set(col_ind.tolist())) == len(col_ind) == min(shape)
+    assert (np.diff(row_ind) > 0).all()
+    r, c = scipy_solve(cost)
+    assert cost[row_ind, col_ind].sum() == cost[r, c].sum()
+
+
+@pytest.mark.parametrize("row_order", ORDERS)
+def test_clustered(row_order):
+    rng = np.random.default_rng(7)
+    x = np.sort(rng.random(60))
+    y = np.sort(rng.random(60)) + 0.01
+    cost = np.abs(x[:, None] - y[None, :])
+    r, c = scipy_solve(cost)
+    row_ind, col_ind = solve(cost, row_order=row_order)
+    assert np.isclose(cost[row_ind, col_ind].sum(), cost[r, c].sum())
+    row_ind, col_ind = solve(cost, maximize=True, row_order=row_order)
+    r, c = scipy_solve(cost, maximize=True)
+    assert np.isclose(cost[row_ind, col_ind].sum(), cost[r, c].sum())
+
+
+def test_forbidden():
+    cost = np.array([[np.inf, 1, np.inf], [2, 3, np.inf], [np.inf, 5, 4]])
+    for row_order in ORDERS:
+        row_ind, col_ind = solve(cost, row_order=row_order)
+        assert col_ind.tolist() == [1, 0, 2]
+
+
+def test_invalid_arguments():
+    with pytest.raises(ValueError, match="row_order must be"):
+        solve(np.ones((3, 3)), row_order="reverse")
@@ -0,0 +1,136 @@
+import numpy as np
+import pytest
+from scipy.optimize import linear_sum_assignment as scipy_solve
+from nanolsap import linear_sum_assignment as solve
+
+
+def check_assignment(cost, row_ind, col_ind):
+    assert len(row_ind) == min(cost.shape)
+    assert len(set(row_ind.tolist())) == len(row_ind)
+    assert len(set(col_ind.tolist())) == len(col_ind)
+
+
+@pytest.mark.parametrize("shape", [(1, 1), (5, 5), (30, 30), (20, 35), (35, 20)])
+@pytest.mark.parametrize("seed", range(3))
+def test_approximate(shape, seed):
+    rng = np.random.default_rng(seed)
+    cost = rng.random(shape)
+    row_ind, col_ind = solve(cost, method="sinkhorn")
+    check_assignment(cost, row_ind, col_ind)
+    r, c = scipy_solve(cost)
+    # the rounded plan is close to optimal for a small epsilon
+    assert cost[row_ind, col_ind].sum() <= cost[r, c].sum() + 0.1 * min(shape) + 1e-9
+
+
+@pytest.mark.parametrize("shape", [(1, 1), (5, 5), (30, 30), (20, 35), (35, 20)])
+@pytest.mark.parametrize("seed", range(3))
+def test_repair(shape, seed):
+    rng = np.random.default_rng(seed)
+    cost = rng.integers(0, 20, shape).astype(np.float64)
+    row_ind, col_ind = solve(cost, method="sinkhorn", repair=True, epsilon=0.1)
+    check_assignment(cost, row_ind, col_ind)
+    r, c = scipy_solve(cost)
+    assert cost[row_ind, col_ind].sum() == cost[r, c].sum()
+
+
+def test_repair_maximize():
+    rng = np.random.default_rng(4)
+    cost = rng.random((25, 40)).astype(np.float32)
+    row_ind, col_ind = solve(cost, maximize=True, method="sinkhorn", repair=True)
+    r, c = scipy_solve(cost, maximize=True)
+    assert np.isclose(cost[row_ind, col_ind].sum(), cost[r, c].sum())
+
+
+def test_threads():
+    rng = np.random.default_rng(5)
+    cost = rng.random((300, 700))
+    single = solve(cost, method="sinkhorn", n_threads=1)
+    multi = solve(cost, method="sinkhorn", n_threads=4)
+    check_assignment(cost, *multi)
+    assert np.isclose(cost[single].sum(), cost[multi].sum())
+
+
+def test_subscript():
+    rng = np.random.default_rng(6)
+    cost = rng.random((15, 12))
+    subrows = np.array([3, 5, 7, 9, 11, 13])
+    subcols = np.array([0, 2, 4, 6, 8, 10, 1])
+    row_ind, col_ind = solve(cost, subrows=subrows, subcols=subcols,
+                             method="sinkhorn", repair=True)
+    r, c = scipy_solve(cost[np.ix_(subrows, subcols)])
+    assert np.isclose(cost[row_ind, col_ind].sum(),
+                      cost[np.ix_(subrows, subcols)][r, c].sum())
+
+
+def test_forbidden():
+    cost = np.array([[np.inf, 1, 2], [1, np.inf, 3], [2, 2, np.inf]])
+    row_ind, col_ind = solve(cost, method="sinkhorn", repair=True)
+    assert np.isfinite(cost[row_ind, col_ind]).all()
+    r, c = scipy_solve(cost)
+    assert cost[row_ind, col_ind].sum() == cost[r, c].sum()
+
+
+def test_infeasible():
+    cost = np.array([[np.inf, np.inf], [1, 2]])
+    with pytest.raises(ValueError, match="cost matrix is infeasible"):
+        solve(cost, method="sinkhorn")
+
+
+def test_invalid_arguments():
+    cost = np.ones((3, 3))
+    with pytest.raises(ValueError, match="method must be"):
+        solve(cost, method="simplex")
+    with pytest.raises(ValueError, match="method does not support"):
+        solve(cost, method="sinkhorn", k=2)
+    with pytest.raises(ValueError, match="method does not support"):
+        solve(cost, method="sinkhorn", objective="bottleneck")
+    with pytest.raises(ValueError, match="epsilon must be positive"):
+        solve(cost, method="sinkhorn", epsilon=0)
+
+
+@pytest.mark.parametrize("max_iter", [1, 5, None])
+@pytest.mark.parametrize("seed", range(4))
+def test_forbidden_conflicts(max_iter, seed):
+    # few iterations leave conflicts whose free columns are all forbidden
+    rng = np.random.default_rng(seed)
+    cost = rng.random((40, 40))
+    cost[rng.random((40, 40)) < 0.8] = np.inf
+    cost[np.arange(40), rng.permutation(40)] = rng.random(40)
+    r, c = scipy_solve(cost)
+    for repair in (False, True):
+        row_ind, col_ind = solve(cost, method="sinkhorn", repair=repair, max_iter=max_iter)
+        check_assignment(cost, row_ind, col_ind)
+        assert np.isfinite(cost[row_ind, col_ind]).all()
+        if repair:
+            assert np.isclose(cost[row_ind, col_ind].sum(), cost[r, c].sum())
+
+
+def test_infeasible_repair():
+    cost = np.array([[1, np.inf, np.inf], [2, np.inf, np.inf], [1, 2, 3]])
+    with pytest.raises(ValueError, match="cost matrix is infeasible"):
+        solve(cost, method="sinkhorn", repair=True)
+    with pytest.raises(ValueError, match="cost matrix is infeasible"):
+        solve(cost, method="sinkhorn")
+
+
+@pytest.mark.parametrize("epsilon", [1e-6, 1e-9])
+def test_small_epsilon(epsilon):
+    # the scalings overflow and rows of the kernel underflow
+    rng = np.random.default_rng(7)
+    cost = rng.random((30, 40)) * 1e3
+    row_ind, col_ind = solve(cost, method="sinkhorn", epsilon=epsilon, max_iter=200)
+    check_assignment(cost, row_ind, col_ind)
+    row_ind, col_ind = solve(cost, method="sinkhorn", epsilon=epsilon, repair=True)
+    r, c = scipy_solve(cost)
+    assert np.isclose(cost[row_ind, col_ind].sum(), cost[r, c].sum())
+
+
+def test_forbidden_columns():
+    # columns without a finite entry take no mass
+    rng = np.random.default_rng(8)
+    cost = rng.random((20, 30))
+    cost[:, ::3] = np.inf
+    row_ind, col_ind = solve(cost, method="sinkhorn")
+    check_assignment(cost, row_ind, col_ind)
+    r, c = scipy_solve(cost)
+    assert cost[row_ind, col_ind].sum() <= cost[r, c].sum() + 0.1 * 20
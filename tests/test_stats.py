@@ -0,0 +1,105 @@
+import json
+
+import numpy as np
+import pytest
+from nanolsap import linear_sum_assignment as solve, trace_to_chrome
+
+COUNTERS = ["augmentations", "columns_scanned", "path_length_max",
+            "dual_updates", "tie_breaks", "workspace_bytes"]
+
+
+@pytest.mark.parametrize("shape", [(1, 1), (40, 40), (25, 60), (60, 25)])
+@pytest.mark.parametrize("row_order", ["index", "regret"])
+def test_exact_counters(shape, row_order):
+    rng = np.random.default_rng(0)
+    cost = rng.random(shape)
+    r0, c0 = solve(cost, row_order=row_order)
+    r1, c1, stats = solve(cost, row_order=row_order, return_stats=True)
+    assert np.array_equal(r0, r1) and np.array_equal(c0, c1)
+    n, m = min(shape), max(shape)
+    assert stats["augmentations"] == n
+    # every step of a search scans the columns it has not reached yet
+    assert n <= stats["columns_scanned"] <= n * m * (m + 1) // 2
+    assert 1 <= stats["path_length_mean"] <= stats["path_length_max"] <= n
+    assert stats["dual_updates"] >= n
+    assert stats["workspace_bytes"] >= 8 * (n + m)
+    for key in ["validation_seconds", "setup_seconds", "augment_seconds"]:
+        assert stats[key] >= 0
+
+
+@pytest.mark.parametrize("shape", [(20, 20), (15, 30), (30, 15)])
+def test_k_all_pairs(shape):
+    # k = min(nr, nc) is a full assignment, run by the full engine
+    cost = np.random.default_rng(4).random(shape)
+    stats = solve(cost, method="exact", k=min(shape), return_stats=True)[2]
+    assert (stats["engine"], stats["reason"]) == ("exact", "requested")
+    assert stats["augmentations"] == min(shape)
+
+
+def test_ties():
+    cost = np.zeros((30, 30))
+    stats = solve(cost, return_stats=True)[2]
+    assert stats["path_length_max"] == 1
+    assert stats["tie_breaks"] > 0
+
+
+@pytest.mark.parametrize("kwargs", [{"k": 3}, {"method": "sinkhorn"},
+                                    {"method": "greedy"},
+                                    {"objective": "bottleneck"}])
+def test_other_engines(kwargs):
+    cost = np.random.default_rng(1).random((20, 20))
+    stats = solve(cost, return_stats=True, **kwargs)[-1]
+    for key in COUNTERS[:-1]:
+        assert stats[key] == 0
+    # the exact engines size their workspace for memory_limit
+    assert (stats["workspace_bytes"] > 0) == (stats["engine"] == "exact_k")
+
+
+@pytest.mark.parametrize("shape", [(30, 30), (20, 45), (45, 20)])
+def test_trace(shape):
+    cost = np.random.default_rng(2).random(shape)
+    n = min(shape)
+    r0, c0, stats = solve(cost, return_stats=True, trace=100)
+    trace = stats["trace"]
+    assert len(trace) == n
+    assert sorted(trace["row"].tolist()) == sorted((r0 if shape[0] <= shape[1] else c0).tolist())
+    assert np.isclose(trace["path_length"].sum(), stats["path_length_mean"] * n)
+    assert trace["columns_scanned"].sum() == stats["columns_scanned"]
+    assert np.all(np.diff(trace["start"]) >= 0)
+    assert np.all(trace["duration"] >= 0)
+
+
+def test_trace_ring():
+    cost = np.random.default_rng(3).random((40, 40))
+    full = solve(cost, return_stats=True, trace=40)[2]["trace"]
+    last = solve(cost, return_stats=True, trace=7)[2]["trace"]
+    assert len(last) == 7
+    assert np.array_equal(last["row"], full["row"][-7:])
+    assert np.array_equal(last["columns_scanned"], full["columns_scanned"][-7:])
+
+
+def test_trace_subrows():
+    cost = np.random.default_rng(4).random((30, 30))
+    subrows = np.arange(1, 30, 3)
+    trace = solve(cost, subrows=subrows, return_stats=True, trace=50)[2]["trace"]
+    assert sorted(trace["row"].tolist()) == subrows.tolist()
+
+
+def test_trace_chrome(tmp_path):
+    cost = np.random.default_rng(5).random((10, 12))
+    trace = solve(cost, return_stats=True, trace=10)[2]["trace"]
+    path = tmp_path / "trace.json"
+    result = trace_to_chrome(trace, path)
+    assert json.loads(path.read_text()) == result
+    spans = [e for e in result["traceEvents"] if e["ph"] == "X"]
+    assert len(spans) == 10
+    assert spans[0]["args"]["row"] == trace["row"][0]
+
+
+def test_trace_errors():
+    cost = np.zeros((3, 3))
+    with pytest.raises(ValueError):
+        solve(cost, trace=5)
+    with pytest.raises(ValueError):
+        solve(cost, return_stats=True, trace=-1)
+    assert len(solve(cost, k=2, return_stats=True, trace=5)[2]["trace"]) == 0
@@ -40,3 +40,17 @@ def test_subrow_subcol_random():
             assert lsa_cost == scipy_cost
         else:
             assert False
+
+
+def test_one_subscript():
+    # a missing subscript keeps every row or column, not none of them
+    rng = np.random.default_rng(0)
+    dense = rng.random((20, 30))
+    subrows = np.arange(0, 20, 3)
+    subcols = np.arange(1, 30, 2)
+    for rows, cols in [(subrows, None), (None, subcols)]:
+        sub = dense[np.ix_(np.arange(20) if rows is None else rows,
+                           np.arange(30) if cols is None else cols)]
+        row_ind, col_ind = solve(dense, subrows=rows, subcols=cols)
+        r, c = scipy_linear_sum_assignment(sub)
+        assert np.isclose(dense[row_ind, col_ind].sum(), sub[r, c].sum())
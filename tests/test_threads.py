@@ -0,0 +1,95 @@
+import importlib
+import sys
+import sysconfig
+import threading
+from concurrent.futures import ThreadPoolExecutor
+
+import numpy as np
+import pytest
+from nanolsap import _lsap, estimate_memory, linear_sum_assignment as solve, verify_assignment
+from nanolsap import get_tuning, set_tuning
+from scipy.optimize import linear_sum_assignment as scipy_solve
+
+
+def test_multi_phase_init():
+    # a multi-phase module is created from its spec and can be reloaded
+    assert _lsap.__spec__ is not None
+    importlib.reload(_lsap)
+    assert "solve_rectangular_linear_sum_assignment_dtype" in _lsap.__pyx_capi__
+    cost = np.eye(3, dtype=np.float32)
+    r, c = _lsap.linear_sum_assignment(memoryview(cost))
+    assert cost[r, c].sum() == 0
+
+
+@pytest.mark.skipif(not sysconfig.get_config_var("Py_GIL_DISABLED"),
+                    reason="not a free-threaded build")
+def test_gil_not_enabled():
+    # importing an extension without Py_mod_gil would turn the GIL back on
+    assert not sys._is_gil_enabled()
+
+
+@pytest.mark.parametrize("dtype", [np.float64, np.float32, np.int32])
+def test_concurrent_solves(dtype):
+    rng = np.random.default_rng(0)
+    costs = [(rng.random((60, 80)) * 1000).astype(dtype) for _ in range(32)]
+    expected = [scipy_solve(cost) for cost in costs]
+
+    def run(i):
+        cost = costs[i]
+        # the argument parsing and the conversions run concurrently too
+        assert estimate_memory(memoryview(cost))["copy_bytes"] == 0
+        r, c = solve(cost.tolist() if i % 4 == 0 else memoryview(cost))
+        assert verify_assignment(cost, r, c)["valid"]
+        return r, c
+
+    with ThreadPoolExecutor(8) as pool:
+        results = list(pool.map(run, range(len(costs))))
+    for (r, c), (er, ec) in zip(results, expected):
+        np.testing.assert_array_equal(r, er)
+        np.testing.assert_array_equal(c, ec)
+
+
+def test_stress_with_tuning():
+    # solves and verifications race with set_tuning, which switches auto
+    # between the dense and the sparse engine and the threads of verify
+    rng = np.random.default_rng(1)
+    costs = []
+    for _ in range(16):
+        cost = rng.random((50, 70))
+        cost[rng.random(cost.shape) < 0.7] = np.inf
+        cost[np.arange(50), rng.permutation(70)[:50]] = rng.random(50)
+        costs.append(cost)
+    optimum = [cost[scipy_solve(cost)].sum() for cost in costs]
+    previous = get_tuning()
+    start = threading.Barrier(8)
+    stop = threading.Event()
+
+    def tune():
+        start.wait()
+        t = 0
+        while not stop.is_set():
+            set_tuning(sparse_density=t % 2, entries_per_thread=1 + t % 3 * 1000)
+            get_tuning()
+            t += 1
+
+    def run(seed):
+        start.wait()
+        for t in range(40):
+            i = (seed + t) % len(costs)
+            r, c = solve(costs[i], method="auto")
+            assert np.isclose(costs[i][r, c].sum(), optimum[i])
+            cert = verify_assignment(costs[i], r, c, n_threads=2)
+            assert cert["valid"]
+            assert np.isclose(cert["cost"], optimum[i])
+
+    with ThreadPoolExecutor(8) as pool:
+        tuners = [pool.submit(tune) for _ in range(2)]
+        workers = [pool.submit(run, seed) for seed in range(6)]
+        try:
+            for f in workers:
+                f.result()
+        finally:
+            stop.set()
+            set_tuning(**previous)
+        for f in tuners:
+            f.result()
@@ -0,0 +1,181 @@
+import numpy as np
+import pytest
+from scipy.optimize import linprog
+from nanolsap import linear_sum_assignment, transport
+
+
+def reference(cost, supply, demand):
+    # transport the smaller total mass with a dense LP
+    cost = np.asarray(cost, dtype=np.float64)
+    nr, nc = cost.shape
+    a_rows = np.zeros((nr, nr * nc))
+    a_cols = np.zeros((nc, nr * nc))
+    for i in range(nr):
+        a_rows[i, i * nc:(i + 1) * nc] = 1
+    for j in range(nc):
+        a_cols[j, j::nc] = 1
+    total = min(np.sum(supply), np.sum(demand))
+    bounds = [(0, 0 if np.isinf(c) else None) for c in cost.ravel()]
+    res = linprog(np.where(np.isinf(cost), 0, cost).ravel(),
+                  A_ub=np.vstack([a_rows, a_cols]),
+                  b_ub=np.concatenate([supply, demand]),
+                  A_eq=np.ones((1, nr * nc)), b_eq=[total],
+                  bounds=bounds, method="highs")
+    assert res.status == 0
+    return res.fun
+
+
+def check_flow(cost, supply, demand, row_ind, col_ind, flow, total):
+    cost = np.asarray(cost, dtype=np.float64)
+    assert np.all(flow > 0)
+    assert len(flow) <= cost.shape[0] + cost.shape[1] - 1
+    order = np.lexsort((col_ind, row_ind))
+    assert np.array_equal(order, np.arange(len(order)))
+    moved = min(np.sum(supply), np.sum(demand))
+    assert np.isclose(flow.sum(), moved)
+    assert np.all(np.bincount(row_ind, flow, cost.shape[0]) <= supply + 1e-9)
+    assert np.all(np.bincount(col_ind, flow, cost.shape[1]) <= demand + 1e-9)
+    assert np.isclose((cost[row_ind, col_ind] * flow).sum(), total)
+
+
+def test_simple():
+    cost = [[0, 2], [2, 0]]
+    row_ind, col_ind, flow, total = transport(cost, [1, 1], [1, 1])
+    assert row_ind.tolist() == [0, 1]
+    assert col_ind.tolist() == [0, 1]
+    assert flow.tolist() == [1, 1]
+    assert total == 0
+
+
+@pytest.mark.parametrize("shape", [(1, 1), (1, 5), (5, 1), (4, 4), (6, 9), (9, 6), (20, 30)])
+@pytest.mark.parametrize("seed", range(5))
+def test_random(shape, seed):
+    rng = np.random.default_rng(seed)
+    cost = rng.random(shape)
+    supply = rng.random(shape[0])
+    demand = rng.random(shape[1])
+    demand *= supply.sum() / demand.sum()
+    row_ind, col_ind, flow, total = transport(cost, supply, demand)
+    check_flow(cost, supply, demand, row_ind, col_ind, flow, total)
+    assert np.isclose(total, reference(cost, supply, demand))
+
+
+@pytest.mark.parametrize("seed", range(5))
+def test_unbalanced(seed):
+    rng = np.random.default_rng(seed)
+    cost = rng.random((7, 5))
+    supply = rng.random(7)
+    demand = rng.random(5) * (1 + seed)
+    row_ind, col_ind, flow, total = transport(cost, supply, demand)
+    check_flow(cost, supply, demand, row_ind, col_ind, flow, total)
+    assert np.isclose(total, reference(cost, supply, demand))
+
+
+@pytest.mark.parametrize("seed", range(5))
+def test_unit_masses(seed):
+    rng = np.random.default_rng(seed)
+    cost = rng.integers(0, 5, (12, 12))
+    row_ind, col_ind, flow, total = transport(cost, np.ones(12), np.ones(12))
+    r, c = linear_sum_assignment(cost)
+    assert total == cost[r, c].sum()
+
+
+def test_integer_degenerate():
+    # many ties and integral masses produce degenerate pivots
+    cost = np.ones((30, 30), dtype=np.int32)
+    cost[::2, ::3] = 0
+    supply = np.full(30, 2.0)
+    demand = np.full(30, 2.0)
+    row_ind, col_ind, flow, total = transport(cost, supply, demand)
+    check_flow(cost, supply, demand, row_ind, col_ind, flow, total)
+    assert np.isclose(total, reference(cost, supply, demand))
+
+
+@pytest.mark.parametrize("seed", range(5))
+def test_degenerate_zero_masses(seed):
+    # rows and columns without mass, and masses that exhaust together
+    rng = np.random.default_rng(seed)
+    cost = rng.integers(0, 3, (25, 20))
+    supply = rng.integers(0, 3, 25).astype(float)
+    demand = rng.integers(0, 3, 20).astype(float)
+    diff = supply.sum() - demand.sum()
+    if diff > 0:
+        demand[0] += diff
+    else:
+        supply[0] -= diff
+    row_ind, col_ind, flow, total = transport(cost, supply, demand)
+    check_flow(cost, supply, demand, row_ind, col_ind, flow, total)
+    assert np.isclose(total, reference(cost, supply, demand))
+
+
+def test_maximize():
+    rng = np.random.default_rng(0)
+    cost = rng.random((5, 6))
+    supply = rng.random(5)
+    demand = rng.random(6)
+    row_ind, col_ind, flow, total = transport(cost, supply, demand, maximize=True)
+    check_flow(cost, supply, demand, row_ind, col_ind, flow, total)
+    assert np.isclose(total, -reference(-cost, supply, demand))
+
+
+@pytest.mark.parametrize("dtype", [np.float32, np.int16, np.uint8, np.int64])
+def test_dtype(dtype):
+    rng = np.random.default_rng(1)
+    cost = rng.integers(0, 100, (8, 10))
+    supply = rng.random(8)
+    demand = rng.random(10)
+    expected = transport(cost.astype(np.float64), supply, demand)
+    result = transport(cost.astype(dtype), supply, demand)
+    assert np.isclose(result[3], expected[3])
+
+
+def test_subscript():
+    rng = np.random.default_rng(2)
+    cost = rng.random((10, 12))
+    subrows = np.array([7, 1, 3, 4])
+    subcols = np.array([11, 2, 0, 5, 6])
+    supply = rng.random(4)
+    demand = rng.random(5)
+    row_ind, col_ind, flow, total = transport(cost, supply, demand,
+                                              subrows=subrows, subcols=subcols)
+    sub = cost[np.ix_(subrows, subcols)]
+    assert set(row_ind.tolist()) <= set(subrows.tolist())
+    assert set(col_ind.tolist()) <= set(subcols.tolist())
+    assert np.isclose((cost[row_ind, col_ind] * flow).sum(), total)
+    assert np.isclose(total, reference(sub, supply, demand))
+
+
+def test_forbidden():
+    cost = np.array([[np.inf, 1.0], [1.0, 5.0]])
+    row_ind, col_ind, flow, total = transport(cost, [1, 1], [1, 1])
+    assert total == 2
+    assert row_ind.tolist() == [0, 1]
+    assert col_ind.tolist() == [1, 0]
+
+
+def test_infeasible():
+    cost = np.array([[np.inf, 1.0], [np.inf, 5.0]])
+    with pytest.raises(ValueError):
+        transport(cost, [1, 1], [1, 1])
+
+
+def test_zero_mass():
+    row_ind, col_ind, flow, total = transport([[1, 2]], [0], [1, 1])
+    assert len(flow) == 0
+    assert total == 0
+
+
+def test_invalid_mass():
+    with pytest.raises(ValueError):
+        transport([[1, 2]], [-1], [1, 1])
+    with pytest.raises(ValueError):
+        transport([[1, 2]], [np.nan], [1, 1])
+    with pytest.raises(ValueError):
+        transport([[1, 2]], [1, 1], [1, 1])
+
+
+def test_max_iter():
+    rng = np.random.default_rng(3)
+    cost = rng.random((20, 20))
+    with pytest.raises(RuntimeError):
+        transport(cost, np.ones(20), np.ones(20), max_iter=0)
@@ -0,0 +1,87 @@
+import json
+
+import numpy as np
+import pytest
+import nanolsap
+from nanolsap import get_tuning, linear_sum_assignment as solve, set_tuning
+from nanolsap import tuning
+
+
+@pytest.fixture(autouse=True)
+def restore():
+    previous = get_tuning()
+    yield
+    set_tuning(**previous)
+
+
+def mostly_infinite(n=100, seed=0):
+    rng = np.random.default_rng(seed)
+    cost = np.full((n, n), np.inf)
+    cost[np.arange(n), rng.permutation(n)] = rng.random(n)
+    return cost
+
+
+def test_set_and_get():
+    set_tuning(sparse_density=0.5, entries_per_thread=100)
+    assert get_tuning() == {"sparse_density": 0.5, "entries_per_thread": 100}
+    set_tuning(entries_per_thread=7)
+    assert get_tuning()["sparse_density"] == 0.5
+    set_tuning(defaults=True)
+    assert get_tuning() == {"sparse_density": 0.2, "entries_per_thread": 16384}
+
+
+@pytest.mark.parametrize("kwargs", [{"sparse_density": float("nan")},
+                                    {"entries_per_thread": 0}])
+def test_invalid(kwargs):
+    before = get_tuning()
+    with pytest.raises(ValueError):
+        set_tuning(**kwargs)
+    assert get_tuning() == before
+
+
+def test_sparse_density_dispatch():
+    cost = mostly_infinite()
+    expected = cost[solve(cost)].sum()
+    for density, engine in [(-1.0, "exact"), (0.2, "exact_sparse")]:
+        set_tuning(sparse_density=density)
+        r, c, stats = solve(cost, method="auto", return_stats=True)
+        assert stats["engine"] == engine
+        assert cost[r, c].sum() == expected
+
+
+@pytest.mark.parametrize("method", ["greedy", "sinkhorn"])
+def test_threads_same_result(method):
+    cost = np.random.default_rng(1).random((150, 150))
+    set_tuning(entries_per_thread=1)
+    threaded = solve(cost, method=method, n_threads=4)
+    set_tuning(entries_per_thread=10 ** 9)
+    single = solve(cost, method=method, n_threads=4)
+    assert np.array_equal(threaded, single)
+
+
+def test_autotune_cache(tmp_path, monkeypatch):
+    path = str(tmp_path / "sub" / "tuning.json")
+    result = nanolsap.autotune(path=path, size=128, repeat=1)
+    assert set(result) == {"sparse_density", "entries_per_thread"}
+    assert 0 <= result["sparse_density"] <= max(tuning.DENSITIES)
+    assert result["entries_per_thread"] >= 1
+    assert get_tuning() == result
+    with open(path) as f:
+        cache = json.load(f)
+    assert cache[tuning.cpu_model()]["sparse_density"] == result["sparse_density"]
+
+    set_tuning(defaults=True)
+    assert tuning.load(path) == result
+    monkeypatch.setenv("NANOLSAP_TUNING_CACHE", path)
+    set_tuning(defaults=True)
+    assert tuning.load() == result
+
+
+def test_load_missing(tmp_path, monkeypatch):
+    assert tuning.load(str(tmp_path / "none.json")) is None
+    with open(tmp_path / "other.json", "w") as f:
+        json.dump({"some other cpu": {"sparse_density": 0.9, "entries_per_thread": 1}}, f)
+    assert tuning.load(str(tmp_path / "other.json")) is None
+    monkeypatch.setenv("NANOLSAP_TUNING_CACHE", "")
+    assert tuning.cache_path() is None
+    assert tuning.load() is None
@@ -0,0 +1,138 @@
+import math
+
+import numpy as np
+import pytest
+from nanolsap import linear_sum_assignment as solve, verify_assignment as verify
+
+
+def duals(cost):
+    """Optimal duals of a square matrix, from the LP by complementary
+    slackness on the optimal assignment: shortest paths in the residual
+    graph."""
+    n = cost.shape[0]
+    r, c = solve(cost)
+    row4col = np.empty(n, dtype=int)
+    row4col[c] = r
+    # potentials p of the columns: p[j] <= p[j2] + cost[row4col[j2], j] - cost[row4col[j2], j2]
+    p = np.zeros(n)
+    for _ in range(n):
+        reduced = cost[row4col] - cost[row4col, np.arange(n)][:, None]
+        p = np.minimum(p, (p[:, None] + reduced).min(axis=0))
+    v = p
+    u = cost[np.arange(n), c[np.argsort(r)]] - v[c[np.argsort(r)]]
+    return u, v
+
+
+@pytest.mark.parametrize("shape", [(20, 20), (15, 30), (30, 15)])
+@pytest.mark.parametrize("maximize", [False, True])
+def test_optimal_without_duals(shape, maximize):
+    cost = np.random.default_rng(0).random(shape)
+    r, c = solve(cost, maximize=maximize)
+    cert = verify(cost, r, c, maximize=maximize)
+    assert cert["valid"]
+    assert np.isclose(cert["cost"], cost[r, c].sum())
+    assert cert["gap"] >= -1e-12
+    if maximize:
+        assert cert["bound"] >= cert["cost"] - 1e-12
+    else:
+        assert cert["bound"] <= cert["cost"] + 1e-12
+    assert cert["max_violation"] == 0 and cert["max_slack"] == 0
+
+
+@pytest.mark.parametrize("shape", [(6, 9), (9, 6)])
+def test_proven_without_duals(shape):
+    # without duals only the row minima bound a rectangular view, proof
+    # enough when every row of it gets its cheapest column
+    n = min(shape)
+    cost = np.random.default_rng(6).random(shape) + 1
+    view = cost if shape[0] <= shape[1] else cost.T
+    view[np.arange(n), np.arange(n)] = 0
+    r, c = solve(cost)
+    cert = verify(cost, r, c)
+    assert cert["valid"] and cert["proven_optimal"]
+    assert cert["gap"] == 0
+
+    # optimal, but the rows compete for the same cheapest column
+    view[:, 0] = -1
+    r, c = solve(cost)
+    cert = verify(cost, r, c)
+    assert cert["valid"] and not cert["proven_optimal"]
+    assert cert["gap"] > 0
+
+
+@pytest.mark.parametrize("maximize", [False, True])
+def test_certified_with_duals(maximize):
+    cost = np.random.default_rng(1).random((25, 25))
+    sign = -1 if maximize else 1
+    u, v = duals(sign * cost)
+    r, c = solve(cost, maximize=maximize)
+    cert = verify(cost, r, c, u=sign * u, v=sign * v, maximize=maximize, n_threads=3)
+    assert cert["valid"] and cert["proven_optimal"]
+    assert abs(cert["gap"]) < 1e-9
+    assert cert["max_violation"] < 1e-9 and cert["max_slack"] < 1e-9
+
+    # a worse assignment is caught by the same duals
+    c2 = c.copy()
+    c2[[0, 1]] = c2[[1, 0]]
+    cert = verify(cost, r, c2, u=sign * u, v=sign * v, maximize=maximize)
+    assert cert["valid"] and not cert["proven_optimal"]
+    assert cert["gap"] > 0 and cert["max_slack"] > 0
+
+
+def test_approximate_gap():
+    cost = np.random.default_rng(2).random((200, 200))
+    r, c = solve(cost, method="greedy", max_iter=0)
+    cert = verify(cost, r, c, n_threads=2)
+    exact = cost[solve(cost)].sum()
+    assert cert["valid"]
+    assert cert["bound"] <= exact + 1e-9 <= cert["cost"] + 2e-9
+    assert np.isclose(cert["gap"], cert["cost"] - cert["bound"])
+
+
+def test_infeasible_duals_still_bound():
+    cost = np.random.default_rng(3).random((10, 30))
+    r, c = solve(cost)
+    u = np.full(10, 5.0)
+    v = np.full(30, 1.0)
+    cert = verify(cost, r, c, u=u, v=v)
+    assert cert["max_violation"] > 1
+    assert cert["bound"] <= cert["cost"] + 1e-12
+
+
+def test_invalid():
+    cost = np.random.default_rng(4).random((5, 5))
+    r, c = solve(cost)
+    for rr, cc in [(r[:4], c[:4]), (r, np.r_[c[:4], c[0]]), (r, np.r_[c[:4], 5]),
+                   (np.r_[r[:4], -1], c)]:
+        cert = verify(cost, rr, cc)
+        assert not cert["valid"] and not cert["proven_optimal"]
+        assert math.isnan(cert["gap"])
+    cost[r[0], c[0]] = np.inf
+    assert not verify(cost, r, c)["valid"]
+
+
+def test_subscripts_and_dtypes():
+    rng = np.random.default_rng(5)
+    cost = rng.integers(0, 100, (40, 50)).astype(np.int16)
+    subrows = rng.permutation(40)[:20]
+    subcols = np.r_[rng.permutation(50)[:10], rng.permutation(50)[:5]]
+    r, c = solve(cost, subrows=subrows, subcols=subcols)
+    cert = verify(cost, r, c, subrows=subrows, subcols=subcols)
+    assert cert["valid"]
+    assert cert["cost"] == cost[r, c].sum()
+    cert = verify(cost, r, c, subrows=subrows)
+    assert not cert["valid"]
+
+
+def test_errors():
+    cost = np.zeros((3, 3))
+    r = c = np.arange(3)
+    with pytest.raises(ValueError):
+        verify(cost, r, c, u=np.zeros(3))
+    with pytest.raises(ValueError):
+        verify(cost, r, c, u=np.zeros(2), v=np.zeros(3))
+    with pytest.raises(ValueError):
+        verify(cost, r, c[:2])
+    with pytest.raises(ValueError):
+        verify(cost, r, c, tol=-1)
+    assert verify(np.zeros((0, 3)), [], [])["valid"]